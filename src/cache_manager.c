@@ -5,10 +5,34 @@
 #include "cache_manager.h"
 #include "ha_client.h"
 #include "utils/json_helpers.h"
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+static void load_entities(cache_manager_t *manager);
+static void rebuild_search_index(cache_manager_t *manager);
+static const ha_entity_t* put_entity(cache_manager_t *manager, ha_entity_t *entity, time_t now);
+static const ha_entity_t* store_entity(cache_manager_t *manager, ha_entity_t *entity, time_t now);
+static void publish_changes(cache_manager_t *manager);
+static int apply_snapshot(cache_manager_t *manager, sync_snapshot_t *snapshot);
+static void reschedule(cache_manager_t *manager);
+static void record_sync_stats(cache_manager_t *manager, const sync_stats_t *stats);
+static void resolve_write_times(cache_manager_t *manager);
+static ha_entity_t* predict_entity(const ha_entity_t *entity, const char *service,
+                                   const char *params_json);
+static int find_pending(cache_manager_t *manager, const char *entity_id);
+static int add_pending(cache_manager_t *manager, unsigned long call_id,
+                       const ha_entity_t *current, ha_entity_t *predicted);
+static const ha_entity_t** overlay_pending(cache_manager_t *manager, ha_entity_t **entities,
+                                           int count);
+static void show_prediction(cache_manager_t *manager, const ha_entity_t *predicted);
+static void store_entities(cache_manager_t *manager, ha_entity_t **entities, int count, time_t now);
+static void complete_call(cache_manager_t *manager, sync_call_t *call);
+static void refresh_visible(cache_manager_t *manager);
+static unsigned long queue_refresh(cache_manager_t *manager, const char *entity_id);
+static void drop_pending(cache_manager_t *manager, int index);
+
 cache_manager_t* cache_manager_create(database_t *db, ha_client_t *client) {
     if (!db) {
         return NULL;
@@ -31,19 +55,108 @@ cache_manager_t* cache_manager_create(database_t *db, ha_client_t *client) {
         free(last_sync_str);
     }
 
+    manager->schedule.activity = SYNC_ACTIVITY_LIST;
+    manager->schedule.last_attempt = manager->last_sync;
+    reschedule(manager);
+
+    // Load favorites set once; kept in sync by add/remove below
+    int fav_count = 0;
+    char **fav_ids = database_get_favorite_ids(db, &fav_count);
+    if (!str_map_init(&manager->favorites, fav_count)) {
+        fprintf(stderr, "Failed to allocate favorites set\n");
+    }
+    for (int i = 0; i < fav_count; i++) {
+        str_map_put(&manager->favorites, fav_ids[i], 1);
+        free(fav_ids[i]);
+    }
+    free(fav_ids);
+
+    // Every read is served from memory; the database is only read here
+    if (!entity_store_init(&manager->entities)) {
+        fprintf(stderr, "Failed to allocate entity table\n");
+    }
+    entity_store_index_favorites(&manager->entities, &manager->favorites);
+    load_entities(manager);
+
+    // Search works offline from the cached entities
+    manager->search = search_index_create();
+    rebuild_search_index(manager);
+
+    // Writes go through a background thread: a second connection for a
+    // file, the shared connection for an in-memory database
+    manager->writer = db->in_memory ? db_writer_attach(db) : db_writer_start(db->db_path);
+    if (!manager->writer) {
+        fprintf(stderr, "Database writer unavailable, writing synchronously\n");
+    }
+
     return manager;
 }
 
 void cache_manager_destroy(cache_manager_t *manager) {
     if (manager) {
         // Note: We don't own db or ha_client, so don't free them
+        sync_worker_stop(manager->sync);
+        db_writer_stop(manager->writer);
+        entity_store_free(&manager->entities);
+        entity_changes_free(&manager->changes);
+        while (manager->pending_count > 0) {
+            drop_pending(manager, 0);
+        }
+        str_map_free(&manager->favorites);
+        search_index_destroy(manager->search);
         free(manager);
     }
 }
 
+void cache_manager_flush(cache_manager_t *manager) {
+    if (!manager || !manager->writer) {
+        return;
+    }
+
+    db_writer_flush(manager->writer);
+}
+
+void cache_manager_snapshot(cache_manager_t *manager) {
+    if (!manager || !manager->db->in_memory) {
+        return;
+    }
+
+    // Behind every queued write, so the snapshot includes them
+    if (!manager->writer || !db_writer_snapshot(manager->writer)) {
+        database_snapshot(manager->db, 0);
+    }
+}
+
+int cache_manager_subscribe(cache_manager_t *manager, cache_change_fn fn, void *ctx) {
+    if (!manager || !fn || manager->subscriber_count == CACHE_MAX_SUBSCRIBERS) {
+        return 0;
+    }
+
+    manager->subscribers[manager->subscriber_count].fn = fn;
+    manager->subscribers[manager->subscriber_count].ctx = ctx;
+    manager->subscriber_count++;
+    return 1;
+}
+
+void cache_manager_unsubscribe(cache_manager_t *manager, cache_change_fn fn, void *ctx) {
+    if (!manager) {
+        return;
+    }
+
+    for (int i = 0; i < manager->subscriber_count; i++) {
+        if (manager->subscribers[i].fn == fn && manager->subscribers[i].ctx == ctx) {
+            manager->subscriber_count--;
+            memmove(&manager->subscribers[i], &manager->subscribers[i + 1],
+                    (manager->subscriber_count - i) * sizeof(cache_subscriber_t));
+            return;
+        }
+    }
+}
+
 void cache_manager_set_sync_interval(cache_manager_t *manager, int seconds) {
     if (manager && seconds >= 60) {
         manager->sync_interval = seconds;
+        reschedule(manager);
     }
 }
 
@@ -52,113 +165,309 @@ void cache_manager_set_sync_interval(cache_manager_t *manager, int seconds) {
  * ============================================ */
 
 /**
- * Parse entity-area mappings from template API response
- * JSON format: [{"e":"entity_id","a":"area_id"},...]
+ * Helper: Decide the interval until the next background sync.
+ * Offline: exponential backoff from SYNC_OFFLINE_RETRY. Online: by
+ * activity, doubled for each recent sync that changed nothing.
  */
-static void parse_and_update_areas(cache_manager_t *manager, const char *json) {
-    if (!manager || !json || strlen(json) < 2) {
-        return;
+static void reschedule(cache_manager_t *manager) {
+    sync_schedule_t *schedule = &manager->schedule;
+    int interval;
+    const char *reason;
+
+    if (schedule->failures > 0) {
+        int shift = schedule->failures - 1;
+        interval = SYNC_OFFLINE_RETRY << (shift < 10 ? shift : 10);
+        reason = "offline";
+    } else {
+        switch (schedule->activity) {
+            case SYNC_ACTIVITY_DETAIL:
+                interval = SYNC_DETAIL_INTERVAL;
+                reason = "detail";
+                break;
+            case SYNC_ACTIVITY_LIST:
+                interval = SYNC_LIST_INTERVAL;
+                reason = "list";
+                break;
+            case SYNC_ACTIVITY_IDLE:
+            default:
+                interval = manager->sync_interval;
+                reason = "idle";
+                break;
+        }
+
+        // What is on screen refreshes on its own; the rest can wait
+        if (schedule->activity != SYNC_ACTIVITY_IDLE && manager->sync &&
+            manager->visible_count > 0) {
+            interval = manager->sync_interval;
+            reason = "background";
+        }
+
+        int quiet = schedule->quiet_syncs;
+        interval <<= (quiet < SYNC_QUIET_BACKOFF ? quiet : SYNC_QUIET_BACKOFF);
     }
 
-    int updated = 0;
-    const char *ptr = json;
+    if (interval > SYNC_MAX_INTERVAL) {
+        interval = SYNC_MAX_INTERVAL;
+    }
 
-    // Simple JSON array parser for [{"e":"...","a":"..."},...]
-    while ((ptr = strstr(ptr, "\"e\":\"")) != NULL) {
-        ptr += 5; // Skip "e":"
+    if (interval != schedule->interval || reason != schedule->reason) {
+        printf("Sync schedule: every %d s (%s, %d unchanged, %d failed)\n",
+               interval, reason, schedule->quiet_syncs, schedule->failures);
+    }
 
-        // Extract entity_id
-        char entity_id[128] = {0};
-        int i = 0;
-        while (*ptr && *ptr != '"' && i < 127) {
-            entity_id[i++] = *ptr++;
-        }
-        if (*ptr != '"') continue;
-        ptr++; // Skip closing quote
-
-        // Find area_id
-        const char *area_ptr = strstr(ptr, "\"a\":\"");
-        if (!area_ptr || area_ptr > ptr + 20) continue;
-        area_ptr += 5; // Skip "a":"
-
-        char area_id[64] = {0};
-        i = 0;
-        while (*area_ptr && *area_ptr != '"' && i < 63) {
-            area_id[i++] = *area_ptr++;
-        }
+    schedule->interval = interval;
+    schedule->reason = reason;
+    schedule->next_sync = schedule->last_attempt + interval;
+}
 
-        if (strlen(entity_id) > 0 && strlen(area_id) > 0) {
-            database_update_entity_area(manager->db, entity_id, area_id);
-            updated++;
-        }
+/**
+ * Helper: Feed a sync result back into the schedule
+ */
+static void record_sync_result(cache_manager_t *manager, int success, int changed) {
+    sync_schedule_t *schedule = &manager->schedule;
+
+    if (success) {
+        schedule->failures = 0;
+        schedule->quiet_syncs = changed ? 0 : schedule->quiet_syncs + 1;
+    } else {
+        schedule->failures++;
     }
 
-    printf("Updated area assignments for %d entities\n", updated);
+    schedule->last_attempt = time(NULL);
+    schedule->requested_at = 0;
+    reschedule(manager);
 }
 
-int cache_manager_sync(cache_manager_t *manager) {
-    if (!manager || !manager->ha_client) {
-        return -1;
+static double elapsed_ms(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 +
+           (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+/**
+ * Helper: Add a sync's timings to the history and log where the time went
+ */
+static void record_sync_stats(cache_manager_t *manager, const sync_stats_t *stats) {
+    manager->sync_history[manager->sync_history_next] = *stats;
+    manager->sync_history_next = (manager->sync_history_next + 1) % CACHE_SYNC_HISTORY;
+    if (manager->sync_history_count < CACHE_SYNC_HISTORY) {
+        manager->sync_history_count++;
     }
 
-    printf("Syncing with Home Assistant...\n");
+    const ha_timing_t *t = &stats->states;
+    printf("Sync timing: dns %.0f, connect %.0f, tls %.0f, ttfb %.0f, states %.0f, "
+           "parse %.0f, areas %.0f, apply %.0f ms; %lu bytes\n",
+           t->dns_ms, t->connect_ms, t->tls_ms, t->ttfb_ms, t->total_ms, stats->parse_ms,
+           stats->areas.total_ms + stats->area_parse_ms, stats->apply_ms,
+           (unsigned long)stats->bytes);
+}
 
-    // Fetch all states from HA
-    ha_response_t *response = ha_client_get_states(manager->ha_client);
-    if (!response) {
-        fprintf(stderr, "Sync failed: no response from HA\n");
-        manager->online = 0;
+/**
+ * Helper: Fill in write times the database writer has reported since
+ */
+static void resolve_write_times(cache_manager_t *manager) {
+    for (int i = 0; i < manager->sync_history_count; i++) {
+        sync_stats_t *stats = &manager->sync_history[i];
+        if (!stats->write_job) {
+            continue;
+        }
+
+        int known = db_writer_save_time(manager->writer, stats->write_job, &stats->write_ms);
+        if (known != 0) {
+            stats->write_job = 0;   // Reported, or replaced before we asked
+        }
+    }
+}
+
+/**
+ * Helper: Merge a fetched snapshot into the cache and persist it.
+ * Takes ownership of the snapshot.
+ */
+static int apply_snapshot(cache_manager_t *manager, sync_snapshot_t *snapshot) {
+    if (!snapshot) {
         return -1;
     }
 
-    if (!response->success) {
-        fprintf(stderr, "Sync failed: %s (HTTP %d)\n",
-                response->error_message, response->status_code);
-        ha_response_free(response);
+    if (!snapshot->success) {
         manager->online = 0;
+        record_sync_stats(manager, &snapshot->stats);
+        sync_snapshot_free(snapshot);
+        record_sync_result(manager, 0, 0);
         return -1;
     }
 
-    // Parse entities
-    int count = 0;
-    ha_entity_t **entities = parse_entities_array(response->data, &count);
-    ha_response_free(response);
+    struct timespec apply_start;
+    clock_gettime(CLOCK_MONOTONIC, &apply_start);
 
-    if (!entities || count == 0) {
-        fprintf(stderr, "Sync failed: no entities parsed\n");
-        return -1;
+    ha_entity_t **entities = snapshot->entities;
+    int count = snapshot->count;
+    time_t now = snapshot->fetched_at;
+    sync_stats_t stats = snapshot->stats;
+    snapshot->entities = NULL;   // Ownership moves to the save below
+    sync_snapshot_free(snapshot);
+
+    // Update sync metadata
+    manager->last_sync = now;
+    manager->online = 1;
+
+    char timestamp[32];
+    snprintf(timestamp, sizeof(timestamp), "%ld", (long)manager->last_sync);
+
+    // Keep showing predictions the server has not answered yet; the
+    // server's rows are what gets saved
+    const ha_entity_t **shown = overlay_pending(manager, entities, count);
+    if (!shown) {
+        shown = (const ha_entity_t **)entities;
     }
 
-    printf("Parsed %d entities from Home Assistant\n", count);
+    // Readers see the new data immediately; persisting it follows
+    if (!entity_store_replace(&manager->entities, shown, count, &manager->changes)) {
+        fprintf(stderr, "Sync: entity table update incomplete (out of memory)\n");
+    }
+    if (shown != (const ha_entity_t **)entities) {
+        free(shown);
+    }
+    printf("Sync changes: %d added, %d removed, %d updated\n", manager->changes.added,
+           manager->changes.removed, manager->changes.changed);
+    if (manager->changes.layout) {
+        rebuild_search_index(manager);
+    }
+    record_sync_result(manager, 1, manager->changes.count > 0 || manager->changes.layout);
+    stats.changed_count = manager->changes.count;
+    stats.apply_ms = elapsed_ms(&apply_start);
+
+    if (manager->writer) {
+        // One job saves entities, history and retention; its time comes back later
+        stats.write_job = db_writer_save_entities(manager->writer, entities, count, now);
+        db_writer_set_metadata(manager->writer, "last_sync", timestamp);
+        record_sync_stats(manager, &stats);
+        publish_changes(manager);
+        return count;
+    }
 
-    // Save to database
+    struct timespec write_start;
+    clock_gettime(CLOCK_MONOTONIC, &write_start);
     int saved = database_save_entities(manager->db, entities, count);
     printf("Saved %d entities to cache\n", saved);
 
-    // Cleanup entities
+    // Record numeric states and apply history retention
+    database_append_history(manager->db, entities, count, now);
+    database_compact_history(manager->db, now);
     free_entities(entities, count);
 
-    // Fetch and merge area assignments from entity registry
-    printf("Fetching area assignments...\n");
-    ha_response_t *area_response = ha_client_get_entity_registry(manager->ha_client);
-    if (area_response && area_response->success && area_response->data) {
-        parse_and_update_areas(manager, area_response->data);
-    } else {
-        printf("Area fetch skipped (no response or error)\n");
+    database_set_metadata(manager->db, "last_sync", timestamp);
+    stats.write_ms = elapsed_ms(&write_start);
+    record_sync_stats(manager, &stats);
+    publish_changes(manager);
+
+    return saved;
+}
+
+int cache_manager_sync(cache_manager_t *manager) {
+    if (!manager || !manager->ha_client) {
+        return -1;
+    }
+
+    return apply_snapshot(manager, sync_fetch(manager->ha_client));
+}
+
+int cache_manager_start_sync_thread(cache_manager_t *manager, sync_notify_fn notify,
+                                    void *notify_ctx) {
+    if (!manager || !manager->ha_client) {
+        return 0;
     }
-    if (area_response) {
-        ha_response_free(area_response);
+    if (manager->sync) {
+        return 1;
     }
 
-    // Update sync metadata
-    manager->last_sync = time(NULL);
-    manager->online = 1;
+    // The scheduler decides when; the worker only fetches on request
+    manager->sync = sync_worker_start(manager->ha_client, 0, manager->last_sync,
+                                      notify, notify_ctx);
+    reschedule(manager);
+    return manager->sync != NULL;
+}
 
-    char timestamp[32];
-    snprintf(timestamp, sizeof(timestamp), "%ld", (long)manager->last_sync);
-    database_set_metadata(manager->db, "last_sync", timestamp);
+int cache_manager_request_sync(cache_manager_t *manager) {
+    if (!manager || !manager->ha_client) {
+        return -1;
+    }
 
-    return saved;
+    if (!manager->sync) {
+        return cache_manager_sync(manager);
+    }
+
+    manager->schedule.requested_at = time(NULL);
+    sync_worker_request(manager->sync);
+    return 0;
+}
+
+int cache_manager_poll(cache_manager_t *manager) {
+    if (!manager || !manager->sync) {
+        return 0;
+    }
+
+    // One request at a time, unless the last one seems lost
+    time_t requested = manager->schedule.requested_at;
+    if (cache_manager_should_sync(manager) &&
+        (requested == 0 || time(NULL) - requested > SYNC_STALL_TIMEOUT)) {
+        cache_manager_request_sync(manager);
+    }
+
+    // The snapshot may predate finished calls, so it goes first
+    int applied = 0;
+    sync_snapshot_t *snapshot = sync_worker_take(manager->sync);
+    if (snapshot) {
+        apply_snapshot(manager, snapshot);
+        applied = 1;
+    }
+
+    sync_call_t *call = sync_worker_take_results(manager->sync);
+    while (call) {
+        sync_call_t *next = call->next;
+        complete_call(manager, call);
+        call = next;
+    }
+
+    resolve_write_times(manager);
+    refresh_visible(manager);
+    return applied;
+}
+
+int cache_manager_poll_timeout(cache_manager_t *manager) {
+    if (!manager || !manager->sync) {
+        return -1;
+    }
+
+    for (int i = 0; i < manager->sync_history_count; i++) {
+        if (manager->sync_history[i].write_job) {
+            return CACHE_WRITE_POLL_MS;
+        }
+    }
+
+    // Same conditions as cache_manager_poll() and refresh_visible()
+    time_t due = 0;
+    if (manager->ha_client) {
+        due = manager->schedule.next_sync;
+        time_t requested = manager->schedule.requested_at;
+        if (requested != 0 && due <= requested + SYNC_STALL_TIMEOUT) {
+            due = requested + SYNC_STALL_TIMEOUT + 1;
+        }
+    }
+    if (manager->visible_count > 0 && !manager->visible_call &&
+        manager->schedule.activity != SYNC_ACTIVITY_IDLE && manager->schedule.failures == 0 &&
+        (due == 0 || manager->visible_next < due)) {
+        due = manager->visible_next;
+    }
+    if (due == 0) {
+        return -1;
+    }
+
+    time_t now = time(NULL);
+    if (due <= now) {
+        return 0;
+    }
+    return (due - now) > INT_MAX / 1000 ? INT_MAX : (int)(due - now) * 1000;
 }
 
 int cache_manager_should_sync(cache_manager_t *manager) {
@@ -166,8 +475,7 @@ int cache_manager_should_sync(cache_manager_t *manager) {
         return 0;
     }
 
-    time_t now = time(NULL);
-    return (now - manager->last_sync) >= manager->sync_interval;
+    return time(NULL) >= manager->schedule.next_sync;
 }
 
 int cache_manager_sync_if_needed(cache_manager_t *manager) {
@@ -182,60 +490,126 @@ time_t cache_manager_get_last_sync(cache_manager_t *manager) {
     return manager ? manager->last_sync : 0;
 }
 
+void cache_manager_set_activity(cache_manager_t *manager, sync_activity_t activity) {
+    if (!manager || manager->schedule.activity == activity) {
+        return;
+    }
+
+    // Becoming busier ends the quiet backoff so fresh data shows up soon
+    if (activity > manager->schedule.activity) {
+        manager->schedule.quiet_syncs = 0;
+    }
+
+    manager->schedule.activity = activity;
+    reschedule(manager);
+}
+
+void cache_manager_set_visible(cache_manager_t *manager, const char *const *entity_ids,
+                               int count) {
+    if (!manager || (!entity_ids && count > 0)) {
+        return;
+    }
+    if (count > CACHE_MAX_VISIBLE) {
+        count = CACHE_MAX_VISIBLE;
+    }
+
+    // Same rows as last frame: nothing to do
+    int same = (count == manager->visible_count);
+    for (int i = 0; i < count && same; i++) {
+        same = strcmp(manager->visible[i], entity_ids[i]) == 0;
+    }
+    if (same) {
+        return;
+    }
+
+    int was_empty = (manager->visible_count == 0);
+    for (int i = 0; i < count; i++) {
+        strncpy(manager->visible[i], entity_ids[i], sizeof(manager->visible[i]) - 1);
+        manager->visible[i][sizeof(manager->visible[i]) - 1] = '\0';
+    }
+    manager->visible_count = count;
+    manager->visible_next = 0;   // Rows just scrolled in are refreshed now
+
+    if (was_empty != (count == 0)) {
+        reschedule(manager);
+    }
+}
+
+const sync_schedule_t* cache_manager_get_schedule(cache_manager_t *manager) {
+    return manager ? &manager->schedule : NULL;
+}
+
+const sync_stats_t* cache_manager_get_sync_stats(cache_manager_t *manager, int index) {
+    if (!manager || index < 0 || index >= manager->sync_history_count) {
+        return NULL;
+    }
+
+    int slot = (manager->sync_history_next - 1 - index + CACHE_SYNC_HISTORY) % CACHE_SYNC_HISTORY;
+    return &manager->sync_history[slot];
+}
+
 /* ============================================
  * Entity Operations
  * ============================================ */
 
-ha_entity_t** cache_manager_get_entities(cache_manager_t *manager, int *count) {
-    if (!manager || !count) {
-        return NULL;
+unsigned int cache_manager_get_version(cache_manager_t *manager) {
+    return manager ? manager->entities.version + manager->favorites_version : 0;
+}
+
+int cache_manager_select(cache_manager_t *manager, const entity_filter_t *filter,
+                         const ha_entity_t **rows, int max_rows) {
+    if (!manager) {
+        return 0;
     }
 
-    return database_get_all_entities(manager->db, count);
+    return entity_store_select(&manager->entities, filter, rows, max_rows);
+}
+
+int cache_manager_count_entities(cache_manager_t *manager, const entity_filter_t *filter) {
+    return cache_manager_select(manager, filter, NULL, 0);
 }
 
-ha_entity_t** cache_manager_get_entities_by_domain(cache_manager_t *manager,
-                                                    const char *domain,
-                                                    int *count) {
-    if (!manager || !domain || !count) {
+char** cache_manager_get_group_values(cache_manager_t *manager, entity_group_t group,
+                                      const entity_filter_t *filter, int *count) {
+    if (!manager || !count) {
         return NULL;
     }
 
-    return database_get_entities_by_domain(manager->db, domain, count);
+    return entity_store_group_values(&manager->entities, group, filter, count);
 }
 
-ha_entity_t* cache_manager_get_entity(cache_manager_t *manager, const char *entity_id) {
+const ha_entity_t* cache_manager_get_entity(cache_manager_t *manager, const char *entity_id) {
     if (!manager || !entity_id) {
         return NULL;
     }
 
-    return database_get_entity(manager->db, entity_id);
+    return entity_store_get(&manager->entities, entity_id);
 }
 
-ha_entity_t* cache_manager_refresh_entity(cache_manager_t *manager, const char *entity_id) {
-    if (!manager || !entity_id || !manager->ha_client) {
-        return NULL;
+int cache_manager_request_refresh(cache_manager_t *manager, const char *entity_id) {
+    if (!manager || !entity_id) {
+        return 0;
     }
 
-    // Fetch from API
-    ha_response_t *response = ha_client_get_state(manager->ha_client, entity_id);
-    if (!response || !response->success) {
-        if (response) {
-            ha_response_free(response);
-        }
-        // Return cached version on failure
-        return database_get_entity(manager->db, entity_id);
+    if (manager->sync) {
+        return queue_refresh(manager, entity_id) != 0;
+    }
+    if (!manager->ha_client) {
+        return 0;
     }
 
-    // Parse and save
-    ha_entity_t *entity = parse_single_entity(response->data);
-    ha_response_free(response);
-
-    if (entity) {
-        database_save_entity(manager->db, entity);
+    // No sync thread: block on the read, as service calls do
+    sync_call_t *call = sync_call_create_refresh(&entity_id, 1);
+    if (!call) {
+        return 0;
     }
+    call->id = ++manager->last_call_id;
+    strncpy(call->entity_id, entity_id, sizeof(call->entity_id) - 1);
 
-    return entity;
+    sync_call_run(manager->ha_client, call);
+    int success = call->success;
+    complete_call(manager, call);
+    return success;
 }
 
 int cache_manager_update_entity_state(cache_manager_t *manager,
@@ -246,31 +620,405 @@ int cache_manager_update_entity_state(cache_manager_t *manager,
     }
 
     // Get current entity from cache
-    ha_entity_t *entity = database_get_entity(manager->db, entity_id);
-    if (!entity) {
+    const ha_entity_t *cached = cache_manager_get_entity(manager, entity_id);
+    if (!cached) {
         return 0;
     }
 
-    // Update state
+    // Update state on a deep copy: storing it replaces the row's attributes
+    ha_entity_t *entity = copy_entity(cached);
+    if (!entity) {
+        return 0;
+    }
     strncpy(entity->state, new_state, sizeof(entity->state) - 1);
 
-    // Save back to database
-    int result = database_save_entity(manager->db, entity);
+    int stored = store_entity(manager, entity, 0) != NULL;
     free_entity(entity);
+    return stored;
+}
+
+int cache_manager_call_service(cache_manager_t *manager, const char *domain,
+                               const char *service, const char *entity_id,
+                               const char *params_json) {
+    if (!manager || !manager->ha_client || !domain || !service) {
+        return 0;
+    }
+
+    sync_call_t *call = sync_call_create(domain, service, entity_id, params_json);
+    if (!call) {
+        return 0;
+    }
+    call->id = ++manager->last_call_id;
+
+    // Show the expected result now; the server's answer reconciles it
+    const ha_entity_t *cached = entity_id ? cache_manager_get_entity(manager, entity_id) : NULL;
+    ha_entity_t *predicted = cached ? predict_entity(cached, service, params_json) : NULL;
+    if (predicted) {
+        if (add_pending(manager, call->id, cached, predicted)) {
+            show_prediction(manager, predicted);
+        } else {
+            free_entity(predicted);
+        }
+    }
+
+    if (manager->sync && sync_worker_call(manager->sync, call)) {
+        return 1;
+    }
+
+    // No sync thread: block on the call
+    sync_call_run(manager->ha_client, call);
+    int success = call->success;
+    complete_call(manager, call);
+    return success;
+}
+
+int cache_manager_is_pending(cache_manager_t *manager, const char *entity_id) {
+    if (!manager || !entity_id) {
+        return 0;
+    }
+
+    return find_pending(manager, entity_id) >= 0;
+}
+
+int cache_manager_get_history(cache_manager_t *manager, const char *entity_id,
+                              time_t from, time_t to,
+                              history_point_t *points, int max_points) {
+    if (!manager || !entity_id || !points) {
+        return 0;
+    }
 
-    return result;
+    return database_get_history(manager->db, entity_id, from, to, points, max_points);
 }
 
 /* ============================================
- * Favorites Operations
+ * Optimistic Updates
  * ============================================ */
 
-ha_entity_t** cache_manager_get_favorites(cache_manager_t *manager, int *count) {
-    if (!manager || !count) {
+/**
+ * Helper: State a service call should leave the entity in, or NULL if
+ * it cannot be predicted (e.g. scenes, buttons, unknown services)
+ */
+static const char* predict_state(const ha_entity_t *entity, const char *service) {
+    int is_on = strcmp(entity->state, "on") == 0;
+    int is_off = strcmp(entity->state, "off") == 0;
+
+    if (strcmp(service, "toggle") == 0) {
+        return is_on ? "off" : is_off ? "on" : NULL;
+    }
+    if (strcmp(service, "turn_on") == 0) {
+        return (is_on || is_off) ? "on" : NULL;
+    }
+    if (strcmp(service, "turn_off") == 0) {
+        return (is_on || is_off) ? "off" : NULL;
+    }
+    if (strcmp(service, "lock") == 0) return "locked";
+    if (strcmp(service, "unlock") == 0) return "unlocked";
+    if (strcmp(service, "open_cover") == 0) return "open";
+    if (strcmp(service, "close_cover") == 0) return "closed";
+    return NULL;
+}
+
+/**
+ * Helper: Predicted copy of an entity after a service call, NULL if the
+ * call has no predictable effect. Service data such as brightness or
+ * color_temp is merged into the attributes.
+ */
+static ha_entity_t* predict_entity(const ha_entity_t *entity, const char *service,
+                                   const char *params_json) {
+    const char *state = predict_state(entity, service);
+    char overlay[64];
+    const char *attributes = params_json;
+
+    // Covers report the position they were sent as current_position
+    if (strcmp(service, "set_cover_position") == 0 && params_json) {
+        const char *value = strstr(params_json, "\"position\":");
+        int position;
+        if (!value || sscanf(value, "\"position\":%d", &position) != 1) {
+            return NULL;
+        }
+        snprintf(overlay, sizeof(overlay), "{\"current_position\":%d}", position);
+        attributes = overlay;
+        state = position > 0 ? "open" : "closed";
+    }
+
+    if (!state && !attributes) {
+        return NULL;
+    }
+
+    ha_entity_t *predicted = copy_entity(entity);
+    if (!predicted) {
+        return NULL;
+    }
+
+    if (state) {
+        strncpy(predicted->state, state, sizeof(predicted->state) - 1);
+    }
+    if (attributes) {
+        char *merged = json_merge_objects(entity->attributes_json, attributes);
+        if (merged) {
+            free(predicted->attributes_json);
+            predicted->attributes_json = merged;
+        }
+    }
+
+    return predicted;
+}
+
+static int find_pending(cache_manager_t *manager, const char *entity_id) {
+    for (int i = 0; i < manager->pending_count; i++) {
+        if (strcmp(manager->pending[i].predicted->entity_id, entity_id) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Helper: Remember a prediction (takes ownership of predicted). A second
+ * call on a pending entity keeps the original rollback state.
+ */
+static int add_pending(cache_manager_t *manager, unsigned long call_id,
+                       const ha_entity_t *current, ha_entity_t *predicted) {
+    int index = find_pending(manager, current->entity_id);
+    if (index >= 0) {
+        free_entity(manager->pending[index].predicted);
+        manager->pending[index].predicted = predicted;
+        manager->pending[index].call_id = call_id;
+        return 1;
+    }
+
+    if (manager->pending_count == CACHE_MAX_PENDING) {
+        return 0;
+    }
+
+    ha_entity_t *rollback = copy_entity(current);
+    if (!rollback) {
+        return 0;
+    }
+
+    cache_pending_t *pending = &manager->pending[manager->pending_count++];
+    pending->call_id = call_id;
+    pending->rollback = rollback;
+    pending->predicted = predicted;
+    return 1;
+}
+
+static void drop_pending(cache_manager_t *manager, int index) {
+    free_entity(manager->pending[index].rollback);
+    free_entity(manager->pending[index].predicted);
+    manager->pending[index] = manager->pending[--manager->pending_count];
+}
+
+/**
+ * Helper: Show a prediction in memory only; the database keeps the
+ * server's state until the answer confirms it or a rollback replaces it
+ */
+static void show_prediction(cache_manager_t *manager, const ha_entity_t *predicted) {
+    if (entity_store_put(&manager->entities, predicted, &manager->changes) &&
+        manager->changes.layout) {
+        rebuild_search_index(manager);
+    }
+    publish_changes(manager);
+}
+
+/**
+ * Helper: View of a sync snapshot with pending predictions in place of
+ * their rows, so an answer in flight doesn't flicker back. The snapshot
+ * itself is not modified. Returns entities itself when nothing is
+ * pending, an array to free otherwise, NULL on allocation failure.
+ */
+static const ha_entity_t** overlay_pending(cache_manager_t *manager, ha_entity_t **entities,
+                                           int count) {
+    if (manager->pending_count == 0) {
+        return (const ha_entity_t **)entities;
+    }
+
+    const ha_entity_t **shown = malloc((count ? count : 1) * sizeof(ha_entity_t *));
+    if (!shown) {
         return NULL;
     }
+    memcpy(shown, entities, count * sizeof(ha_entity_t *));
+
+    for (int p = 0; p < manager->pending_count; p++) {
+        const ha_entity_t *predicted = manager->pending[p].predicted;
+        for (int i = 0; i < count; i++) {
+            if (strcmp(shown[i]->entity_id, predicted->entity_id) == 0) {
+                shown[i] = predicted;
+                break;
+            }
+        }
+    }
+    return shown;
+}
+
+/**
+ * Helper: Queue a refresh of the visible set when one is due. One
+ * refresh is in flight at a time; none while idle or offline.
+ */
+static void refresh_visible(cache_manager_t *manager) {
+    if (manager->visible_count == 0 || manager->visible_call ||
+        manager->schedule.activity == SYNC_ACTIVITY_IDLE || manager->schedule.failures > 0) {
+        return;
+    }
+
+    time_t now = time(NULL);
+    if (now < manager->visible_next) {
+        return;
+    }
+
+    const char *ids[CACHE_MAX_VISIBLE];
+    for (int i = 0; i < manager->visible_count; i++) {
+        ids[i] = manager->visible[i];
+    }
+
+    sync_call_t *call = sync_call_create_refresh(ids, manager->visible_count);
+    if (!call) {
+        return;
+    }
+    call->id = ++manager->last_call_id;
+
+    if (!sync_worker_call(manager->sync, call)) {
+        sync_call_free(call);
+        return;
+    }
+    manager->visible_call = call->id;
+    manager->visible_next = now + SYNC_VISIBLE_INTERVAL;
+}
+
+/**
+ * Helper: Queue a read of one entity on the sync worker. The call is
+ * tagged with the entity so its answer can confirm a pending prediction.
+ * Returns the call ID, 0 without a sync thread or on failure.
+ */
+static unsigned long queue_refresh(cache_manager_t *manager, const char *entity_id) {
+    if (!manager->sync) {
+        return 0;
+    }
+
+    sync_call_t *call = sync_call_create_refresh(&entity_id, 1);
+    if (!call) {
+        return 0;
+    }
+    unsigned long id = ++manager->last_call_id;
+    call->id = id;
+    strncpy(call->entity_id, entity_id, sizeof(call->entity_id) - 1);
+
+    if (!sync_worker_call(manager->sync, call)) {
+        sync_call_free(call);
+        return 0;
+    }
+    return id;
+}
+
+/**
+ * Helper: Reconcile a finished call with its prediction (or apply a state
+ * refresh), then free it
+ */
+static void complete_call(cache_manager_t *manager, sync_call_t *call) {
+    int index = find_pending(manager, call->entity_id);
+    int latest = index >= 0 && manager->pending[index].call_id == call->id;
+
+    if (call->type == SYNC_CALL_REFRESH) {
+        if (call->id == manager->visible_call) {
+            manager->visible_call = 0;
+        }
+        if (!call->success) {
+            fprintf(stderr, "State refresh failed (HTTP %d)\n", call->status_code);
+        }
+    }
+
+    int answered = 0;
+    if (call->success && call->changed) {
+        // An older call's answer would undo a newer prediction
+        int kept = 0;
+        for (int i = 0; i < call->changed_count; i++) {
+            ha_entity_t *entity = call->changed[i];
+            int other = find_pending(manager, entity->entity_id);
+            if (other >= 0 && manager->pending[other].call_id != call->id) {
+                free_entity(entity);
+                continue;
+            }
+            if (strcmp(entity->entity_id, call->entity_id) == 0) {
+                answered = 1;
+            }
+            call->changed[kept++] = entity;
+        }
+
+        if (kept > 0) {
+            store_entities(manager, call->changed, kept, time(NULL));
+        } else {
+            free(call->changed);
+        }
+        call->changed = NULL;
+    } else if (!call->success && call->type == SYNC_CALL_SERVICE) {
+        fprintf(stderr, "Service %s.%s failed for %s (HTTP %d)\n", call->domain,
+                call->service, call->entity_id, call->status_code);
+        if (latest) {
+            put_entity(manager, manager->pending[index].rollback, 0);
+        }
+        entity_changes_add(&manager->changes, ENTITY_CHANGE_REJECTED, call->entity_id);
+    }
+
+    // Success without the entity in the answer leaves the guess
+    // unconfirmed: keep it pending until a read-back settles it
+    if (latest && call->success && call->type == SYNC_CALL_SERVICE && !answered) {
+        unsigned long read_back = queue_refresh(manager, call->entity_id);
+        if (read_back) {
+            manager->pending[index].call_id = read_back;
+            latest = 0;
+        }
+    }
+
+    if (latest) {
+        drop_pending(manager, index);
+        // The row stops showing as pending even if its state is unchanged
+        if (!entity_changes_find(&manager->changes, call->entity_id)) {
+            entity_changes_add(&manager->changes, ENTITY_CHANGE_STATE, call->entity_id);
+        }
+    }
+
+    publish_changes(manager);
+    sync_call_free(call);
+}
+
+/* ============================================
+ * Search
+ * ============================================ */
+
+/**
+ * Helper: Rebuild the search index from the cached entities
+ */
+static void rebuild_search_index(cache_manager_t *manager) {
+    if (!manager->search) return;
+
+    if (!search_index_rebuild(manager->search,
+                              (const ha_entity_t *const *)manager->entities.rows,
+                              manager->entities.count)) {
+        fprintf(stderr, "Failed to rebuild search index\n");
+    }
+}
+
+int cache_manager_search(cache_manager_t *manager, search_query_t *query, const char *prefix,
+                         search_result_t *results, int max_results) {
+    if (!manager || !manager->search) {
+        return 0;
+    }
+
+    return search_index_query(manager->search, query, prefix, results, max_results);
+}
 
-    return database_get_favorites(manager->db, count);
+/* ============================================
+ * Favorites Operations
+ * ============================================ */
+
+/**
+ * Helper: Refresh the favorites index and invalidate selections
+ */
+static void favorites_changed(cache_manager_t *manager) {
+    if (!entity_store_index_favorites(&manager->entities, &manager->favorites)) {
+        fprintf(stderr, "Failed to update favorites index\n");
+    }
+    manager->favorites_version++;
 }
 
 int cache_manager_add_favorite(cache_manager_t *manager, const char *entity_id) {
@@ -278,7 +1026,26 @@ int cache_manager_add_favorite(cache_manager_t *manager, const char *entity_id)
         return 0;
     }
 
-    return database_add_favorite(manager->db, entity_id);
+    if (manager->writer) {
+        // The set answers immediately; the row follows on the writer thread
+        if (!str_map_put(&manager->favorites, entity_id, 1)) {
+            return 0;
+        }
+        favorites_changed(manager);
+        db_writer_set_favorite(manager->writer, entity_id, 1);
+        return 1;
+    }
+
+    // Write-through: persist first so the set never claims an unsaved favorite
+    if (!database_add_favorite(manager->db, entity_id)) {
+        return 0;
+    }
+
+    if (!str_map_put(&manager->favorites, entity_id, 1)) {
+        return 0;
+    }
+    favorites_changed(manager);
+    return 1;
 }
 
 int cache_manager_remove_favorite(cache_manager_t *manager, const char *entity_id) {
@@ -286,7 +1053,20 @@ int cache_manager_remove_favorite(cache_manager_t *manager, const char *entity_i
         return 0;
     }
 
-    return database_remove_favorite(manager->db, entity_id);
+    if (manager->writer) {
+        str_map_remove(&manager->favorites, entity_id);
+        favorites_changed(manager);
+        db_writer_set_favorite(manager->writer, entity_id, 0);
+        return 1;
+    }
+
+    if (!database_remove_favorite(manager->db, entity_id)) {
+        return 0;
+    }
+
+    str_map_remove(&manager->favorites, entity_id);
+    favorites_changed(manager);
+    return 1;
 }
 
 int cache_manager_toggle_favorite(cache_manager_t *manager, const char *entity_id) {
@@ -294,12 +1074,10 @@ int cache_manager_toggle_favorite(cache_manager_t *manager, const char *entity_i
         return -1;
     }
 
-    if (database_is_favorite(manager->db, entity_id)) {
-        database_remove_favorite(manager->db, entity_id);
-        return 0;
+    if (cache_manager_is_favorite(manager, entity_id)) {
+        return cache_manager_remove_favorite(manager, entity_id) ? 0 : -1;
     } else {
-        database_add_favorite(manager->db, entity_id);
-        return 1;
+        return cache_manager_add_favorite(manager, entity_id) ? 1 : -1;
     }
 }
 
@@ -308,7 +1086,7 @@ int cache_manager_is_favorite(cache_manager_t *manager, const char *entity_id) {
         return 0;
     }
 
-    return database_is_favorite(manager->db, entity_id);
+    return str_map_get(&manager->favorites, entity_id, NULL);
 }
 
 /* ============================================
@@ -319,10 +1097,139 @@ int cache_manager_is_online(cache_manager_t *manager) {
     return manager ? manager->online : 0;
 }
 
+int cache_manager_is_syncing(cache_manager_t *manager) {
+    return manager && manager->sync && manager->schedule.requested_at != 0;
+}
+
 int cache_manager_get_entity_count(cache_manager_t *manager) {
     if (!manager) {
         return 0;
     }
 
-    return database_get_entity_count(manager->db);
+    return manager->entities.count;
+}
+
+/* ============================================
+ * Write-behind and Notification
+ * ============================================ */
+
+/**
+ * Helper: Load the entity table from the database (startup only)
+ */
+static void load_entities(cache_manager_t *manager) {
+    int count = 0;
+    ha_entity_t *block = database_get_all_entities(manager->db, &count);
+    if (!block || count == 0) {
+        database_free_entities(block);
+        return;
+    }
+
+    const ha_entity_t **rows = malloc(count * sizeof(ha_entity_t *));
+    if (rows) {
+        for (int i = 0; i < count; i++) {
+            rows[i] = &block[i];
+        }
+        if (!entity_store_replace(&manager->entities, rows, count, NULL)) {
+            fprintf(stderr, "Failed to load cached entities\n");
+        }
+        free(rows);
+    }
+
+    database_free_entities(block);
+}
+
+/**
+ * Helper: Update one entity in memory and persist it behind the reader,
+ * collecting the change without publishing it.
+ * now == 0 skips the history sample (local state edits).
+ */
+static const ha_entity_t* put_entity(cache_manager_t *manager, ha_entity_t *entity, time_t now) {
+    const ha_entity_t *row = entity_store_put(&manager->entities, entity, &manager->changes);
+    if (!row) {
+        return NULL;
+    }
+
+    if (manager->changes.layout) {
+        rebuild_search_index(manager);
+    }
+
+    if (manager->writer) {
+        db_writer_save_entity(manager->writer, entity, now);
+    } else if (database_save_entity(manager->db, entity) && now) {
+        database_append_history(manager->db, &entity, 1, now);
+    }
+
+    return row;
+}
+
+/**
+ * Helper: Update several entities in memory and persist the ones that
+ * changed as one batch, collecting the changes without publishing them.
+ * Takes ownership of the array and entities. The registry area is not
+ * part of state responses, so the cached area is kept.
+ */
+static void store_entities(cache_manager_t *manager, ha_entity_t **entities, int count, time_t now) {
+    int changed = 0;
+    for (int i = 0; i < count; i++) {
+        const ha_entity_t *cached = cache_manager_get_entity(manager, entities[i]->entity_id);
+        if (cached && entities[i]->area_id[0] == '\0') {
+            snprintf(entities[i]->area_id, sizeof(entities[i]->area_id), "%s", cached->area_id);
+        }
+
+        int recorded = manager->changes.count;
+        if (!entity_store_put(&manager->entities, entities[i], &manager->changes)) {
+            fprintf(stderr, "Failed to update %s (out of memory)\n", entities[i]->entity_id);
+        }
+
+        // Unchanged rows (most of a visible-set refresh) are not written
+        // again; a row that showed a prediction only held it in memory
+        if (manager->changes.count > recorded ||
+            find_pending(manager, entities[i]->entity_id) >= 0) {
+            entities[changed++] = entities[i];
+        } else {
+            free_entity(entities[i]);
+        }
+    }
+    count = changed;
+
+    if (manager->changes.layout) {
+        rebuild_search_index(manager);
+    }
+
+    if (count == 0) {
+        free(entities);
+        return;
+    }
+
+    if (manager->writer) {
+        db_writer_save_entities(manager->writer, entities, count, now);
+        return;
+    }
+
+    database_save_entities(manager->db, entities, count);
+    database_append_history(manager->db, entities, count, now);
+    free_entities(entities, count);
+}
+
+/**
+ * Helper: put_entity() and publish the change right away
+ */
+static const ha_entity_t* store_entity(cache_manager_t *manager, ha_entity_t *entity, time_t now) {
+    const ha_entity_t *row = put_entity(manager, entity, now);
+    publish_changes(manager);
+    return row;
+}
+
+/**
+ * Helper: Hand the collected change set to subscribers, then reset it
+ */
+static void publish_changes(cache_manager_t *manager) {
+    if (manager->changes.count == 0 && !manager->changes.layout) {
+        return;
+    }
+
+    for (int i = 0; i < manager->subscriber_count; i++) {
+        manager->subscribers[i].fn(&manager->changes, manager->subscribers[i].ctx);
+    }
+    entity_changes_clear(&manager->changes);
 }
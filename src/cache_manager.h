@@ -4,6 +4,15 @@
  * High-level caching logic that coordinates between the API client
  * and local SQLite database. Handles sync, offline mode, and updates.
  *
+ * All entities are held in an in-memory table that answers every read;
+ * SQLite is write-behind persistence, read only at startup. Reads return
+ * borrowed pointers into that table (see entity_store.h for lifetimes).
+ * Each sync or entity update publishes the set of added, removed and
+ * changed entities to subscribed screens.
+ *
+ * Periodic syncs are fetched on a background thread; the table is only
+ * ever modified on the UI thread, in cache_manager_poll() between frames.
+ *
  * Phase 3: Data Storage
  */
 
@@ -11,14 +20,103 @@
 #define CACHE_MANAGER_H
 
 #include "database.h"
+#include "db_writer.h"
+#include "entity_store.h"
 #include "ha_client.h"
+#include "search_index.h"
+#include "sync_worker.h"
+#include "utils/str_map.h"
 #include <time.h>
 
 /**
- * Default sync interval in seconds (5 minutes)
+ * Default sync interval in seconds (5 minutes), used while idle
  */
 #define DEFAULT_SYNC_INTERVAL 300
 
+/**
+ * Adaptive sync intervals in seconds
+ */
+#define SYNC_DETAIL_INTERVAL   15    // Looking at one entity
+#define SYNC_LIST_INTERVAL     60    // Browsing a list
+#define SYNC_OFFLINE_RETRY     15    // First retry after a failed sync, doubled per failure
+#define SYNC_MAX_INTERVAL      1800  // Ceiling for every backoff
+#define SYNC_QUIET_BACKOFF     3     // Unchanged syncs double the interval up to 2^3 times
+#define SYNC_STALL_TIMEOUT     120   // Give up waiting for a requested sync after this
+#define SYNC_VISIBLE_INTERVAL  2     // Entities on screen, read on their own
+
+/**
+ * How often to look for a background save's write time while one is
+ * outstanding (the writer has no completion callback)
+ */
+#define CACHE_WRITE_POLL_MS 100
+
+/**
+ * What the user is doing, as far as freshness is concerned
+ */
+typedef enum {
+    SYNC_ACTIVITY_IDLE,      // No recent input
+    SYNC_ACTIVITY_LIST,      // Browsing a list or search
+    SYNC_ACTIVITY_DETAIL     // Looking at one entity
+} sync_activity_t;
+
+/**
+ * Sync scheduler state and its last decision
+ */
+typedef struct {
+    sync_activity_t activity;
+    int quiet_syncs;         // Consecutive syncs that changed nothing
+    int failures;            // Consecutive failed syncs (offline)
+    time_t last_attempt;     // When the last sync finished
+    time_t requested_at;     // When the sync in flight was requested (0: none)
+    int interval;            // Decided interval in seconds
+    time_t next_sync;        // last_attempt + interval
+    const char *reason;      // "detail", "list", "background", "idle" or "offline"
+} sync_schedule_t;
+
+/**
+ * Maximum entities refreshed as the visible set
+ */
+#define CACHE_MAX_VISIBLE 16
+
+/**
+ * Number of recent syncs whose timings are kept
+ */
+#define CACHE_SYNC_HISTORY 16
+
+/**
+ * Maximum change subscribers
+ */
+#define CACHE_MAX_SUBSCRIBERS 8
+
+/**
+ * Maximum optimistic updates awaiting confirmation
+ */
+#define CACHE_MAX_PENDING 16
+
+/**
+ * Optimistic update awaiting confirmation
+ */
+typedef struct {
+    unsigned long call_id;     // Latest call for this entity
+    ha_entity_t *rollback;     // Server state before the first prediction (owned)
+    ha_entity_t *predicted;    // Shown until the server answers (owned)
+} cache_pending_t;
+
+/**
+ * Change callback, called after each sync or entity update that changed
+ * something. The cache already shows the new data when it runs.
+ * Callbacks must not write to the cache.
+ */
+typedef void (*cache_change_fn)(const entity_changes_t *changes, void *ctx);
+
+/**
+ * Registered change callback
+ */
+typedef struct {
+    cache_change_fn fn;
+    void *ctx;
+} cache_subscriber_t;
+
 /**
  * Cache manager context
  */
@@ -28,6 +126,34 @@ typedef struct {
     time_t last_sync;
     int sync_interval;
     int online;            // 1 if connected to HA, 0 if offline
+    entity_store_t entities; // In-memory entity table (authoritative for reads)
+    str_map_t favorites;   // In-memory favorites set (authoritative for the UI)
+    unsigned int favorites_version; // Bumped when the favorites set changes
+    search_index_t *search; // Name/ID search index (rebuilt after sync)
+    db_writer_t *writer;   // Background writes (NULL: write synchronously)
+    sync_worker_t *sync;   // Background fetches (NULL: sync only on request)
+    sync_schedule_t schedule; // When the next background sync is due
+
+    // Entities on screen, refreshed at SYNC_VISIBLE_INTERVAL
+    char visible[CACHE_MAX_VISIBLE][128];
+    int visible_count;
+    time_t visible_next;       // When the next refresh is due
+    unsigned long visible_call; // Refresh in flight (0: none)
+
+    // Timings of recent syncs (ring, oldest overwritten)
+    sync_stats_t sync_history[CACHE_SYNC_HISTORY];
+    int sync_history_count;
+    int sync_history_next;     // Slot the next sync goes into
+
+    // Optimistic updates
+    cache_pending_t pending[CACHE_MAX_PENDING];
+    int pending_count;
+    unsigned long last_call_id;
+
+    // Change notification
+    entity_changes_t changes;  // Batch being collected
+    cache_subscriber_t subscribers[CACHE_MAX_SUBSCRIBERS];
+    int subscriber_count;
 } cache_manager_t;
 
 /**
@@ -47,7 +173,41 @@ cache_manager_t* cache_manager_create(database_t *db, ha_client_t *client);
 void cache_manager_destroy(cache_manager_t *manager);
 
 /**
- * Set sync interval
+ * Block until every queued write has been committed
+ *
+ * @param manager Cache manager
+ */
+void cache_manager_flush(cache_manager_t *manager);
+
+/**
+ * Write an in-memory database back to its file (no-op for file databases)
+ * Queued on the writer thread; see database_snapshot().
+ *
+ * @param manager Cache manager
+ */
+void cache_manager_snapshot(cache_manager_t *manager);
+
+/**
+ * Subscribe to change sets
+ *
+ * @param manager Cache manager
+ * @param fn Callback
+ * @param ctx Passed to the callback
+ * @return 1 on success, 0 if there is no free slot
+ */
+int cache_manager_subscribe(cache_manager_t *manager, cache_change_fn fn, void *ctx);
+
+/**
+ * Remove a subscription
+ *
+ * @param manager Cache manager
+ * @param fn Callback given to cache_manager_subscribe()
+ * @param ctx Context given to cache_manager_subscribe()
+ */
+void cache_manager_unsubscribe(cache_manager_t *manager, cache_change_fn fn, void *ctx);
+
+/**
+ * Set sync interval while idle (busier activities sync faster)
  *
  * @param manager Cache manager
  * @param seconds Interval in seconds (minimum 60)
@@ -59,8 +219,9 @@ void cache_manager_set_sync_interval(cache_manager_t *manager, int seconds);
  * ============================================ */
 
 /**
- * Perform full sync with Home Assistant
- * Fetches all entities and updates the cache
+ * Perform full sync with Home Assistant (blocking; used at startup)
+ * Fetches all entities into the in-memory table; persisting them is
+ * queued for the background writer.
  *
  * @param manager Cache manager
  * @return Number of entities synced, or -1 on failure
@@ -68,7 +229,93 @@ void cache_manager_set_sync_interval(cache_manager_t *manager, int seconds);
 int cache_manager_sync(cache_manager_t *manager);
 
 /**
- * Check if sync is needed based on interval
+ * Start periodic sync on a background thread
+ * Fetched snapshots are applied by cache_manager_poll().
+ *
+ * @param manager Cache manager
+ * @param notify Called on the sync thread when a snapshot or call result
+ *               is ready for cache_manager_poll() (can be NULL)
+ * @param notify_ctx Passed to notify
+ * @return 1 if running, 0 if offline or the thread could not start
+ */
+int cache_manager_start_sync_thread(cache_manager_t *manager, sync_notify_fn notify,
+                                    void *notify_ctx);
+
+/**
+ * Sync as soon as possible without blocking
+ * Without a sync thread this falls back to cache_manager_sync().
+ *
+ * @param manager Cache manager
+ * @return 0 if queued, otherwise the cache_manager_sync() result
+ */
+int cache_manager_request_sync(cache_manager_t *manager);
+
+/**
+ * Request a sync when the schedule says one is due, apply a snapshot
+ * finished by the sync thread, if one is waiting, and reconcile
+ * finished service calls.
+ * Call once per frame from the UI thread, before rendering; change
+ * callbacks run from here.
+ *
+ * @param manager Cache manager
+ * @return 1 if a snapshot was applied, 0 otherwise
+ */
+int cache_manager_poll(cache_manager_t *manager);
+
+/**
+ * Time until cache_manager_poll() has timed work: a scheduled sync, a
+ * stalled request to retry, a visible-set refresh or a write time to
+ * collect. Results from the sync thread are not included; they arrive
+ * through the notify callback.
+ *
+ * @param manager Cache manager
+ * @return Milliseconds (0: poll now), or -1 if nothing is scheduled
+ */
+int cache_manager_poll_timeout(cache_manager_t *manager);
+
+/**
+ * Tell the scheduler what the user is doing
+ * Cheap when unchanged; call every frame.
+ *
+ * @param manager Cache manager
+ * @param activity Current activity
+ */
+void cache_manager_set_activity(cache_manager_t *manager, sync_activity_t activity);
+
+/**
+ * Set the entities currently on screen
+ * While the sync thread runs and the user is active, these are read back
+ * every SYNC_VISIBLE_INTERVAL seconds in one small request, and the full
+ * sync drops to the background interval. A new set is refreshed right
+ * away. Cheap when unchanged; call every frame.
+ *
+ * @param manager Cache manager
+ * @param entity_ids Entity IDs (copied; at most CACHE_MAX_VISIBLE are kept)
+ * @param count Number of IDs, 0 for none
+ */
+void cache_manager_set_visible(cache_manager_t *manager, const char *const *entity_ids,
+                               int count);
+
+/**
+ * Get the scheduler's current decision (for diagnostics)
+ *
+ * @param manager Cache manager
+ * @return Borrowed schedule, NULL if manager is NULL
+ */
+const sync_schedule_t* cache_manager_get_schedule(cache_manager_t *manager);
+
+/**
+ * Get the timings of a recent sync (for diagnostics)
+ * The write time of a background save fills in a few frames later.
+ *
+ * @param manager Cache manager
+ * @param index 0 for the latest sync, 1 for the one before, ...
+ * @return Borrowed stats, NULL if there is no such sync
+ */
+const sync_stats_t* cache_manager_get_sync_stats(cache_manager_t *manager, int index);
+
+/**
+ * Check if a sync is due according to the schedule
  *
  * @param manager Cache manager
  * @return 1 if sync is needed, 0 otherwise
@@ -96,48 +343,104 @@ time_t cache_manager_get_last_sync(cache_manager_t *manager);
  * ============================================ */
 
 /**
- * Get all entities from cache
- * Returns cached data, syncs first if stale
+ * Get the view version
+ * Changes whenever entities are added, removed or reordered, or the
+ * favorites set changes. Selections made with cache_manager_select()
+ * stay valid until it does.
  *
  * @param manager Cache manager
- * @param count Output: number of entities
- * @return Array of entities (caller must free with free_entities)
+ * @return Current version
  */
-ha_entity_t** cache_manager_get_entities(cache_manager_t *manager, int *count);
+unsigned int cache_manager_get_version(cache_manager_t *manager);
 
 /**
- * Get entities by domain from cache
+ * Select cached entities matching a filter, ordered by (friendly_name, entity_id)
+ * Rows are borrowed: they always show current state and stay valid until
+ * cache_manager_get_version() changes. Do not free them.
  *
  * @param manager Cache manager
- * @param domain Domain filter (e.g., "light")
- * @param count Output: number of entities
- * @return Array of entities (caller must free with free_entities)
+ * @param filter Row filter (group, value, domain restriction)
+ * @param rows Output: borrowed entity pointers (can be NULL when max_rows is 0)
+ * @param max_rows Capacity of rows
+ * @return Total number of matching entities (may exceed max_rows)
  */
-ha_entity_t** cache_manager_get_entities_by_domain(cache_manager_t *manager,
-                                                    const char *domain,
-                                                    int *count);
+int cache_manager_select(cache_manager_t *manager, const entity_filter_t *filter,
+                         const ha_entity_t **rows, int max_rows);
+
+/**
+ * Count cached entities matching a filter
+ *
+ * @param manager Cache manager
+ * @param filter Row filter
+ * @return Number of matching entities
+ */
+int cache_manager_count_entities(cache_manager_t *manager, const entity_filter_t *filter);
+
+/**
+ * Get distinct domains or areas present in the cache
+ *
+ * @param manager Cache manager
+ * @param group ENTITY_GROUP_DOMAIN or ENTITY_GROUP_AREA
+ * @param filter Domain restriction (can be NULL)
+ * @param count Output: number of values
+ * @return Sorted array of strings (caller must free each string and the array)
+ */
+char** cache_manager_get_group_values(cache_manager_t *manager, entity_group_t group,
+                                      const entity_filter_t *filter, int *count);
 
 /**
  * Get single entity from cache
  *
  * @param manager Cache manager
  * @param entity_id Entity ID
- * @return Entity (caller must free) or NULL
+ * @return Borrowed entity (do not free; copy to keep past a sync) or NULL
  */
-ha_entity_t* cache_manager_get_entity(cache_manager_t *manager, const char *entity_id);
+const ha_entity_t* cache_manager_get_entity(cache_manager_t *manager, const char *entity_id);
 
 /**
- * Refresh single entity from API and update cache
+ * Refresh a single entity
+ * Queued on the sync thread; the new state reaches subscribers from
+ * cache_manager_poll(). Without a sync thread the request blocks. An
+ * entity with a call in flight keeps its prediction until the call answers.
  *
  * @param manager Cache manager
  * @param entity_id Entity ID to refresh
- * @return Updated entity (caller must free) or NULL on failure
+ * @return 1 if queued (or fetched, without a sync thread), 0 on failure
+ */
+int cache_manager_request_refresh(cache_manager_t *manager, const char *entity_id);
+
+/**
+ * Call a service and show its predicted result right away
+ * The target row changes to the predicted state (toggle, brightness,
+ * position...) and stays pending until the server answers. On success
+ * every state in the response replaces the cache's copy in one batch,
+ * side effects included (e.g. the lights a scene turned on); on failure
+ * the row is rolled back and subscribers get an ENTITY_CHANGE_REJECTED
+ * change. The call runs on the sync thread when
+ * there is one, otherwise it blocks.
+ *
+ * @param manager Cache manager
+ * @param domain Service domain
+ * @param service Service name
+ * @param entity_id Target entity (can be NULL)
+ * @param params_json Extra service data as a JSON object (can be NULL)
+ * @return 1 if sent (queued, or succeeded when blocking), 0 on failure
+ */
+int cache_manager_call_service(cache_manager_t *manager, const char *domain,
+                               const char *service, const char *entity_id,
+                               const char *params_json);
+
+/**
+ * Check whether an entity shows a prediction the server has not confirmed
+ *
+ * @param manager Cache manager
+ * @param entity_id Entity ID
+ * @return 1 if pending, 0 otherwise
  */
-ha_entity_t* cache_manager_refresh_entity(cache_manager_t *manager, const char *entity_id);
+int cache_manager_is_pending(cache_manager_t *manager, const char *entity_id);
 
 /**
- * Update entity state in cache after control action
- * Used for optimistic updates before API confirms
+ * Update entity state in cache without contacting the server
  *
  * @param manager Cache manager
  * @param entity_id Entity ID
@@ -148,18 +451,43 @@ int cache_manager_update_entity_state(cache_manager_t *manager,
                                        const char *entity_id,
                                        const char *new_state);
 
+/**
+ * Get downsampled state history for an entity
+ * Samples are recorded on sync and on single-entity refresh.
+ *
+ * @param manager Cache manager
+ * @param entity_id Entity ID
+ * @param from Range start (inclusive)
+ * @param to Range end (exclusive)
+ * @param points Output buffer
+ * @param max_points Capacity of points (result never exceeds it)
+ * @return Number of points written (oldest first)
+ */
+int cache_manager_get_history(cache_manager_t *manager, const char *entity_id,
+                              time_t from, time_t to,
+                              history_point_t *points, int max_points);
+
 /* ============================================
- * Favorites Operations (through cache)
+ * Search
  * ============================================ */
 
 /**
- * Get favorite entities
+ * Prefix search over cached entity names and IDs
+ * Answered from the in-memory index; never touches the database.
  *
  * @param manager Cache manager
- * @param count Output: number of favorites
- * @return Array of entities (caller must free with free_entities)
+ * @param query Incremental query state (keep one per search box)
+ * @param prefix Text typed so far
+ * @param results Output buffer
+ * @param max_results Capacity of results
+ * @return Number of results written
  */
-ha_entity_t** cache_manager_get_favorites(cache_manager_t *manager, int *count);
+int cache_manager_search(cache_manager_t *manager, search_query_t *query, const char *prefix,
+                         search_result_t *results, int max_results);
+
+/* ============================================
+ * Favorites Operations (through cache)
+ * ============================================ */
 
 /**
  * Add entity to favorites
@@ -190,6 +518,7 @@ int cache_manager_toggle_favorite(cache_manager_t *manager, const char *entity_i
 
 /**
  * Check if entity is favorited
+ * Answered from the in-memory set; safe to call from render paths.
  *
  * @param manager Cache manager
  * @param entity_id Entity ID
@@ -209,6 +538,15 @@ int cache_manager_is_favorite(cache_manager_t *manager, const char *entity_id);
  */
 int cache_manager_is_online(cache_manager_t *manager);
 
+/**
+ * Check if a full sync is running on the sync thread
+ * Screens show the cached data meanwhile and can say it is being refreshed.
+ *
+ * @param manager Cache manager
+ * @return 1 if a requested sync has not finished yet, 0 otherwise
+ */
+int cache_manager_is_syncing(cache_manager_t *manager);
+
 /**
  * Get entity count in cache
  *
@@ -6,6 +6,21 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Background snapshot of an in-memory database
+ */
+struct db_snapshot {
+    pthread_t thread;
+    sqlite3 *copy;          // Private RAM copy being written
+    char path[256];
+    int changes;            // total_changes the copy corresponds to
+    int done;               // Set by the thread (atomic)
+    int result;             // 1 on success
+};
 
 /* ============================================
  * SQL Schema
@@ -32,8 +47,42 @@ static const char *SCHEMA_SQL =
     "    key TEXT PRIMARY KEY,"
     "    value TEXT"
     ");"
+    "CREATE TABLE IF NOT EXISTS state_history ("
+    "    entity_id TEXT NOT NULL,"
+    "    ts INTEGER NOT NULL,"
+    "    tier INTEGER NOT NULL,"
+    "    value REAL NOT NULL,"
+    "    min_value REAL NOT NULL,"
+    "    max_value REAL NOT NULL,"
+    "    samples INTEGER NOT NULL DEFAULT 1,"
+    "    PRIMARY KEY (entity_id, ts, tier)"
+    ") WITHOUT ROWID;";
+
+/**
+ * Schema migrations, applied in order on top of SCHEMA_SQL.
+ * MIGRATIONS[i] upgrades user_version i to i + 1; append only.
+ */
+static const char *MIGRATIONS[DATABASE_SCHEMA_VERSION] = {
+    // 1: Baseline indexes
     "CREATE INDEX IF NOT EXISTS idx_entities_domain ON entities(domain);"
-    "CREATE INDEX IF NOT EXISTS idx_entities_area ON entities(area_id);";
+    "CREATE INDEX IF NOT EXISTS idx_entities_area ON entities(area_id);"
+    "CREATE INDEX IF NOT EXISTS idx_history_tier_ts ON state_history(tier, ts);",
+
+    // 2: List-view indexes. Each walks rows in (friendly_name, entity_id)
+    // order for its tab so keyset pages stop after LIMIT rows; domain is
+    // carried in the index so the MVP-domain filter and COUNT(*) never
+    // touch the table. Single-column indexes are prefixes of these.
+    "DROP INDEX IF EXISTS idx_entities_domain;"
+    "DROP INDEX IF EXISTS idx_entities_area;"
+    "DROP INDEX IF EXISTS idx_entities_name;"
+    "DROP INDEX IF EXISTS idx_entities_domain_name;"
+    "DROP INDEX IF EXISTS idx_entities_area_name;"
+    "CREATE INDEX idx_entities_name ON entities(friendly_name, entity_id, domain);"
+    "CREATE INDEX idx_entities_domain_name ON entities(domain, friendly_name, entity_id);"
+    "CREATE INDEX idx_entities_area_name "
+    "    ON entities(area_id, friendly_name, entity_id, domain);"
+    "CREATE INDEX idx_favorites_added ON favorites(added_at, entity_id);"
+};
 
 /* ============================================
  * Database Lifecycle
@@ -61,11 +110,208 @@ database_t* database_open(const char *path) {
     // Enable foreign keys
     sqlite3_exec(db->db, "PRAGMA foreign_keys = ON;", NULL, NULL, NULL);
 
+    // WAL lets the UI connection read while the writer thread commits;
+    // NORMAL sync is still crash-safe in WAL mode and avoids an fsync per commit
+    sqlite3_exec(db->db, "PRAGMA journal_mode = WAL;", NULL, NULL, NULL);
+    sqlite3_exec(db->db, "PRAGMA synchronous = NORMAL;", NULL, NULL, NULL);
+    sqlite3_busy_timeout(db->db, 2000);
+
     return db;
 }
 
+/**
+ * Helper: Copy every page of src into dest (SQLite online backup API)
+ */
+static int copy_database(sqlite3 *dest, sqlite3 *src) {
+    sqlite3_backup *backup = sqlite3_backup_init(dest, "main", src, "main");
+    if (!backup) {
+        fprintf(stderr, "Backup init failed: %s\n", sqlite3_errmsg(dest));
+        return 0;
+    }
+
+    int rc = sqlite3_backup_step(backup, -1);
+    sqlite3_backup_finish(backup);
+
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Backup failed: %s\n", sqlite3_errstr(rc));
+        return 0;
+    }
+    return 1;
+}
+
+database_t* database_open_in_memory(const char *path) {
+    if (!path) {
+        return NULL;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    database_t *db = calloc(1, sizeof(database_t));
+    if (!db) {
+        return NULL;
+    }
+
+    strncpy(db->db_path, path, sizeof(db->db_path) - 1);
+    db->in_memory = 1;
+
+    // Serialized mode: the UI thread reads and the writer thread writes
+    // through this one connection (see db_writer_attach)
+    if (sqlite3_open_v2(":memory:", &db->db,
+                        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
+                        NULL) != SQLITE_OK) {
+        fprintf(stderr, "Cannot open in-memory database: %s\n", sqlite3_errmsg(db->db));
+        sqlite3_close(db->db);
+        free(db);
+        return NULL;
+    }
+
+    // Load the existing cache, if any (a missing or unreadable file starts empty)
+    sqlite3 *disk = NULL;
+    if (access(path, F_OK) == 0 &&
+        sqlite3_open_v2(path, &disk, SQLITE_OPEN_READWRITE, NULL) == SQLITE_OK) {
+        // Fold a WAL left by file mode into the file; snapshots replace the
+        // main file only, so no -wal may outlive this point
+        sqlite3_exec(disk, "PRAGMA journal_mode = DELETE;", NULL, NULL, NULL);
+
+        if (!copy_database(db->db, disk)) {
+            fprintf(stderr, "Could not load %s, starting with an empty cache\n", path);
+        }
+    }
+    sqlite3_close(disk);
+
+    sqlite3_exec(db->db, "PRAGMA foreign_keys = ON;", NULL, NULL, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Loaded %s into memory in %.1f ms\n", path,
+           (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0);
+
+    return db;
+}
+
+/**
+ * Helper: fsync a file or directory by path
+ */
+static int sync_path(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    int ok = (fsync(fd) == 0);
+    close(fd);
+    return ok;
+}
+
+/**
+ * Snapshot thread: write the copy to <path>.tmp, then rename it over
+ * <path>. Readers of the file see either the old or the new snapshot.
+ */
+static void* snapshot_thread(void *arg) {
+    struct db_snapshot *snap = arg;
+    char tmp_path[272];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", snap->path);
+
+    unlink(tmp_path);
+
+    sqlite3 *file = NULL;
+    int ok = (sqlite3_open(tmp_path, &file) == SQLITE_OK);
+    if (ok) {
+        // The temp file is disposable until renamed, so it needs no journal
+        sqlite3_exec(file, "PRAGMA journal_mode = OFF;", NULL, NULL, NULL);
+        ok = copy_database(file, snap->copy);
+    }
+    sqlite3_close(file);
+
+    ok = ok && sync_path(tmp_path) && rename(tmp_path, snap->path) == 0;
+    if (ok) {
+        // Persist the rename itself
+        char dir[256];
+        snprintf(dir, sizeof(dir), "%s", snap->path);
+        char *slash = strrchr(dir, '/');
+        if (slash) {
+            *slash = '\0';
+        } else {
+            strcpy(dir, ".");
+        }
+        sync_path(dir[0] ? dir : "/");
+    } else {
+        fprintf(stderr, "Database snapshot to %s failed\n", snap->path);
+        unlink(tmp_path);
+    }
+
+    snap->result = ok;
+    __atomic_store_n(&snap->done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**
+ * Helper: Join the running snapshot and record its outcome
+ */
+static int finish_snapshot(database_t *db) {
+    struct db_snapshot *snap = db->snapshot;
+    pthread_join(snap->thread, NULL);
+
+    int result = snap->result;
+    if (result) {
+        db->snapshot_changes = snap->changes;
+    }
+
+    sqlite3_close(snap->copy);
+    free(snap);
+    db->snapshot = NULL;
+    return result;
+}
+
+int database_snapshot(database_t *db, int wait) {
+    if (!db || !db->db || !db->in_memory) {
+        return 1;
+    }
+
+    if (db->snapshot) {
+        if (!wait && !__atomic_load_n(&db->snapshot->done, __ATOMIC_ACQUIRE)) {
+            return 0;
+        }
+        finish_snapshot(db);
+    }
+
+    int changes = sqlite3_total_changes(db->db);
+    if (changes == db->snapshot_changes) {
+        return 1;
+    }
+
+    struct db_snapshot *snap = calloc(1, sizeof(struct db_snapshot));
+    if (!snap) {
+        return 0;
+    }
+
+    snprintf(snap->path, sizeof(snap->path), "%s", db->db_path);
+    snap->changes = changes;
+
+    // RAM-to-RAM copy: the only part that runs on the caller's thread
+    // (the writer thread while a db_writer is attached)
+    if (sqlite3_open(":memory:", &snap->copy) != SQLITE_OK ||
+        !copy_database(snap->copy, db->db)) {
+        sqlite3_close(snap->copy);
+        free(snap);
+        return 0;
+    }
+
+    if (pthread_create(&snap->thread, NULL, snapshot_thread, snap) != 0) {
+        fprintf(stderr, "Failed to start snapshot thread\n");
+        sqlite3_close(snap->copy);
+        free(snap);
+        return 0;
+    }
+
+    db->snapshot = snap;
+    return wait ? finish_snapshot(db) : 1;
+}
+
 void database_close(database_t *db) {
     if (db) {
+        if (db->in_memory) {
+            database_snapshot(db, 1);
+        }
         if (db->db) {
             sqlite3_close(db->db);
         }
@@ -87,9 +333,57 @@ int database_init_schema(database_t *db) {
         return 0;
     }
 
+    // Upgrade existing caches in place
+    int version = database_get_schema_version(db);
+    if (version >= DATABASE_SCHEMA_VERSION) {
+        return 1;
+    }
+
+    for (int v = version; v < DATABASE_SCHEMA_VERSION; v++) {
+        char pragma[64];
+        snprintf(pragma, sizeof(pragma), "PRAGMA user_version = %d;", v + 1);
+
+        sqlite3_exec(db->db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+        rc = sqlite3_exec(db->db, MIGRATIONS[v], NULL, NULL, &err_msg);
+        if (rc == SQLITE_OK) {
+            rc = sqlite3_exec(db->db, pragma, NULL, NULL, &err_msg);
+        }
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "Schema migration %d failed: %s\n", v + 1, err_msg);
+            sqlite3_free(err_msg);
+            sqlite3_exec(db->db, "ROLLBACK;", NULL, NULL, NULL);
+            return 0;
+        }
+        sqlite3_exec(db->db, "COMMIT;", NULL, NULL, NULL);
+    }
+
+    printf("Database schema upgraded from version %d to %d\n", version, DATABASE_SCHEMA_VERSION);
+
+    // Schema changes don't count as row changes; make sure they get snapshotted
+    db->snapshot_changes = -1;
+
     return 1;
 }
 
+int database_get_schema_version(database_t *db) {
+    if (!db || !db->db) {
+        return 0;
+    }
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db->db, "PRAGMA user_version;", -1, &stmt, NULL) != SQLITE_OK) {
+        return 0;
+    }
+
+    int version = 0;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        version = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    return version;
+}
+
 /* ============================================
  * Entity Operations
  * ============================================ */
@@ -150,14 +444,9 @@ int database_save_entities(database_t *db, ha_entity_t **entities, int count) {
 }
 
 /**
- * Helper: Create entity from SQLite row
+ * Helper: Copy SQLite row columns into an entity (attributes_json untouched)
  */
-static ha_entity_t* entity_from_row(sqlite3_stmt *stmt) {
-    ha_entity_t *entity = calloc(1, sizeof(ha_entity_t));
-    if (!entity) {
-        return NULL;
-    }
-
+static void entity_fill_from_row(ha_entity_t *entity, sqlite3_stmt *stmt) {
     const char *text;
 
     text = (const char *)sqlite3_column_text(stmt, 0);
@@ -178,9 +467,6 @@ static ha_entity_t* entity_from_row(sqlite3_stmt *stmt) {
     text = (const char *)sqlite3_column_text(stmt, 5);
     if (text) strncpy(entity->area_id, text, sizeof(entity->area_id) - 1);
 
-    text = (const char *)sqlite3_column_text(stmt, 6);
-    if (text) entity->attributes_json = strdup(text);
-
     entity->supported_features = sqlite3_column_int(stmt, 7);
 
     text = (const char *)sqlite3_column_text(stmt, 8);
@@ -188,124 +474,418 @@ static ha_entity_t* entity_from_row(sqlite3_stmt *stmt) {
 
     text = (const char *)sqlite3_column_text(stmt, 9);
     if (text) strncpy(entity->last_updated, text, sizeof(entity->last_updated) - 1);
+}
+
+/**
+ * Helper: Create entity from SQLite row
+ */
+static ha_entity_t* entity_from_row(sqlite3_stmt *stmt) {
+    ha_entity_t *entity = calloc(1, sizeof(ha_entity_t));
+    if (!entity) {
+        return NULL;
+    }
+
+    entity_fill_from_row(entity, stmt);
+
+    const char *text = (const char *)sqlite3_column_text(stmt, 6);
+    if (text) entity->attributes_json = strdup(text);
 
     return entity;
 }
 
-ha_entity_t** database_get_all_entities(database_t *db, int *count) {
+/**
+ * Growable row buffer used to collect a query result in a single pass.
+ * Rows and attribute strings grow separately; row_buffer_finish()
+ * packs both into one allocation.
+ */
+typedef struct {
+    ha_entity_t *rows;
+    size_t *attr_offsets;      // Offset into text, or NO_ATTRIBUTES
+    int count;
+    int capacity;
+    char *text;
+    size_t text_len;
+    size_t text_capacity;
+} row_buffer_t;
+
+#define NO_ATTRIBUTES ((size_t)-1)
+#define ROW_BUFFER_INITIAL 64
+
+static void row_buffer_free(row_buffer_t *buf) {
+    free(buf->rows);
+    free(buf->attr_offsets);
+    free(buf->text);
+    memset(buf, 0, sizeof(*buf));
+}
+
+static int row_buffer_append(row_buffer_t *buf, sqlite3_stmt *stmt) {
+    if (buf->count == buf->capacity) {
+        int new_capacity = buf->capacity ? buf->capacity * 2 : ROW_BUFFER_INITIAL;
+        ha_entity_t *rows = realloc(buf->rows, new_capacity * sizeof(ha_entity_t));
+        if (!rows) {
+            return 0;
+        }
+        buf->rows = rows;
+
+        size_t *offsets = realloc(buf->attr_offsets, new_capacity * sizeof(size_t));
+        if (!offsets) {
+            return 0;
+        }
+        buf->attr_offsets = offsets;
+        buf->capacity = new_capacity;
+    }
+
+    ha_entity_t *entity = &buf->rows[buf->count];
+    memset(entity, 0, sizeof(*entity));
+    entity_fill_from_row(entity, stmt);
+
+    buf->attr_offsets[buf->count] = NO_ATTRIBUTES;
+    const char *attrs = (const char *)sqlite3_column_text(stmt, 6);
+    if (attrs) {
+        size_t len = (size_t)sqlite3_column_bytes(stmt, 6) + 1;
+        if (buf->text_len + len > buf->text_capacity) {
+            size_t new_capacity = buf->text_capacity ? buf->text_capacity * 2 : 4096;
+            while (new_capacity < buf->text_len + len) {
+                new_capacity *= 2;
+            }
+            char *text = realloc(buf->text, new_capacity);
+            if (!text) {
+                return 0;
+            }
+            buf->text = text;
+            buf->text_capacity = new_capacity;
+        }
+        memcpy(buf->text + buf->text_len, attrs, len);
+        buf->attr_offsets[buf->count] = buf->text_len;
+        buf->text_len += len;
+    }
+
+    buf->count++;
+    return 1;
+}
+
+/**
+ * Pack collected rows and their attribute strings into one block.
+ * Consumes the buffer.
+ */
+static ha_entity_t* row_buffer_finish(row_buffer_t *buf, int *count) {
+    ha_entity_t *block = NULL;
+
+    if (buf->count > 0) {
+        size_t rows_size = (size_t)buf->count * sizeof(ha_entity_t);
+        block = malloc(rows_size + buf->text_len);
+        if (block) {
+            char *text = (char *)block + rows_size;
+            memcpy(block, buf->rows, rows_size);
+            if (buf->text_len > 0) {
+                memcpy(text, buf->text, buf->text_len);
+            }
+            for (int i = 0; i < buf->count; i++) {
+                block[i].attributes_json = (buf->attr_offsets[i] == NO_ATTRIBUTES) ?
+                    NULL : text + buf->attr_offsets[i];
+            }
+            *count = buf->count;
+        }
+    }
+
+    row_buffer_free(buf);
+    return block;
+}
+
+/**
+ * Helper: Run a prepared entity query and collect all rows in one pass
+ */
+static ha_entity_t* collect_entities(sqlite3_stmt *stmt, int *count) {
+    row_buffer_t buf = {0};
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        if (!row_buffer_append(&buf, stmt)) {
+            fprintf(stderr, "Out of memory collecting entity rows\n");
+            row_buffer_free(&buf);
+            return NULL;
+        }
+    }
+
+    return row_buffer_finish(&buf, count);
+}
+
+ha_entity_t* database_get_all_entities(database_t *db, int *count) {
     if (!db || !db->db || !count) {
         return NULL;
     }
 
     *count = 0;
 
-    // First, get count
-    const char *count_sql = "SELECT COUNT(*) FROM entities;";
+    const char *sql =
+        "SELECT entity_id, state, friendly_name, icon, domain, area_id, "
+        "attributes_json, supported_features, last_changed, last_updated "
+        "FROM entities ORDER BY friendly_name;";
+
     sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(db->db, count_sql, -1, &stmt, NULL);
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         return NULL;
     }
 
-    int total = 0;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        total = sqlite3_column_int(stmt, 0);
-    }
+    ha_entity_t *entities = collect_entities(stmt, count);
     sqlite3_finalize(stmt);
 
-    if (total == 0) {
-        return NULL;
-    }
+    return entities;
+}
 
-    // Allocate array
-    ha_entity_t **entities = calloc(total, sizeof(ha_entity_t *));
-    if (!entities) {
+ha_entity_t* database_get_entities_by_domain(database_t *db, const char *domain, int *count) {
+    if (!db || !db->db || !domain || !count) {
         return NULL;
     }
 
-    // Fetch entities
+    *count = 0;
+
     const char *sql =
         "SELECT entity_id, state, friendly_name, icon, domain, area_id, "
         "attributes_json, supported_features, last_changed, last_updated "
-        "FROM entities ORDER BY friendly_name;";
+        "FROM entities WHERE domain = ? ORDER BY friendly_name;";
 
-    rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    sqlite3_stmt *stmt;
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
-        free(entities);
         return NULL;
     }
 
-    int i = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW && i < total) {
-        entities[i] = entity_from_row(stmt);
-        if (entities[i]) {
-            i++;
-        }
-    }
+    sqlite3_bind_text(stmt, 1, domain, -1, SQLITE_STATIC);
+
+    ha_entity_t *entities = collect_entities(stmt, count);
     sqlite3_finalize(stmt);
 
-    *count = i;
     return entities;
 }
 
-ha_entity_t** database_get_entities_by_domain(database_t *db, const char *domain, int *count) {
-    if (!db || !db->db || !domain || !count) {
+void database_free_entities(ha_entity_t *entities) {
+    free(entities);
+}
+
+/* ============================================
+ * Paged Entity Queries
+ * ============================================ */
+
+#define ENTITY_COLUMNS \
+    "entity_id, state, friendly_name, icon, domain, area_id, " \
+    "attributes_json, supported_features, last_changed, last_updated"
+
+#define MAX_FILTER_DOMAINS 32
+
+/**
+ * Helper: Append the WHERE clause for a filter (always starts with " WHERE 1")
+ */
+static void append_filter_sql(char *sql, size_t size, const entity_filter_t *filter) {
+    size_t len = strlen(sql);
+    len += snprintf(sql + len, size - len, " WHERE 1");
+
+    if (!filter) return;
+
+    switch (filter->group) {
+        case ENTITY_GROUP_DOMAIN:
+            len += snprintf(sql + len, size - len, " AND domain = ?");
+            break;
+        case ENTITY_GROUP_AREA:
+            len += snprintf(sql + len, size - len, " AND area_id = ?");
+            break;
+        case ENTITY_GROUP_FAVORITES:
+            len += snprintf(sql + len, size - len,
+                            " AND entity_id IN (SELECT entity_id FROM favorites)");
+            break;
+        case ENTITY_GROUP_ALL:
+        default:
+            break;
+    }
+
+    int n = filter->domains ? filter->domain_count : 0;
+    if (n > MAX_FILTER_DOMAINS) n = MAX_FILTER_DOMAINS;
+    if (n > 0) {
+        // Unary + keeps the planner from seeking on this broad IN list and
+        // sorting; the tab's ordered index is walked and domain checked in it
+        len += snprintf(sql + len, size - len, " AND +domain IN (");
+        for (int i = 0; i < n; i++) {
+            len += snprintf(sql + len, size - len, i == 0 ? "?" : ",?");
+        }
+        snprintf(sql + len, size - len, ")");
+    }
+}
+
+/**
+ * Helper: Bind filter parameters in the order append_filter_sql() emits them
+ * Returns the next free parameter index.
+ */
+static int bind_filter(sqlite3_stmt *stmt, const entity_filter_t *filter, int index) {
+    if (!filter) return index;
+
+    if (filter->group == ENTITY_GROUP_DOMAIN || filter->group == ENTITY_GROUP_AREA) {
+        sqlite3_bind_text(stmt, index++, filter->value ? filter->value : "", -1, SQLITE_STATIC);
+    }
+
+    int n = filter->domains ? filter->domain_count : 0;
+    if (n > MAX_FILTER_DOMAINS) n = MAX_FILTER_DOMAINS;
+    for (int i = 0; i < n; i++) {
+        sqlite3_bind_text(stmt, index++, filter->domains[i], -1, SQLITE_STATIC);
+    }
+
+    return index;
+}
+
+void database_cursor_from_entity(entity_cursor_t *cursor, const ha_entity_t *entity) {
+    if (!cursor || !entity) return;
+
+    memset(cursor, 0, sizeof(*cursor));
+    snprintf(cursor->friendly_name, sizeof(cursor->friendly_name), "%s", entity->friendly_name);
+    snprintf(cursor->entity_id, sizeof(cursor->entity_id), "%s", entity->entity_id);
+}
+
+ha_entity_t* database_get_entity_page(database_t *db, const entity_filter_t *filter,
+                                      const entity_cursor_t *cursor,
+                                      page_direction_t direction,
+                                      int limit, int *count) {
+    if (!db || !db->db || !count) {
         return NULL;
     }
 
     *count = 0;
+    if (limit <= 0) {
+        return NULL;
+    }
+
+    char sql[1024] = "SELECT " ENTITY_COLUMNS " FROM entities";
+    append_filter_sql(sql, sizeof(sql), filter);
+
+    size_t len = strlen(sql);
+    if (cursor) {
+        const char *op = (direction == PAGE_BEFORE) ? "<" :
+                         (direction == PAGE_FROM) ? ">=" : ">";
+        len += snprintf(sql + len, sizeof(sql) - len,
+                        " AND (friendly_name, entity_id) %s (?, ?)", op);
+    }
+
+    // Walk backwards from the cursor, then flip the page below
+    if (direction == PAGE_BEFORE) {
+        snprintf(sql + len, sizeof(sql) - len,
+                 " ORDER BY friendly_name DESC, entity_id DESC LIMIT ?;");
+    } else {
+        snprintf(sql + len, sizeof(sql) - len,
+                 " ORDER BY friendly_name, entity_id LIMIT ?;");
+    }
 
-    // First, get count
-    const char *count_sql = "SELECT COUNT(*) FROM entities WHERE domain = ?;";
     sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(db->db, count_sql, -1, &stmt, NULL);
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
+        fprintf(stderr, "Page query error: %s\n", sqlite3_errmsg(db->db));
         return NULL;
     }
 
-    sqlite3_bind_text(stmt, 1, domain, -1, SQLITE_STATIC);
+    int index = bind_filter(stmt, filter, 1);
+    if (cursor) {
+        sqlite3_bind_text(stmt, index++, cursor->friendly_name, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, index++, cursor->entity_id, -1, SQLITE_STATIC);
+    }
+    sqlite3_bind_int(stmt, index, limit);
 
-    int total = 0;
+    ha_entity_t *entities = collect_entities(stmt, count);
+    sqlite3_finalize(stmt);
+
+    if (entities && direction == PAGE_BEFORE) {
+        for (int i = 0, j = *count - 1; i < j; i++, j--) {
+            ha_entity_t tmp = entities[i];
+            entities[i] = entities[j];
+            entities[j] = tmp;
+        }
+    }
+
+    return entities;
+}
+
+int database_count_entities(database_t *db, const entity_filter_t *filter) {
+    if (!db || !db->db) {
+        return 0;
+    }
+
+    char sql[1024] = "SELECT COUNT(*) FROM entities";
+    append_filter_sql(sql, sizeof(sql), filter);
+
+    sqlite3_stmt *stmt;
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        return 0;
+    }
+
+    bind_filter(stmt, filter, 1);
+
+    int count = 0;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
-        total = sqlite3_column_int(stmt, 0);
+        count = sqlite3_column_int(stmt, 0);
     }
     sqlite3_finalize(stmt);
 
-    if (total == 0) {
+    return count;
+}
+
+char** database_get_group_values(database_t *db, entity_group_t group,
+                                 const entity_filter_t *filter, int *count) {
+    if (!db || !db->db || !count) {
         return NULL;
     }
 
-    // Allocate array
-    ha_entity_t **entities = calloc(total, sizeof(ha_entity_t *));
-    if (!entities) {
+    *count = 0;
+
+    const char *column;
+    if (group == ENTITY_GROUP_DOMAIN) {
+        column = "domain";
+    } else if (group == ENTITY_GROUP_AREA) {
+        column = "area_id";
+    } else {
         return NULL;
     }
 
-    // Fetch entities
-    const char *sql =
-        "SELECT entity_id, state, friendly_name, icon, domain, area_id, "
-        "attributes_json, supported_features, last_changed, last_updated "
-        "FROM entities WHERE domain = ? ORDER BY friendly_name;";
+    // Only the domain restriction applies here
+    entity_filter_t restrict_only = {0};
+    if (filter) {
+        restrict_only.domains = filter->domains;
+        restrict_only.domain_count = filter->domain_count;
+    }
+
+    char sql[1024];
+    snprintf(sql, sizeof(sql), "SELECT DISTINCT IFNULL(%s, '') FROM entities", column);
+    append_filter_sql(sql, sizeof(sql), &restrict_only);
+    size_t len = strlen(sql);
+    snprintf(sql + len, sizeof(sql) - len, " ORDER BY 1;");
 
-    rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    sqlite3_stmt *stmt;
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
-        free(entities);
         return NULL;
     }
 
-    sqlite3_bind_text(stmt, 1, domain, -1, SQLITE_STATIC);
+    bind_filter(stmt, &restrict_only, 1);
 
-    int i = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW && i < total) {
-        entities[i] = entity_from_row(stmt);
-        if (entities[i]) {
-            i++;
+    char **values = NULL;
+    int capacity = 0;
+    int n = 0;
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char *text = (const char *)sqlite3_column_text(stmt, 0);
+        if (!text) continue;
+
+        if (n == capacity) {
+            int new_capacity = capacity ? capacity * 2 : 16;
+            char **grown = realloc(values, new_capacity * sizeof(char *));
+            if (!grown) break;
+            values = grown;
+            capacity = new_capacity;
         }
+
+        values[n] = strdup(text);
+        if (values[n]) n++;
     }
     sqlite3_finalize(stmt);
 
-    *count = i;
-    return entities;
+    *count = n;
+    return values;
 }
 
 ha_entity_t* database_get_entity(database_t *db, const char *entity_id) {
@@ -424,37 +1004,52 @@ int database_is_favorite(database_t *db, const char *entity_id) {
     return found;
 }
 
-ha_entity_t** database_get_favorites(database_t *db, int *count) {
+char** database_get_favorite_ids(database_t *db, int *count) {
     if (!db || !db->db || !count) {
         return NULL;
     }
 
     *count = 0;
 
-    // Get count
-    const char *count_sql = "SELECT COUNT(*) FROM favorites;";
+    const char *sql = "SELECT entity_id FROM favorites;";
     sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(db->db, count_sql, -1, &stmt, NULL);
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         return NULL;
     }
 
-    int total = 0;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        total = sqlite3_column_int(stmt, 0);
+    char **ids = NULL;
+    int capacity = 0;
+    int n = 0;
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char *text = (const char *)sqlite3_column_text(stmt, 0);
+        if (!text) continue;
+
+        if (n == capacity) {
+            int new_capacity = capacity ? capacity * 2 : 16;
+            char **grown = realloc(ids, new_capacity * sizeof(char *));
+            if (!grown) break;
+            ids = grown;
+            capacity = new_capacity;
+        }
+
+        ids[n] = strdup(text);
+        if (ids[n]) n++;
     }
     sqlite3_finalize(stmt);
 
-    if (total == 0) {
-        return NULL;
-    }
+    *count = n;
+    return ids;
+}
 
-    // Allocate array
-    ha_entity_t **entities = calloc(total, sizeof(ha_entity_t *));
-    if (!entities) {
+ha_entity_t* database_get_favorites(database_t *db, int *count) {
+    if (!db || !db->db || !count) {
         return NULL;
     }
 
+    *count = 0;
+
     // Fetch favorites with entity data
     const char *sql =
         "SELECT e.entity_id, e.state, e.friendly_name, e.icon, e.domain, e.area_id, "
@@ -462,23 +1057,217 @@ ha_entity_t** database_get_favorites(database_t *db, int *count) {
         "FROM entities e INNER JOIN favorites f ON e.entity_id = f.entity_id "
         "ORDER BY f.added_at;";
 
-    rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    sqlite3_stmt *stmt;
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
-        free(entities);
         return NULL;
     }
 
-    int i = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW && i < total) {
-        entities[i] = entity_from_row(stmt);
-        if (entities[i]) {
-            i++;
+    ha_entity_t *entities = collect_entities(stmt, count);
+    sqlite3_finalize(stmt);
+
+    return entities;
+}
+
+/* ============================================
+ * State History
+ * ============================================ */
+
+#define HISTORY_5MIN_BUCKET     300
+#define HISTORY_HOURLY_BUCKET   3600
+
+/**
+ * Helper: Parse a state string as a number ("unavailable" etc. fail)
+ */
+static int parse_numeric_state(const char *state, double *value) {
+    if (!state || !*state) return 0;
+
+    char *end = NULL;
+    double v = strtod(state, &end);
+    if (end == state || *end != '\0' || v != v) {
+        return 0;
+    }
+
+    *value = v;
+    return 1;
+}
+
+int database_append_history(database_t *db, ha_entity_t **entities, int count, time_t now) {
+    if (!db || !db->db || !entities || count <= 0) {
+        return 0;
+    }
+
+    const char *sql =
+        "INSERT OR REPLACE INTO state_history "
+        "(entity_id, ts, tier, value, min_value, max_value, samples) "
+        "VALUES (?, ?, 0, ?, ?, ?, 1);";
+
+    sqlite3_stmt *stmt;
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        return 0;
+    }
+
+    sqlite3_exec(db->db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+
+    int appended = 0;
+    for (int i = 0; i < count; i++) {
+        double value;
+        if (!entities[i] || !parse_numeric_state(entities[i]->state, &value)) {
+            continue;
+        }
+
+        sqlite3_bind_text(stmt, 1, entities[i]->entity_id, -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, 2, (sqlite3_int64)now);
+        sqlite3_bind_double(stmt, 3, value);
+        sqlite3_bind_double(stmt, 4, value);
+        sqlite3_bind_double(stmt, 5, value);
+
+        if (sqlite3_step(stmt) == SQLITE_DONE) {
+            appended++;
         }
+        sqlite3_reset(stmt);
     }
+
+    sqlite3_exec(db->db, "COMMIT;", NULL, NULL, NULL);
     sqlite3_finalize(stmt);
 
-    *count = i;
-    return entities;
+    return appended;
+}
+
+/**
+ * Helper: Delete the oldest raw samples of entities over HISTORY_RAW_MAX_ROWS
+ * Only entities over the cap are visited, so the usual case is one scan.
+ */
+static int cap_raw_history(database_t *db) {
+    const char *sql =
+        "DELETE FROM state_history WHERE tier = ?1 "
+        "AND entity_id IN (SELECT entity_id FROM state_history WHERE tier = ?1 "
+        "                  GROUP BY entity_id HAVING COUNT(*) > ?2) "
+        "AND ts < (SELECT s.ts FROM state_history s "
+        "          WHERE s.entity_id = state_history.entity_id AND s.tier = ?1 "
+        "          ORDER BY s.ts DESC LIMIT 1 OFFSET ?2 - 1);";
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        return 0;
+    }
+    sqlite3_bind_int(stmt, 1, HISTORY_TIER_RAW);
+    sqlite3_bind_int(stmt, 2, HISTORY_RAW_MAX_ROWS);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+
+    return (rc == SQLITE_DONE) ? 1 : 0;
+}
+
+/**
+ * Helper: Merge rows of one tier older than cutoff into buckets of the next
+ * The cutoff is aligned to the bucket width so buckets are never split.
+ */
+static int roll_up_history(database_t *db, int from_tier, int width, time_t cutoff) {
+    const char *insert_sql =
+        "INSERT OR REPLACE INTO state_history "
+        "(entity_id, ts, tier, value, min_value, max_value, samples) "
+        "SELECT entity_id, (ts / ?1) * ?1, ?2 + 1, "
+        "SUM(value * samples) / SUM(samples), MIN(min_value), MAX(max_value), SUM(samples) "
+        "FROM state_history WHERE tier = ?2 AND ts < ?3 "
+        "GROUP BY entity_id, ts / ?1;";
+    const char *delete_sql = "DELETE FROM state_history WHERE tier = ?1 AND ts < ?2;";
+
+    cutoff = (cutoff / width) * width;
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db->db, insert_sql, -1, &stmt, NULL) != SQLITE_OK) {
+        return 0;
+    }
+    sqlite3_bind_int(stmt, 1, width);
+    sqlite3_bind_int(stmt, 2, from_tier);
+    sqlite3_bind_int64(stmt, 3, (sqlite3_int64)cutoff);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        return 0;
+    }
+
+    if (sqlite3_prepare_v2(db->db, delete_sql, -1, &stmt, NULL) != SQLITE_OK) {
+        return 0;
+    }
+    sqlite3_bind_int(stmt, 1, from_tier);
+    sqlite3_bind_int64(stmt, 2, (sqlite3_int64)cutoff);
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+
+    return (rc == SQLITE_DONE) ? 1 : 0;
+}
+
+int database_compact_history(database_t *db, time_t now) {
+    if (!db || !db->db) {
+        return 0;
+    }
+
+    sqlite3_exec(db->db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+
+    int ok = roll_up_history(db, HISTORY_TIER_RAW, HISTORY_5MIN_BUCKET,
+                             now - HISTORY_RAW_SECONDS) &&
+             roll_up_history(db, HISTORY_TIER_5MIN, HISTORY_HOURLY_BUCKET,
+                             now - HISTORY_5MIN_SECONDS) &&
+             cap_raw_history(db);
+
+    if (ok) {
+        sqlite3_stmt *stmt;
+        const char *sql = "DELETE FROM state_history WHERE tier = ? AND ts < ?;";
+        if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+            sqlite3_bind_int(stmt, 1, HISTORY_TIER_HOURLY);
+            sqlite3_bind_int64(stmt, 2, (sqlite3_int64)(now - HISTORY_MAX_SECONDS));
+            ok = (sqlite3_step(stmt) == SQLITE_DONE);
+            sqlite3_finalize(stmt);
+        } else {
+            ok = 0;
+        }
+    }
+
+    sqlite3_exec(db->db, ok ? "COMMIT;" : "ROLLBACK;", NULL, NULL, NULL);
+    return ok;
+}
+
+int database_get_history(database_t *db, const char *entity_id, time_t from, time_t to,
+                         history_point_t *points, int max_points) {
+    if (!db || !db->db || !entity_id || !points || max_points <= 0 || to <= from) {
+        return 0;
+    }
+
+    // Group into at most max_points equal spans; tiers never overlap in time
+    sqlite3_int64 span = ((sqlite3_int64)(to - from) + max_points - 1) / max_points;
+    if (span < 1) span = 1;
+
+    const char *sql =
+        "SELECT MIN(ts), SUM(value * samples) / SUM(samples), MIN(min_value), MAX(max_value) "
+        "FROM state_history WHERE entity_id = ?1 AND ts >= ?2 AND ts < ?3 "
+        "GROUP BY (ts - ?2) / ?4 ORDER BY 1 LIMIT ?5;";
+
+    sqlite3_stmt *stmt;
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        return 0;
+    }
+
+    sqlite3_bind_text(stmt, 1, entity_id, -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 2, (sqlite3_int64)from);
+    sqlite3_bind_int64(stmt, 3, (sqlite3_int64)to);
+    sqlite3_bind_int64(stmt, 4, span);
+    sqlite3_bind_int(stmt, 5, max_points);
+
+    int n = 0;
+    while (n < max_points && sqlite3_step(stmt) == SQLITE_ROW) {
+        points[n].time = (time_t)sqlite3_column_int64(stmt, 0);
+        points[n].value = sqlite3_column_double(stmt, 1);
+        points[n].min_value = sqlite3_column_double(stmt, 2);
+        points[n].max_value = sqlite3_column_double(stmt, 3);
+        n++;
+    }
+    sqlite3_finalize(stmt);
+
+    return n;
 }
 
 /* ============================================
@@ -11,14 +11,27 @@
 #define DATABASE_H
 
 #include <sqlite3.h>
+#include <time.h>
 #include "utils/json_helpers.h"
 
+/**
+ * Current schema version (stored in PRAGMA user_version)
+ */
+#define DATABASE_SCHEMA_VERSION 2
+
+struct db_snapshot;
+
 /**
  * Database context structure
  */
 typedef struct {
     sqlite3 *db;
     char db_path[256];
+
+    // In-memory mode: db is a RAM copy of db_path, written back by snapshots
+    int in_memory;
+    int snapshot_changes;           // sqlite3_total_changes() at the last snapshot
+    struct db_snapshot *snapshot;   // Snapshot being written (NULL if none)
 } database_t;
 
 /**
@@ -29,8 +42,33 @@ typedef struct {
  */
 database_t* database_open(const char *path);
 
+/**
+ * Open database in memory, loading the on-disk copy at path
+ * All queries run in RAM; call database_snapshot() to write changes back.
+ * The file is only ever replaced whole, so a crash leaves the previous
+ * snapshot intact.
+ *
+ * @param path Path to SQLite database file (created on first snapshot)
+ * @return database_t pointer or NULL on failure
+ */
+database_t* database_open_in_memory(const char *path);
+
+/**
+ * Write an in-memory database back to its file
+ * Copies the database in RAM on the calling thread (a few milliseconds),
+ * then writes the copy to disk on a background thread. Does nothing if
+ * the database is file-backed or unchanged since the last snapshot.
+ *
+ * @param db Database connection
+ * @param wait 1 to block until the file is written, 0 to return immediately
+ * @return 1 if a snapshot was written, started or not needed;
+ *         0 on failure or if the previous snapshot is still running
+ */
+int database_snapshot(database_t *db, int wait);
+
 /**
  * Close database connection
+ * In-memory databases are snapshotted to disk first.
  *
  * @param db Database to close
  */
@@ -38,12 +76,21 @@ void database_close(database_t *db);
 
 /**
  * Initialize database schema (creates tables if not exist)
+ * Runs any pending migrations so caches from older versions upgrade in place.
  *
  * @param db Database connection
  * @return 1 on success, 0 on failure
  */
 int database_init_schema(database_t *db);
 
+/**
+ * Get schema version of the open database
+ *
+ * @param db Database connection
+ * @return PRAGMA user_version (0 for caches created before versioning)
+ */
+int database_get_schema_version(database_t *db);
+
 /* ============================================
  * Entity Operations
  * ============================================ */
@@ -70,11 +117,14 @@ int database_save_entities(database_t *db, ha_entity_t **entities, int count);
 /**
  * Get all entities from database
  *
+ * Rows are returned in a single contiguous block; each row's
+ * attributes_json points into the same allocation.
+ *
  * @param db Database connection
  * @param count Output: number of entities returned
- * @return Array of entities (caller must free with free_entities)
+ * @return Contiguous array of entities (caller must free with database_free_entities)
  */
-ha_entity_t** database_get_all_entities(database_t *db, int *count);
+ha_entity_t* database_get_all_entities(database_t *db, int *count);
 
 /**
  * Get entities filtered by domain
@@ -82,9 +132,113 @@ ha_entity_t** database_get_all_entities(database_t *db, int *count);
  * @param db Database connection
  * @param domain Domain filter (e.g., "light", "switch")
  * @param count Output: number of entities returned
- * @return Array of entities (caller must free with free_entities)
+ * @return Contiguous array of entities (caller must free with database_free_entities)
+ */
+ha_entity_t* database_get_entities_by_domain(database_t *db, const char *domain, int *count);
+
+/**
+ * Free an entity block returned by the list queries
+ *
+ * Do not call free_entity() on individual rows of the block.
+ *
+ * @param entities Block to free (can be NULL)
+ */
+void database_free_entities(ha_entity_t *entities);
+
+/* ============================================
+ * Paged Entity Queries
+ * ============================================ */
+
+/**
+ * Grouping used to select the rows of one list tab
  */
-ha_entity_t** database_get_entities_by_domain(database_t *db, const char *domain, int *count);
+typedef enum {
+    ENTITY_GROUP_ALL = 0,     // Every entity
+    ENTITY_GROUP_DOMAIN,      // entities.domain = value
+    ENTITY_GROUP_AREA,        // entities.area_id = value ("" for unassigned)
+    ENTITY_GROUP_FAVORITES    // Entities in the favorites table
+} entity_group_t;
+
+/**
+ * Row filter for paged queries
+ */
+typedef struct {
+    entity_group_t group;
+    const char *value;              // Domain or area_id (unused for ALL/FAVORITES)
+    const char *const *domains;     // Optional: only include these domains
+    int domain_count;
+} entity_filter_t;
+
+/**
+ * Keyset position within a filtered result.
+ * Rows are ordered by (friendly_name, entity_id); a cursor holds the
+ * sort key of one row so the next page can start right beside it.
+ */
+typedef struct {
+    char friendly_name[128];
+    char entity_id[128];
+} entity_cursor_t;
+
+/**
+ * Page direction relative to a cursor
+ */
+typedef enum {
+    PAGE_AFTER = 0,     // Rows strictly after the cursor (NULL cursor: first page)
+    PAGE_FROM,          // Rows at or after the cursor (NULL cursor: first page)
+    PAGE_BEFORE         // Rows strictly before the cursor (NULL cursor: last page)
+} page_direction_t;
+
+/**
+ * Set a cursor to the sort key of an entity
+ *
+ * @param cursor Cursor to fill
+ * @param entity Row the cursor should point at
+ */
+void database_cursor_from_entity(entity_cursor_t *cursor, const ha_entity_t *entity);
+
+/**
+ * Get one page of entities using keyset pagination
+ *
+ * Rows are always returned in ascending (friendly_name, entity_id)
+ * order, including for PAGE_BEFORE. Cost depends on the page size,
+ * not on how far into the result the cursor is.
+ *
+ * @param db Database connection
+ * @param filter Row filter
+ * @param cursor Keyset position (NULL to start at either end)
+ * @param direction Which side of the cursor to read
+ * @param limit Maximum rows to return
+ * @param count Output: number of entities returned
+ * @return Contiguous array of entities (caller must free with database_free_entities)
+ */
+ha_entity_t* database_get_entity_page(database_t *db, const entity_filter_t *filter,
+                                      const entity_cursor_t *cursor,
+                                      page_direction_t direction,
+                                      int limit, int *count);
+
+/**
+ * Count entities matching a filter
+ *
+ * @param db Database connection
+ * @param filter Row filter
+ * @return Number of matching entities
+ */
+int database_count_entities(database_t *db, const entity_filter_t *filter);
+
+/**
+ * Get the distinct domain or area_id values present among matching entities
+ *
+ * The filter's group and value are ignored; only its domain restriction
+ * applies. Values are sorted.
+ *
+ * @param db Database connection
+ * @param group ENTITY_GROUP_DOMAIN or ENTITY_GROUP_AREA
+ * @param filter Domain restriction (can be NULL)
+ * @param count Output: number of values returned
+ * @return Array of strings (caller must free each string and the array)
+ */
+char** database_get_group_values(database_t *db, entity_group_t group,
+                                 const entity_filter_t *filter, int *count);
 
 /**
  * Get single entity by ID
@@ -153,14 +307,86 @@ int database_remove_favorite(database_t *db, const char *entity_id);
  */
 int database_is_favorite(database_t *db, const char *entity_id);
 
+/**
+ * Get entity IDs of all favorites (without entity data)
+ *
+ * @param db Database connection
+ * @param count Output: number of IDs returned
+ * @return Array of strings (caller must free each string and the array)
+ */
+char** database_get_favorite_ids(database_t *db, int *count);
+
 /**
  * Get all favorited entities
  *
  * @param db Database connection
  * @param count Output: number of favorites returned
- * @return Array of entities (caller must free with free_entities)
+ * @return Contiguous array of entities (caller must free with database_free_entities)
+ */
+ha_entity_t* database_get_favorites(database_t *db, int *count);
+
+/* ============================================
+ * State History
+ * ============================================ */
+
+/**
+ * History retention tiers. Samples are appended raw; compaction rolls
+ * older raw samples into 5-minute buckets and older buckets into hourly
+ * ones. Raw samples are also capped per entity, so an entity that changes
+ * on every sync still keeps a bounded number of rows.
+ */
+#define HISTORY_TIER_RAW        0
+#define HISTORY_TIER_5MIN       1
+#define HISTORY_TIER_HOURLY     2
+
+#define HISTORY_RAW_SECONDS     3600            // Raw samples kept 1 hour
+#define HISTORY_5MIN_SECONDS    86400           // 5-minute buckets kept 24 hours
+#define HISTORY_MAX_SECONDS     (7 * 86400)     // Hourly buckets kept 7 days
+#define HISTORY_RAW_MAX_ROWS    360             // Newest raw samples kept per entity
+
+/**
+ * One point of a history range query
+ */
+typedef struct {
+    time_t time;          // Start of the point's time span
+    double value;         // Sample-weighted average
+    double min_value;
+    double max_value;
+} history_point_t;
+
+/**
+ * Append numeric states to the history (non-numeric states are skipped)
+ *
+ * @param db Database connection
+ * @param entities Array of entities
+ * @param count Number of entities
+ * @param now Sample timestamp
+ * @return Number of samples appended
+ */
+int database_append_history(database_t *db, ha_entity_t **entities, int count, time_t now);
+
+/**
+ * Downsample and expire history according to the retention tiers
+ *
+ * @param db Database connection
+ * @param now Current time
+ * @return 1 on success, 0 on failure
+ */
+int database_compact_history(database_t *db, time_t now);
+
+/**
+ * Get history for one entity, downsampled to at most max_points
+ *
+ * @param db Database connection
+ * @param entity_id Entity ID
+ * @param from Range start (inclusive)
+ * @param to Range end (exclusive)
+ * @param points Output buffer
+ * @param max_points Capacity of points
+ * @return Number of points written (oldest first)
  */
-ha_entity_t** database_get_favorites(database_t *db, int *count);
+int database_get_history(database_t *db, const char *entity_id, time_t from, time_t to,
+                         history_point_t *points, int max_points);
 
 /* ============================================
  * Metadata Operations
@@ -0,0 +1,406 @@
+/**
+ * db_writer.c - Background Database Writer Implementation
+ *
+ * The queue is a bounded ring in the style of Vyukov's MPMC queue,
+ * used here with a single consumer. A producer claims a ticket with a
+ * CAS on enqueue_pos, fills the slot and publishes it by storing
+ * ticket + 1 into the slot sequence. The writer only takes the slot for
+ * dequeue_pos, so jobs run strictly in ticket order and "committed"
+ * advances monotonically.
+ */
+
+#include "db_writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <time.h>
+
+#define QUEUE_MASK (DB_WRITER_QUEUE_SIZE - 1)
+
+typedef enum {
+    DB_JOB_SAVE_ENTITIES,
+    DB_JOB_SAVE_ENTITY,
+    DB_JOB_ADD_FAVORITE,
+    DB_JOB_REMOVE_FAVORITE,
+    DB_JOB_SET_METADATA,
+    DB_JOB_SNAPSHOT,
+    DB_JOB_FLUSH,
+    DB_JOB_STOP
+} db_job_type_t;
+
+typedef struct db_job {
+    db_job_type_t type;
+    ha_entity_t **entities;    // SAVE_ENTITIES / SAVE_ENTITY (owned)
+    int count;
+    time_t timestamp;
+    char key[128];             // Favorite entity_id or metadata key
+    char *value;               // Metadata value (owned)
+    sem_t *done;               // FLUSH: posted when reached
+} db_job_t;
+
+/* ============================================
+ * Queue
+ * ============================================ */
+
+/**
+ * Claim a ticket and publish a job. Returns the job sequence (ticket + 1).
+ */
+static unsigned long queue_push(db_writer_t *writer, db_job_t *job) {
+    unsigned long pos = __atomic_load_n(&writer->enqueue_pos, __ATOMIC_RELAXED);
+
+    for (;;) {
+        db_writer_slot_t *slot = &writer->slots[pos & QUEUE_MASK];
+        unsigned long seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        long diff = (long)(seq - pos);
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&writer->enqueue_pos, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                slot->job = job;
+                __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+                sem_post(&writer->wakeup);
+                return pos + 1;
+            }
+            // CAS failure reloaded pos
+        } else if (diff < 0) {
+            // Ring full: let the writer catch up
+            sched_yield();
+            pos = __atomic_load_n(&writer->enqueue_pos, __ATOMIC_RELAXED);
+        } else {
+            pos = __atomic_load_n(&writer->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * Take the next job in ticket order (writer thread only). NULL if not published yet.
+ */
+static db_job_t* queue_pop(db_writer_t *writer) {
+    unsigned long pos = writer->dequeue_pos;
+    db_writer_slot_t *slot = &writer->slots[pos & QUEUE_MASK];
+    unsigned long seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+
+    if (seq != pos + 1) {
+        return NULL;
+    }
+
+    db_job_t *job = slot->job;
+    slot->job = NULL;
+    __atomic_store_n(&slot->sequence, pos + DB_WRITER_QUEUE_SIZE, __ATOMIC_RELEASE);
+    writer->dequeue_pos = pos + 1;
+    return job;
+}
+
+/* ============================================
+ * Jobs
+ * ============================================ */
+
+static void free_job(db_job_t *job) {
+    if (job->entities) {
+        free_entities(job->entities, job->count);
+    }
+    free(job->value);
+    free(job);
+}
+
+/**
+ * Publish the duration of the running save job (writer thread only)
+ */
+static void record_save_time(db_writer_t *writer, const struct timespec *start,
+                             const struct timespec *end) {
+    uint64_t us = (uint64_t)((end->tv_sec - start->tv_sec) * 1000000L +
+                             (end->tv_nsec - start->tv_nsec) / 1000L);
+    // dequeue_pos has already moved past the running job: it is its sequence
+    unsigned long sequence = writer->dequeue_pos;
+    uint64_t entry = ((uint64_t)(uint32_t)sequence << 32) | (us & 0xffffffffu);
+
+    __atomic_store_n(&writer->save_times[sequence % DB_WRITER_SAVE_TIMES], entry,
+                     __ATOMIC_RELAXED);
+}
+
+static void run_job(db_writer_t *writer, db_job_t *job) {
+    database_t *db = writer->db;
+
+    switch (job->type) {
+        case DB_JOB_SAVE_ENTITIES: {
+            struct timespec start, end;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            int saved = database_save_entities(db, job->entities, job->count);
+            database_append_history(db, job->entities, job->count, job->timestamp);
+            database_compact_history(db, job->timestamp);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            record_save_time(writer, &start, &end);
+            printf("Saved %d entities to cache\n", saved);
+            break;
+        }
+        case DB_JOB_SAVE_ENTITY:
+            database_save_entity(db, job->entities[0]);
+            if (job->timestamp) {
+                database_append_history(db, job->entities, 1, job->timestamp);
+            }
+            break;
+        case DB_JOB_ADD_FAVORITE:
+            database_add_favorite(db, job->key);
+            break;
+        case DB_JOB_REMOVE_FAVORITE:
+            database_remove_favorite(db, job->key);
+            break;
+        case DB_JOB_SET_METADATA:
+            database_set_metadata(db, job->key, job->value);
+            break;
+        case DB_JOB_SNAPSHOT:
+            database_snapshot(db, 0);
+            break;
+        case DB_JOB_FLUSH:
+        case DB_JOB_STOP:
+            break;
+    }
+}
+
+static void* writer_thread(void *arg) {
+    db_writer_t *writer = arg;
+    int stop = 0;
+
+    while (!stop) {
+        sem_wait(&writer->wakeup);
+
+        db_job_t *job;
+        while ((job = queue_pop(writer)) != NULL) {
+            run_job(writer, job);
+            __atomic_store_n(&writer->committed, writer->dequeue_pos, __ATOMIC_RELEASE);
+
+            if (job->type == DB_JOB_STOP) {
+                stop = 1;
+            }
+            if (job->done) {
+                sem_post(job->done);   // Waiter owns the job
+            } else {
+                free_job(job);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static db_job_t* new_job(db_job_type_t type) {
+    db_job_t *job = calloc(1, sizeof(db_job_t));
+    if (job) {
+        job->type = type;
+    }
+    return job;
+}
+
+/* ============================================
+ * Public API
+ * ============================================ */
+
+/**
+ * Helper: Set up the ring and start the thread on writer->db
+ */
+static db_writer_t* start_writer(db_writer_t *writer) {
+    for (unsigned long i = 0; i < DB_WRITER_QUEUE_SIZE; i++) {
+        writer->slots[i].sequence = i;
+    }
+
+    if (sem_init(&writer->wakeup, 0, 0) != 0) {
+        if (writer->owns_db) {
+            database_close(writer->db);
+        }
+        free(writer);
+        return NULL;
+    }
+
+    if (pthread_create(&writer->thread, NULL, writer_thread, writer) != 0) {
+        fprintf(stderr, "Failed to start database writer thread\n");
+        sem_destroy(&writer->wakeup);
+        if (writer->owns_db) {
+            database_close(writer->db);
+        }
+        free(writer);
+        return NULL;
+    }
+
+    writer->running = 1;
+    return writer;
+}
+
+db_writer_t* db_writer_start(const char *db_path) {
+    if (!db_path) {
+        return NULL;
+    }
+
+    db_writer_t *writer = calloc(1, sizeof(db_writer_t));
+    if (!writer) {
+        return NULL;
+    }
+
+    writer->db = database_open(db_path);
+    if (!writer->db) {
+        free(writer);
+        return NULL;
+    }
+    writer->owns_db = 1;
+
+    return start_writer(writer);
+}
+
+db_writer_t* db_writer_attach(database_t *db) {
+    if (!db) {
+        return NULL;
+    }
+
+    db_writer_t *writer = calloc(1, sizeof(db_writer_t));
+    if (!writer) {
+        return NULL;
+    }
+
+    writer->db = db;
+    return start_writer(writer);
+}
+
+void db_writer_flush(db_writer_t *writer) {
+    if (!writer || !writer->running) {
+        return;
+    }
+
+    db_job_t *job = new_job(DB_JOB_FLUSH);
+    sem_t done;
+    if (!job || sem_init(&done, 0, 0) != 0) {
+        free(job);
+        return;
+    }
+
+    job->done = &done;
+    queue_push(writer, job);
+
+    sem_wait(&done);
+    sem_destroy(&done);
+    free_job(job);
+}
+
+void db_writer_stop(db_writer_t *writer) {
+    if (!writer) {
+        return;
+    }
+
+    if (writer->running) {
+        db_job_t *job = new_job(DB_JOB_STOP);
+        if (job) {
+            queue_push(writer, job);
+            pthread_join(writer->thread, NULL);
+        } else {
+            fprintf(stderr, "Database writer: out of memory on stop, detaching\n");
+            pthread_detach(writer->thread);
+        }
+        writer->running = 0;
+    }
+
+    sem_destroy(&writer->wakeup);
+    if (writer->owns_db) {
+        database_close(writer->db);
+    }
+    free(writer);
+}
+
+unsigned long db_writer_committed(db_writer_t *writer) {
+    return writer ? __atomic_load_n(&writer->committed, __ATOMIC_ACQUIRE) : 0;
+}
+
+int db_writer_save_time(db_writer_t *writer, unsigned long sequence, double *ms) {
+    if (!writer || !sequence || !ms) {
+        return -1;
+    }
+
+    if (db_writer_committed(writer) < sequence) {
+        return 0;
+    }
+
+    uint64_t entry = __atomic_load_n(&writer->save_times[sequence % DB_WRITER_SAVE_TIMES],
+                                     __ATOMIC_RELAXED);
+    if ((uint32_t)(entry >> 32) != (uint32_t)sequence) {
+        return -1;   // Not a save, or a later save took the slot
+    }
+
+    *ms = (uint32_t)entry / 1000.0;
+    return 1;
+}
+
+unsigned long db_writer_save_entities(db_writer_t *writer, ha_entity_t **entities,
+                                      int count, time_t now) {
+    db_job_t *job = writer ? new_job(DB_JOB_SAVE_ENTITIES) : NULL;
+    if (!job) {
+        free_entities(entities, count);
+        return 0;
+    }
+
+    job->entities = entities;
+    job->count = count;
+    job->timestamp = now;
+    return queue_push(writer, job);
+}
+
+unsigned long db_writer_save_entity(db_writer_t *writer, const ha_entity_t *entity, time_t now) {
+    if (!writer || !entity) {
+        return 0;
+    }
+
+    db_job_t *job = new_job(DB_JOB_SAVE_ENTITY);
+    if (!job) {
+        return 0;
+    }
+
+    job->entities = malloc(sizeof(ha_entity_t *));
+    if (job->entities) {
+        job->entities[0] = copy_entity(entity);
+    }
+    if (!job->entities || !job->entities[0]) {
+        free(job->entities);
+        free(job);
+        return 0;
+    }
+
+    job->count = 1;
+    job->timestamp = now;
+    return queue_push(writer, job);
+}
+
+unsigned long db_writer_set_favorite(db_writer_t *writer, const char *entity_id, int favorite) {
+    if (!writer || !entity_id) {
+        return 0;
+    }
+
+    db_job_t *job = new_job(favorite ? DB_JOB_ADD_FAVORITE : DB_JOB_REMOVE_FAVORITE);
+    if (!job) {
+        return 0;
+    }
+
+    strncpy(job->key, entity_id, sizeof(job->key) - 1);
+    return queue_push(writer, job);
+}
+
+unsigned long db_writer_set_metadata(db_writer_t *writer, const char *key, const char *value) {
+    if (!writer || !key || !value) {
+        return 0;
+    }
+
+    db_job_t *job = new_job(DB_JOB_SET_METADATA);
+    if (!job) {
+        return 0;
+    }
+
+    job->value = strdup(value);
+    if (!job->value) {
+        free(job);
+        return 0;
+    }
+
+    strncpy(job->key, key, sizeof(job->key) - 1);
+    return queue_push(writer, job);
+}
+
+unsigned long db_writer_snapshot(db_writer_t *writer) {
+    db_job_t *job = writer ? new_job(DB_JOB_SNAPSHOT) : NULL;
+    return job ? queue_push(writer, job) : 0;
+}
@@ -0,0 +1,168 @@
+/**
+ * db_writer.h - Background Database Writer
+ *
+ * Runs all SQLite writes on a dedicated thread, so slow SD card commits
+ * never stall a frame. Callers enqueue jobs on a lock-free ring and get
+ * back a sequence number; a job is committed once db_writer_committed()
+ * reaches that number. Jobs run in sequence order.
+ *
+ * A file database gets a second connection and must use WAL journaling
+ * so the UI connection can keep reading while the writer commits (see
+ * database_open). An in-memory database has only one connection, which
+ * the writer shares (see database_open_in_memory); it also takes the
+ * snapshots, so their RAM copy never runs on the UI thread.
+ */
+
+#ifndef DB_WRITER_H
+#define DB_WRITER_H
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdint.h>
+#include <time.h>
+#include "database.h"
+
+/**
+ * Ring capacity (power of two). Enqueue waits if the writer falls this
+ * far behind; a whole sync is a single job.
+ */
+#define DB_WRITER_QUEUE_SIZE 256
+
+/**
+ * Number of recent entity saves whose durations are remembered
+ */
+#define DB_WRITER_SAVE_TIMES 8
+
+struct db_job;
+
+/**
+ * Ring slot (bounded MPSC queue; the slot ticket is the job sequence)
+ */
+typedef struct {
+    unsigned long sequence;
+    struct db_job *job;
+} db_writer_slot_t;
+
+/**
+ * Writer context
+ */
+typedef struct {
+    database_t *db;                 // Connection the jobs write through
+    int owns_db;                    // Opened by db_writer_start (closed on stop)
+    pthread_t thread;
+    sem_t wakeup;                   // Posted once per enqueued job
+    int running;
+
+    db_writer_slot_t slots[DB_WRITER_QUEUE_SIZE];
+    unsigned long enqueue_pos;      // Next ticket (producers, atomic)
+    unsigned long dequeue_pos;      // Next ticket to run (writer thread only)
+    unsigned long committed;        // Last finished sequence (atomic)
+
+    // Durations of recent entity saves, for sync diagnostics: job
+    // sequence in the high half, microseconds in the low half (atomic)
+    uint64_t save_times[DB_WRITER_SAVE_TIMES];
+} db_writer_t;
+
+/**
+ * Open a second connection to db_path and start the writer thread
+ *
+ * @param db_path Path of the database file
+ * @return db_writer_t pointer or NULL on failure
+ */
+db_writer_t* db_writer_start(const char *db_path);
+
+/**
+ * Start the writer thread on an existing connection (not closed on stop)
+ * Used for in-memory databases, whose data only one connection can see.
+ *
+ * @param db Open database; must stay open until db_writer_stop()
+ * @return db_writer_t pointer or NULL on failure
+ */
+db_writer_t* db_writer_attach(database_t *db);
+
+/**
+ * Flush outstanding jobs, stop the thread and close its own connection
+ *
+ * @param writer Writer to stop (can be NULL)
+ */
+void db_writer_stop(db_writer_t *writer);
+
+/**
+ * Block until every job enqueued so far has been committed
+ *
+ * @param writer Writer
+ */
+void db_writer_flush(db_writer_t *writer);
+
+/**
+ * Get the sequence number of the last committed job
+ *
+ * @param writer Writer
+ * @return Sequence number (0 if nothing has run yet)
+ */
+unsigned long db_writer_committed(db_writer_t *writer);
+
+/**
+ * Save entities, append their numeric states to history and compact it
+ * Takes ownership of the array and entities (freed by the writer).
+ *
+ * @param writer Writer
+ * @param entities Array of entities
+ * @param count Number of entities
+ * @param now Sample timestamp for history
+ * @return Job sequence number, 0 on failure (ownership still taken)
+ */
+unsigned long db_writer_save_entities(db_writer_t *writer, ha_entity_t **entities,
+                                      int count, time_t now);
+
+/**
+ * Get how long an entity save job took to write
+ * Only the last DB_WRITER_SAVE_TIMES saves are remembered.
+ *
+ * @param writer Writer
+ * @param sequence Sequence returned by db_writer_save_entities()
+ * @param ms Receives the write time in milliseconds
+ * @return 1 if known, 0 if the job has not finished, -1 if a later save replaced it
+ */
+int db_writer_save_time(db_writer_t *writer, unsigned long sequence, double *ms);
+
+/**
+ * Save one entity and append its state to history (entity is copied)
+ *
+ * @param writer Writer
+ * @param entity Entity to save
+ * @param now Sample timestamp for history (0 = no sample)
+ * @return Job sequence number, 0 on failure
+ */
+unsigned long db_writer_save_entity(db_writer_t *writer, const ha_entity_t *entity, time_t now);
+
+/**
+ * Add or remove a favorite
+ *
+ * @param writer Writer
+ * @param entity_id Entity ID
+ * @param favorite 1 to add, 0 to remove
+ * @return Job sequence number, 0 on failure
+ */
+unsigned long db_writer_set_favorite(db_writer_t *writer, const char *entity_id, int favorite);
+
+/**
+ * Set a metadata key-value pair
+ *
+ * @param writer Writer
+ * @param key Metadata key
+ * @param value Metadata value
+ * @return Job sequence number, 0 on failure
+ */
+unsigned long db_writer_set_metadata(db_writer_t *writer, const char *key, const char *value);
+
+/**
+ * Snapshot an in-memory database to its file (see database_snapshot)
+ * Skipped while the previous snapshot is still being written.
+ *
+ * @param writer Writer
+ * @return Job sequence number, 0 on failure
+ */
+unsigned long db_writer_snapshot(db_writer_t *writer);
+
+#endif // DB_WRITER_H
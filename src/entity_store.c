@@ -0,0 +1,627 @@
+/**
+ * entity_store.c - In-Memory Entity Table Implementation
+ *
+ * Rows are individually allocated so their addresses never change; only
+ * the sorted pointer array is rearranged. The index maps entity_id to a
+ * position in that array and is rebuilt whenever the layout changes,
+ * which only happens when entities appear, disappear, are renamed or
+ * move to another area.
+ *
+ * The group indexes are rebuilt at the same time. Bucket members are
+ * laid out in one array with a counting pass, so a rebuild is two linear
+ * scans plus a sort of the (few) bucket values.
+ */
+
+#include "entity_store.h"
+#include "utils/json_helpers.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Row order: (friendly_name, entity_id), byte-wise like SQLite's BINARY
+ */
+static int compare_rows(const void *a, const void *b) {
+    const ha_entity_t *x = *(ha_entity_t *const *)a;
+    const ha_entity_t *y = *(ha_entity_t *const *)b;
+
+    int cmp = strcmp(x->friendly_name, y->friendly_name);
+    return cmp != 0 ? cmp : strcmp(x->entity_id, y->entity_id);
+}
+
+static int compare_buckets(const void *a, const void *b) {
+    return strcmp(((const entity_bucket_t *)a)->value, ((const entity_bucket_t *)b)->value);
+}
+
+static const char* group_value(const ha_entity_t *row, int by_area) {
+    return by_area ? row->area_id : row->domain;
+}
+
+/* ============================================
+ * Group Indexes
+ * ============================================ */
+
+/**
+ * Group rows by domain or area into buckets sorted by value. Members
+ * keep row order and are written to slots (store->count entries).
+ */
+static entity_bucket_t* build_buckets(const entity_store_t *store, int by_area,
+                                      ha_entity_t **slots, int *bucket_count) {
+    *bucket_count = 0;
+
+    int *ids = malloc(store->count * sizeof(int));
+    if (!ids) {
+        return NULL;
+    }
+
+    str_map_t values;
+    if (!str_map_init(&values, 32)) {
+        free(ids);
+        return NULL;
+    }
+
+    // Pass 1: find each row's bucket and size the buckets
+    entity_bucket_t *buckets = NULL;
+    int capacity = 0;
+    int n = 0;
+    int ok = 1;
+
+    for (int i = 0; i < store->count && ok; i++) {
+        const char *value = group_value(store->rows[i], by_area);
+        int id;
+
+        if (!str_map_get(&values, value, &id)) {
+            if (n == capacity) {
+                int new_capacity = capacity ? capacity * 2 : 16;
+                entity_bucket_t *grown = realloc(buckets, new_capacity * sizeof(entity_bucket_t));
+                if (!grown) {
+                    ok = 0;
+                    break;
+                }
+                buckets = grown;
+                capacity = new_capacity;
+            }
+
+            id = n++;
+            buckets[id].value = value;
+            buckets[id].rows = NULL;
+            buckets[id].count = 0;
+            if (!str_map_put(&values, value, id)) {
+                ok = 0;
+            }
+        }
+
+        ids[i] = id;
+        buckets[id].count++;
+    }
+    str_map_free(&values);
+
+    if (!ok) {
+        free(buckets);
+        free(ids);
+        return NULL;
+    }
+
+    // Pass 2: lay the buckets out back to back and fill them in row order
+    int offset = 0;
+    for (int b = 0; b < n; b++) {
+        buckets[b].rows = slots + offset;
+        offset += buckets[b].count;
+        buckets[b].count = 0;
+    }
+    for (int i = 0; i < store->count; i++) {
+        entity_bucket_t *bucket = &buckets[ids[i]];
+        bucket->rows[bucket->count++] = store->rows[i];
+    }
+    free(ids);
+
+    qsort(buckets, n, sizeof(entity_bucket_t), compare_buckets);
+    *bucket_count = n;
+    return buckets;
+}
+
+static void free_groups(entity_store_t *store) {
+    free(store->domains);
+    free(store->areas);
+    free(store->grouped);
+    store->domains = NULL;
+    store->areas = NULL;
+    store->grouped = NULL;
+    store->domain_count = 0;
+    store->area_count = 0;
+}
+
+static int regroup(entity_store_t *store) {
+    free_groups(store);
+    if (store->count == 0) {
+        return 1;
+    }
+
+    store->grouped = malloc(2 * store->count * sizeof(ha_entity_t *));
+    if (!store->grouped) {
+        return 0;
+    }
+
+    store->domains = build_buckets(store, 0, store->grouped, &store->domain_count);
+    store->areas = build_buckets(store, 1, store->grouped + store->count, &store->area_count);
+    return store->domains && store->areas;
+}
+
+/**
+ * Rebuild the favorites list. Walks the set rather than the table:
+ * favorites are few.
+ */
+static int collect_favorites(entity_store_t *store) {
+    free(store->favorites);
+    store->favorites = NULL;
+    store->favorite_count = 0;
+
+    const str_map_t *set = store->favorite_set;
+    if (!set || set->count == 0) {
+        return 1;
+    }
+
+    store->favorites = malloc(set->count * sizeof(ha_entity_t *));
+    if (!store->favorites) {
+        return 0;
+    }
+
+    for (int i = 0; i < set->capacity; i++) {
+        int pos;
+        if (set->keys[i] && str_map_get(&store->index, set->keys[i], &pos)) {
+            store->favorites[store->favorite_count++] = store->rows[pos];
+        }
+    }
+
+    qsort(store->favorites, store->favorite_count, sizeof(ha_entity_t *), compare_rows);
+    return 1;
+}
+
+static const entity_bucket_t* find_bucket(const entity_bucket_t *buckets, int count,
+                                          const char *value) {
+    entity_bucket_t key = {value, NULL, 0};
+    return count > 0 ? bsearch(&key, buckets, count, sizeof(entity_bucket_t), compare_buckets)
+                     : NULL;
+}
+
+/**
+ * Re-sort rows and rebuild the position index and group indexes
+ */
+static int reindex(entity_store_t *store) {
+    qsort(store->rows, store->count, sizeof(ha_entity_t *), compare_rows);
+
+    str_map_clear(&store->index);
+    int ok = 1;
+    for (int i = 0; i < store->count; i++) {
+        if (!str_map_put(&store->index, store->rows[i]->entity_id, i)) {
+            ok = 0;
+        }
+    }
+
+    if (!regroup(store) || !collect_favorites(store)) {
+        ok = 0;
+    }
+
+    store->version++;
+    return ok;
+}
+
+static int same_string(const char *a, const char *b) {
+    if (!a || !b) {
+        return a == b;
+    }
+    return strcmp(a, b) == 0;
+}
+
+/**
+ * Check whether an update would change anything in a row
+ */
+static int row_differs(const ha_entity_t *row, const ha_entity_t *entity) {
+    return strcmp(row->state, entity->state) != 0 ||
+           strcmp(row->friendly_name, entity->friendly_name) != 0 ||
+           strcmp(row->icon, entity->icon) != 0 ||
+           strcmp(row->domain, entity->domain) != 0 ||
+           strcmp(row->area_id, entity->area_id) != 0 ||
+           strcmp(row->last_changed, entity->last_changed) != 0 ||
+           strcmp(row->last_updated, entity->last_updated) != 0 ||
+           row->supported_features != entity->supported_features ||
+           !same_string(row->attributes_json, entity->attributes_json);
+}
+
+/**
+ * Overwrite a row in place. Sets *moved if its sort key or a group changed.
+ */
+static int update_row(ha_entity_t *row, const ha_entity_t *entity, int *moved) {
+    char *attributes = NULL;
+    if (entity->attributes_json) {
+        attributes = strdup(entity->attributes_json);
+        if (!attributes) {
+            return 0;
+        }
+    }
+
+    *moved = strcmp(row->friendly_name, entity->friendly_name) != 0 ||
+             strcmp(row->area_id, entity->area_id) != 0 ||
+             strcmp(row->domain, entity->domain) != 0;
+
+    char *old_attributes = row->attributes_json;
+    *row = *entity;
+    row->attributes_json = attributes;
+    free(old_attributes);
+    return 1;
+}
+
+/**
+ * Append a copy of entity (unsorted) and index it at its new position
+ */
+static ha_entity_t* append_row(entity_store_t *store, const ha_entity_t *entity) {
+    if (store->count == store->capacity) {
+        int new_capacity = store->capacity ? store->capacity * 2 : 64;
+        ha_entity_t **grown = realloc(store->rows, new_capacity * sizeof(ha_entity_t *));
+        if (!grown) {
+            return NULL;
+        }
+        store->rows = grown;
+        store->capacity = new_capacity;
+    }
+
+    ha_entity_t *row = copy_entity(entity);
+    if (!row) {
+        return NULL;
+    }
+
+    if (!str_map_put(&store->index, row->entity_id, store->count)) {
+        free_entity(row);
+        return NULL;
+    }
+
+    store->rows[store->count++] = row;
+    return row;
+}
+
+static int is_restricted(const entity_filter_t *filter) {
+    return filter && filter->domains && filter->domain_count > 0;
+}
+
+/**
+ * Check a row against the filter's domain restriction (the group is
+ * already given by the index the row came from)
+ */
+static int domain_allowed(const ha_entity_t *row, const entity_filter_t *filter) {
+    if (!is_restricted(filter)) {
+        return 1;
+    }
+
+    for (int i = 0; i < filter->domain_count; i++) {
+        if (strcmp(row->domain, filter->domains[i]) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* ============================================
+ * Public API
+ * ============================================ */
+
+int entity_store_init(entity_store_t *store) {
+    if (!store) {
+        return 0;
+    }
+
+    memset(store, 0, sizeof(*store));
+    return str_map_init(&store->index, 0);
+}
+
+void entity_store_free(entity_store_t *store) {
+    if (!store) {
+        return;
+    }
+
+    for (int i = 0; i < store->count; i++) {
+        free_entity(store->rows[i]);
+    }
+    free(store->rows);
+    free_groups(store);
+    free(store->favorites);
+    str_map_free(&store->index);
+    memset(store, 0, sizeof(*store));
+}
+
+int entity_store_replace(entity_store_t *store, const ha_entity_t *const *entities, int count,
+                         entity_changes_t *changes) {
+    if (!store || (!entities && count > 0)) {
+        return 0;
+    }
+
+    int old_count = store->count;
+    unsigned char *seen = calloc(old_count > 0 ? old_count : 1, 1);
+    if (!seen) {
+        return 0;
+    }
+
+    int ok = 1;
+    int layout = 0;
+
+    for (int i = 0; i < count; i++) {
+        const ha_entity_t *entity = entities[i];
+        int pos;
+
+        if (str_map_get(&store->index, entity->entity_id, &pos)) {
+            int moved = 0;
+            if (pos < old_count) {
+                seen[pos] = 1;
+            }
+            if (!row_differs(store->rows[pos], entity)) {
+                continue;
+            }
+            if (!update_row(store->rows[pos], entity, &moved)) {
+                ok = 0;
+                continue;
+            }
+            layout |= moved;
+            entity_changes_add(changes, ENTITY_CHANGE_STATE, entity->entity_id);
+        } else if (append_row(store, entity)) {
+            layout = 1;
+            entity_changes_add(changes, ENTITY_CHANGE_ADDED, entity->entity_id);
+        } else {
+            ok = 0;
+        }
+    }
+
+    // Drop rows the new list no longer contains
+    int kept = 0;
+    for (int i = 0; i < store->count; i++) {
+        if (i < old_count && !seen[i]) {
+            entity_changes_add(changes, ENTITY_CHANGE_REMOVED, store->rows[i]->entity_id);
+            free_entity(store->rows[i]);
+            layout = 1;
+        } else {
+            store->rows[kept++] = store->rows[i];
+        }
+    }
+    store->count = kept;
+    free(seen);
+
+    if (layout) {
+        if (changes) {
+            changes->layout = 1;
+        }
+        if (!reindex(store)) {
+            ok = 0;
+        }
+    }
+
+    return ok;
+}
+
+const ha_entity_t* entity_store_put(entity_store_t *store, const ha_entity_t *entity,
+                                    entity_changes_t *changes) {
+    if (!store || !entity) {
+        return NULL;
+    }
+
+    int pos;
+    if (str_map_get(&store->index, entity->entity_id, &pos)) {
+        ha_entity_t *row = store->rows[pos];
+        if (!row_differs(row, entity)) {
+            return row;
+        }
+
+        int moved = 0;
+        if (!update_row(row, entity, &moved)) {
+            return NULL;
+        }
+        entity_changes_add(changes, ENTITY_CHANGE_STATE, row->entity_id);
+        if (moved) {
+            if (changes) {
+                changes->layout = 1;
+            }
+            if (!reindex(store)) {
+                return NULL;
+            }
+        }
+        return row;
+    }
+
+    ha_entity_t *row = append_row(store, entity);
+    if (!row || !reindex(store)) {
+        return NULL;
+    }
+    entity_changes_add(changes, ENTITY_CHANGE_ADDED, row->entity_id);
+    return row;
+}
+
+const ha_entity_t* entity_store_get(const entity_store_t *store, const char *entity_id) {
+    if (!store || !entity_id) {
+        return NULL;
+    }
+
+    int pos;
+    if (!str_map_get(&store->index, entity_id, &pos)) {
+        return NULL;
+    }
+    return store->rows[pos];
+}
+
+int entity_store_index_favorites(entity_store_t *store, const str_map_t *favorites) {
+    if (!store) {
+        return 0;
+    }
+
+    store->favorite_set = favorites;
+    return collect_favorites(store);
+}
+
+int entity_store_select(const entity_store_t *store, const entity_filter_t *filter,
+                        const ha_entity_t **rows, int max_rows) {
+    if (!store) {
+        return 0;
+    }
+
+    // Pick the rows of the filter's group
+    ha_entity_t *const *source = store->rows;
+    int count = store->count;
+    const entity_bucket_t *bucket = NULL;
+    const char *value = (filter && filter->value) ? filter->value : "";
+
+    switch (filter ? filter->group : ENTITY_GROUP_ALL) {
+        case ENTITY_GROUP_DOMAIN:
+            bucket = find_bucket(store->domains, store->domain_count, value);
+            source = bucket ? bucket->rows : NULL;
+            count = bucket ? bucket->count : 0;
+            break;
+        case ENTITY_GROUP_AREA:
+            bucket = find_bucket(store->areas, store->area_count, value);
+            source = bucket ? bucket->rows : NULL;
+            count = bucket ? bucket->count : 0;
+            break;
+        case ENTITY_GROUP_FAVORITES:
+            source = store->favorites;
+            count = store->favorite_count;
+            break;
+        case ENTITY_GROUP_ALL:
+        default:
+            break;
+    }
+
+    if (!is_restricted(filter)) {
+        int n = (count < max_rows) ? count : max_rows;
+        if (rows && n > 0) {
+            memcpy(rows, source, n * sizeof(ha_entity_t *));
+        }
+        return count;
+    }
+
+    int total = 0;
+    for (int i = 0; i < count; i++) {
+        if (domain_allowed(source[i], filter)) {
+            if (rows && total < max_rows) {
+                rows[total] = source[i];
+            }
+            total++;
+        }
+    }
+    return total;
+}
+
+char** entity_store_group_values(const entity_store_t *store, entity_group_t group,
+                                 const entity_filter_t *filter, int *count) {
+    if (!store || !count) {
+        return NULL;
+    }
+
+    *count = 0;
+    if (group != ENTITY_GROUP_DOMAIN && group != ENTITY_GROUP_AREA) {
+        return NULL;
+    }
+
+    const entity_bucket_t *buckets = (group == ENTITY_GROUP_DOMAIN) ? store->domains : store->areas;
+    int bucket_count = (group == ENTITY_GROUP_DOMAIN) ? store->domain_count : store->area_count;
+    if (bucket_count == 0) {
+        return NULL;
+    }
+
+    char **values = malloc(bucket_count * sizeof(char *));
+    if (!values) {
+        return NULL;
+    }
+
+    // Buckets are already sorted; keep those with a row the restriction allows
+    int n = 0;
+    for (int b = 0; b < bucket_count; b++) {
+        int allowed = !is_restricted(filter);
+        for (int i = 0; i < buckets[b].count && !allowed; i++) {
+            allowed = domain_allowed(buckets[b].rows[i], filter);
+        }
+        if (!allowed) continue;
+
+        values[n] = strdup(buckets[b].value);
+        if (!values[n]) break;
+        n++;
+    }
+
+    *count = n;
+    return values;
+}
+
+/* ============================================
+ * Change Sets
+ * ============================================ */
+
+void entity_changes_add(entity_changes_t *changes, entity_change_type_t type,
+                        const char *entity_id) {
+    if (!changes) {
+        return;
+    }
+
+    if (type == ENTITY_CHANGE_ADDED || type == ENTITY_CHANGE_REMOVED) {
+        changes->layout = 1;
+    }
+
+    if (changes->count == changes->capacity) {
+        int new_capacity = changes->capacity ? changes->capacity * 2 : 32;
+        entity_change_t *grown = realloc(changes->items, new_capacity * sizeof(entity_change_t));
+        if (!grown) {
+            changes->layout = 1;   // Lost detail: make subscribers re-read everything
+            return;
+        }
+        changes->items = grown;
+        changes->capacity = new_capacity;
+    }
+
+    char *id = strdup(entity_id);
+    if (!id) {
+        changes->layout = 1;
+        return;
+    }
+
+    changes->items[changes->count].type = type;
+    changes->items[changes->count].entity_id = id;
+    changes->count++;
+
+    if (type == ENTITY_CHANGE_ADDED) changes->added++;
+    else if (type == ENTITY_CHANGE_REMOVED) changes->removed++;
+    else if (type == ENTITY_CHANGE_REJECTED) changes->rejected++;
+    else changes->changed++;
+}
+
+void entity_changes_clear(entity_changes_t *changes) {
+    if (!changes) {
+        return;
+    }
+
+    for (int i = 0; i < changes->count; i++) {
+        free(changes->items[i].entity_id);
+    }
+    changes->count = 0;
+    changes->added = 0;
+    changes->removed = 0;
+    changes->changed = 0;
+    changes->rejected = 0;
+    changes->layout = 0;
+}
+
+void entity_changes_free(entity_changes_t *changes) {
+    if (!changes) {
+        return;
+    }
+
+    entity_changes_clear(changes);
+    free(changes->items);
+    memset(changes, 0, sizeof(*changes));
+}
+
+const entity_change_t* entity_changes_find(const entity_changes_t *changes,
+                                           const char *entity_id) {
+    if (!changes || !entity_id) {
+        return NULL;
+    }
+
+    for (int i = changes->count - 1; i >= 0; i--) {
+        if (strcmp(changes->items[i].entity_id, entity_id) == 0) {
+            return &changes->items[i];
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,213 @@
+/**
+ * entity_store.h - In-Memory Entity Table
+ *
+ * Holds every cached entity in RAM, sorted by (friendly_name, entity_id)
+ * and indexed by entity_id. It is the cache manager's read path; SQLite
+ * only persists it.
+ *
+ * Reads hand out borrowed pointers. A row is updated in place, so a
+ * borrowed pointer always shows the current state and stays valid until
+ * the entity is removed. The version changes whenever rows are added,
+ * removed, reordered or moved to another area; holders of selections
+ * re-select when it does.
+ *
+ * Rows are also grouped by domain, by area and into a favorites list.
+ * The groups are rebuilt with the layout, not on state updates, so a
+ * selection only touches the rows of its own group.
+ *
+ * Writes can record what they changed into an entity_changes_t, which
+ * the cache manager publishes to screens after each batch.
+ */
+
+#ifndef ENTITY_STORE_H
+#define ENTITY_STORE_H
+
+#include "database.h"
+#include "utils/str_map.h"
+
+/**
+ * Kind of change to one entity
+ */
+typedef enum {
+    ENTITY_CHANGE_ADDED,
+    ENTITY_CHANGE_REMOVED,
+    ENTITY_CHANGE_STATE,      // Row updated in place (state, name, attributes...)
+    ENTITY_CHANGE_REJECTED    // A requested change failed; the row shows the server's state again
+} entity_change_type_t;
+
+/**
+ * One changed entity
+ */
+typedef struct {
+    entity_change_type_t type;
+    char *entity_id;          // Owned
+} entity_change_t;
+
+/**
+ * Changes made by a batch of writes
+ */
+typedef struct {
+    entity_change_t *items;
+    int count;
+    int capacity;
+    int added;                // Per-type counts
+    int removed;
+    int changed;
+    int rejected;
+    int layout;               // Rows were added, removed, reordered or regrouped
+} entity_changes_t;
+
+/**
+ * Rows sharing one domain or area, in row order
+ */
+typedef struct {
+    const char *value;       // Domain or area_id (borrowed from a member row)
+    ha_entity_t **rows;      // Borrowed slice of the store's group storage
+    int count;
+} entity_bucket_t;
+
+/**
+ * Entity table
+ */
+typedef struct {
+    ha_entity_t **rows;      // Owned rows, sorted by (friendly_name, entity_id)
+    int count;
+    int capacity;
+    str_map_t index;         // entity_id -> position in rows
+    unsigned int version;    // Bumped when rows are added, removed, reordered or regrouped
+
+    // Group indexes, rebuilt with the layout
+    entity_bucket_t *domains;     // Sorted by value
+    int domain_count;
+    entity_bucket_t *areas;       // Sorted by value ("" = unassigned comes first)
+    int area_count;
+    ha_entity_t **grouped;        // Storage behind both bucket lists (2 * count)
+    ha_entity_t **favorites;      // Favorite rows, in row order
+    int favorite_count;
+    const str_map_t *favorite_set; // Borrowed, see entity_store_index_favorites()
+} entity_store_t;
+
+/**
+ * Initialize an empty store
+ *
+ * @param store Store to initialize
+ * @return 1 on success, 0 on allocation failure
+ */
+int entity_store_init(entity_store_t *store);
+
+/**
+ * Free all rows and the index
+ *
+ * @param store Store to free (struct itself is not freed)
+ */
+void entity_store_free(entity_store_t *store);
+
+/**
+ * Replace the contents with a full entity list (e.g. after a sync)
+ * Rows for entities already present are updated in place (unchanged rows
+ * are not touched); rows for entities not in the list are removed.
+ * Entities are copied.
+ *
+ * @param store Store
+ * @param entities Array of entity pointers
+ * @param count Number of entities
+ * @param changes Output: changes are appended here (can be NULL)
+ * @return 1 on success, 0 on allocation failure
+ */
+int entity_store_replace(entity_store_t *store, const ha_entity_t *const *entities, int count,
+                         entity_changes_t *changes);
+
+/**
+ * Insert or update one entity (copied)
+ *
+ * @param store Store
+ * @param entity Entity to store
+ * @param changes Output: the change is appended here (can be NULL)
+ * @return Stored row (borrowed) or NULL on allocation failure
+ */
+const ha_entity_t* entity_store_put(entity_store_t *store, const ha_entity_t *entity,
+                                    entity_changes_t *changes);
+
+/**
+ * Look up an entity by ID
+ *
+ * @param store Store
+ * @param entity_id Entity ID
+ * @return Borrowed row or NULL if not present
+ */
+const ha_entity_t* entity_store_get(const entity_store_t *store, const char *entity_id);
+
+/**
+ * Rebuild the favorites list from a set
+ * The set is kept (borrowed) so layout changes can rebuild the list too;
+ * call this again whenever the set changes.
+ *
+ * @param store Store
+ * @param favorites Favorites set (entity_id keys), NULL for none
+ * @return 1 on success, 0 on allocation failure
+ */
+int entity_store_index_favorites(entity_store_t *store, const str_map_t *favorites);
+
+/**
+ * Select rows matching a filter, in (friendly_name, entity_id) order
+ * Domain, area and favorites filters read their group index, so the cost
+ * is the size of the group; without a domain restriction only the rows
+ * copied out are touched.
+ *
+ * @param store Store
+ * @param filter Row filter (NULL for all rows)
+ * @param rows Output: borrowed row pointers (can be NULL when max_rows is 0)
+ * @param max_rows Capacity of rows
+ * @return Total number of matching rows (may exceed max_rows)
+ */
+int entity_store_select(const entity_store_t *store, const entity_filter_t *filter,
+                        const ha_entity_t **rows, int max_rows);
+
+/**
+ * Get distinct domains or areas, sorted (read from the group index)
+ *
+ * @param store Store
+ * @param group ENTITY_GROUP_DOMAIN or ENTITY_GROUP_AREA
+ * @param filter Domain restriction (can be NULL)
+ * @param count Output: number of values
+ * @return Array of strings (caller must free each string and the array)
+ */
+char** entity_store_group_values(const entity_store_t *store, entity_group_t group,
+                                 const entity_filter_t *filter, int *count);
+
+/**
+ * Record a change
+ * ADDED and REMOVED also set the layout flag.
+ *
+ * @param changes Change set (can be NULL)
+ * @param type Kind of change
+ * @param entity_id Entity ID (copied)
+ */
+void entity_changes_add(entity_changes_t *changes, entity_change_type_t type,
+                        const char *entity_id);
+
+/**
+ * Empty a change set, keeping its storage
+ *
+ * @param changes Change set
+ */
+void entity_changes_clear(entity_changes_t *changes);
+
+/**
+ * Free a change set's storage
+ *
+ * @param changes Change set (struct itself is not freed)
+ */
+void entity_changes_free(entity_changes_t *changes);
+
+/**
+ * Find the latest change recorded for an entity
+ *
+ * @param changes Change set
+ * @param entity_id Entity ID
+ * @return Change or NULL if the entity did not change
+ */
+const entity_change_t* entity_changes_find(const entity_changes_t *changes,
+                                           const char *entity_id);
+
+#endif // ENTITY_STORE_H
@@ -40,6 +40,29 @@ static size_t write_callback(void *contents, size_t size, size_t nmemb, void *us
     return real_size;
 }
 
+/**
+ * Copy the phase timings of a finished transfer
+ */
+static void read_timing(CURL *curl, ha_timing_t *timing) {
+    double seconds;
+
+    if (curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME, &seconds) == CURLE_OK) {
+        timing->dns_ms = seconds * 1000.0;
+    }
+    if (curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME, &seconds) == CURLE_OK) {
+        timing->connect_ms = seconds * 1000.0;
+    }
+    if (curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME, &seconds) == CURLE_OK) {
+        timing->tls_ms = seconds * 1000.0;
+    }
+    if (curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME, &seconds) == CURLE_OK) {
+        timing->ttfb_ms = seconds * 1000.0;
+    }
+    if (curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &seconds) == CURLE_OK) {
+        timing->total_ms = seconds * 1000.0;
+    }
+}
+
 ha_client_t* ha_client_create(const char *url, int port, const char *token) {
     if (!url || !token) {
         return NULL;
@@ -112,6 +135,7 @@ static ha_response_t* ha_get(ha_client_t *client, const char *endpoint) {
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&buffer);
     curl_easy_setopt(curl, CURLOPT_USERAGENT, USER_AGENT);
     curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)client->timeout);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);   // No SIGALRM timeouts: requests run on two threads
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
 
     // SSL certificate verification (skip if insecure flag is set)
@@ -122,6 +146,7 @@ static ha_response_t* ha_get(ha_client_t *client, const char *endpoint) {
 
     // Perform request
     CURLcode res = curl_easy_perform(curl);
+    read_timing(curl, &response->timing);
 
     if (res != CURLE_OK) {
         snprintf(response->error_message, sizeof(response->error_message),
@@ -190,6 +215,7 @@ static ha_response_t* ha_post(ha_client_t *client, const char *endpoint, const c
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&buffer);
     curl_easy_setopt(curl, CURLOPT_USERAGENT, USER_AGENT);
     curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)client->timeout);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);   // No SIGALRM timeouts: requests run on two threads
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
 
     // SSL certificate verification (skip if insecure flag is set)
@@ -200,6 +226,7 @@ static ha_response_t* ha_post(ha_client_t *client, const char *endpoint, const c
 
     // Perform request
     CURLcode res = curl_easy_perform(curl);
+    read_timing(curl, &response->timing);
 
     if (res != CURLE_OK) {
         snprintf(response->error_message, sizeof(response->error_message),
@@ -244,6 +271,37 @@ ha_response_t* ha_client_get_state(ha_client_t *client, const char *entity_id) {
     return ha_get(client, endpoint);
 }
 
+ha_response_t* ha_client_get_states_of(ha_client_t *client, const char *const *entity_ids,
+                                       int count) {
+    if (!entity_ids || count <= 0) {
+        return NULL;
+    }
+
+    size_t size = 512 + (size_t)count * 136;
+    char *body = malloc(size);
+    if (!body) {
+        return NULL;
+    }
+
+    // Single-quoted Jinja strings need no escaping inside the JSON body
+    size_t len = snprintf(body, size, "{\"template\": \"{%% set ids = [");
+    int listed = 0;
+    for (int i = 0; i < count; i++) {
+        if (strpbrk(entity_ids[i], "'\"\\")) continue;   // Not a valid entity ID
+        len += snprintf(body + len, size - len, "%s'%s'", listed++ ? "," : "", entity_ids[i]);
+    }
+    snprintf(body + len, size - len,
+             "] %%}[{%% for s in states | selectattr('entity_id', 'in', ids) %%}"
+             "{{ {'entity_id': s.entity_id, 'state': s.state, 'attributes': s.attributes,"
+             " 'last_changed': s.last_changed.isoformat(),"
+             " 'last_updated': s.last_updated.isoformat()} | to_json }}"
+             "{{ ',' if not loop.last }}{%% endfor %%}]\"}");
+
+    ha_response_t *response = ha_post(client, "/api/template", body);
+    free(body);
+    return response;
+}
+
 ha_response_t* ha_client_call_service(ha_client_t *client,
                                        const char *domain,
                                        const char *service,
@@ -22,6 +22,18 @@ typedef struct {
     int insecure;            // Skip SSL certificate verification (1 = skip, 0 = verify)
 } ha_client_t;
 
+/**
+ * Request phase timings from curl, in milliseconds since the request
+ * started (each includes the phases before it; tls_ms is 0 over http)
+ */
+typedef struct {
+    double dns_ms;           // Name resolved
+    double connect_ms;       // TCP connected
+    double tls_ms;           // TLS handshake done
+    double ttfb_ms;          // First response byte
+    double total_ms;         // Body received
+} ha_timing_t;
+
 /**
  * HTTP response structure
  */
@@ -31,6 +43,7 @@ typedef struct {
     int status_code;         // HTTP status code (200, 404, etc.)
     int success;             // 1 if successful (2xx status), 0 otherwise
     char error_message[256]; // Error description if failed
+    ha_timing_t timing;      // Where the request's time went
 } ha_response_t;
 
 /**
@@ -78,6 +91,19 @@ ha_response_t* ha_client_get_states(ha_client_t *client);
  */
 ha_response_t* ha_client_get_state(ha_client_t *client, const char *entity_id);
 
+/**
+ * Get the states of a few entities in one request
+ * Uses POST /api/template to render just these states, in the same
+ * format as GET /api/states (missing entities are left out)
+ *
+ * @param client HA client
+ * @param entity_ids Entity IDs
+ * @param count Number of IDs
+ * @return Response with JSON array of entities, NULL on failure
+ */
+ha_response_t* ha_client_get_states_of(ha_client_t *client, const char *const *entity_ids,
+                                       int count);
+
 /**
  * Call a Home Assistant service
  * Calls POST /api/services/<domain>/<service>
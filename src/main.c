@@ -17,6 +17,7 @@
 #include <SDL_ttf.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 #include "ui/colors.h"
 #include "ui/fonts.h"
@@ -30,6 +31,8 @@
 #include "screens/screen_automation.h"
 #include "screens/screen_script.h"
 #include "screens/screen_scene.h"
+#include "screens/screen_search.h"
+#include "screens/screen_diagnostics.h"
 #include "utils/input.h"
 #include "audio.h"
 #include "utils/config.h"
@@ -40,7 +43,40 @@
 // Miyoo Mini Plus screen dimensions
 #define SCREEN_WIDTH  640
 #define SCREEN_HEIGHT 480
-#define FRAME_DELAY   16  // ~60 FPS (16.67ms)
+#define FRAME_DELAY   16  // ~60 FPS (16.67ms), enforced even if vsync is not
+
+// Longest sleep between loop iterations when no deadline is closer
+#define WAIT_MAX_MS 10000
+
+// Keep the cache database in RAM and write it back to the SD card
+// periodically and when the user is idle (1), or query the file (0).
+// In RAM, writes since the last snapshot are lost on a crash or power cut.
+#ifndef DB_IN_MEMORY
+#define DB_IN_MEMORY 0
+#endif
+#define DB_SNAPSHOT_INTERVAL_MS 120000
+#define DB_SNAPSHOT_IDLE_MS     10000
+
+// No input for this long counts as idle for the sync scheduler
+#define SYNC_IDLE_MS 120000
+
+// Redraw only when input, data or status changed since the last frame (1),
+// or every frame (0, for comparing idle CPU use)
+#define RENDER_ON_DAMAGE 1
+#define RENDER_STATS_INTERVAL_MS 60000
+
+// What the screens show besides entity data; a change means a redraw
+typedef struct {
+    int online;
+    int syncing;
+    time_t last_sync;
+    int failures;
+    int interval;
+    const char *reason;
+    int sync_history_count;
+    double last_write_ms;
+    time_t clock;              // Only on screens with "N sec ago" text
+} render_status_t;
 
 // Application state
 typedef struct {
@@ -58,6 +94,7 @@ typedef struct {
 
     // Phase 4: UI system
     font_manager_t *fonts;
+    text_cache_t *text_cache;
     icon_manager_t *icons;
     test_screen_t *test_screen;
 
@@ -69,13 +106,32 @@ typedef struct {
     automation_screen_t *automation_screen;
     script_screen_t *script_screen;
     scene_screen_t *scene_screen;
+    search_screen_t *search_screen;
+    diagnostics_screen_t *diagnostics_screen;
     int current_screen;
+    int detail_return_screen;   // Screen that opened the current detail view
 
     // Phase 11: Exit confirmation dialog
     int show_exit_dialog;
 
-    // Phase 12: Background sync
-    Uint32 last_sync_check;
+    // In-memory database snapshots
+    Uint32 last_input_time;
+    Uint32 last_snapshot;
+
+    // Startup timeline, logged once per milestone
+    int first_frame_shown;
+    time_t cached_sync;        // Last sync of the cache the UI started from
+    int startup_synced;        // Initial background sync finished (or failed)
+
+    // Damage-driven rendering
+    int dirty;                 // Something on screen changed since the last frame
+    render_status_t shown_status;
+    Uint32 last_frame;         // When the last frame was drawn
+    Uint32 wake_event;         // Pushed by the sync thread (0: unavailable)
+    unsigned long frames_rendered;
+    unsigned long wakeups;
+    Uint32 stats_start;
+    clock_t stats_cpu;
 } app_state_t;
 
 // Screen IDs
@@ -87,6 +143,8 @@ typedef struct {
 #define SCREEN_SCRIPT     5
 #define SCREEN_SCENE      6
 #define SCREEN_TEST       7
+#define SCREEN_SEARCH     8
+#define SCREEN_DIAGNOSTICS 9
 
 /**
  * Initialize SDL2 and create window/renderer
@@ -184,12 +242,89 @@ static int init_sdl(app_state_t *app) {
 }
 
 /**
- * Handle SDL events
+ * Open the detail screen matching an entity's domain
  */
-static void handle_events(app_state_t *app) {
+static void open_entity_detail(app_state_t *app, const char *eid, int return_screen) {
+    if (!eid) return;
+
+    app->detail_return_screen = return_screen;
+
+    if (strncmp(eid, "automation.", 11) == 0 && app->automation_screen) {
+        automation_screen_set_entity(app->automation_screen, eid);
+        app->current_screen = SCREEN_AUTOMATION;
+    } else if (strncmp(eid, "script.", 7) == 0 && app->script_screen) {
+        script_screen_set_entity(app->script_screen, eid);
+        app->current_screen = SCREEN_SCRIPT;
+    } else if (strncmp(eid, "scene.", 6) == 0 && app->scene_screen) {
+        scene_screen_set_entity(app->scene_screen, eid);
+        app->current_screen = SCREEN_SCENE;
+    } else if (info_screen_should_handle(eid) && app->info_screen) {
+        // Generic read-only info for sensors, etc.
+        info_screen_set_entity(app->info_screen, eid);
+        app->current_screen = SCREEN_INFO;
+    } else if (app->device_screen) {
+        // Controllable entities (light, switch, fan, etc.)
+        device_screen_set_entity(app->device_screen, eid);
+        app->current_screen = SCREEN_DEVICE;
+    }
+}
+
+/**
+ * Return from a detail screen to whichever screen opened it
+ */
+static void close_entity_detail(app_state_t *app) {
+    // Screens already picked up any cache changes through their subscriptions
+    app->current_screen = app->detail_return_screen;
+}
+
+/**
+ * Cache change callback: error beep when the server rejects an action
+ * (the screens show the rolled-back state and a message), and a redraw
+ */
+static void on_cache_change(const entity_changes_t *changes, void *ctx) {
+    app_state_t *app = ctx;
+
+    // Any published change may be on screen
+    app->dirty = 1;
+
+    if (changes->rejected > 0) {
+        audio_play_error();
+    }
+}
+
+/**
+ * Sync thread callback: wake the main loop so the result is applied
+ * right away (SDL_PushEvent is safe from any thread)
+ */
+static void wake_main_loop(void *ctx) {
+    app_state_t *app = ctx;
+    SDL_Event event;
+
+    SDL_zero(event);
+    event.type = app->wake_event;
+    SDL_PushEvent(&event);
+}
+
+/**
+ * Handle SDL events, first sleeping up to timeout ms for one to arrive
+ */
+static void handle_events(app_state_t *app, int timeout) {
     SDL_Event event;
 
+    // Leaves the event in the queue for the loop below
+    if (timeout > 0 && !SDL_WaitEventTimeout(NULL, timeout)) {
+        return;
+    }
+
     while (SDL_PollEvent(&event)) {
+        if (app->wake_event && event.type == app->wake_event) {
+            continue;   // cache_manager_poll() picks up the result
+        }
+
+        // Input can change anything on screen; window events may have
+        // clobbered the frame
+        app->dirty = 1;
+
         switch (event.type) {
             case SDL_QUIT:
                 app->running = 0;
@@ -197,6 +332,8 @@ static void handle_events(app_state_t *app) {
 
             case SDL_KEYDOWN:
             case SDL_KEYUP:
+                app->last_input_time = SDL_GetTicks();
+
                 // Debug: Print key events
                 if (event.type == SDL_KEYDOWN) {
                     printf("Key pressed: %d\n", event.key.keysym.sym);
@@ -236,58 +373,55 @@ static void handle_events(app_state_t *app) {
                             app->current_screen = SCREEN_SETUP;
                         } else if (result == 1) {
                             // Go to detail screen based on entity domain
-                            ha_entity_t *entity = list_screen_get_selected_entity(app->list_screen);
+                            const ha_entity_t *entity = list_screen_get_selected_entity(app->list_screen);
                             if (entity) {
-                                const char *eid = entity->entity_id;
-                                if (strncmp(eid, "automation.", 11) == 0 && app->automation_screen) {
-                                    automation_screen_set_entity(app->automation_screen, eid);
-                                    app->current_screen = SCREEN_AUTOMATION;
-                                } else if (strncmp(eid, "script.", 7) == 0 && app->script_screen) {
-                                    script_screen_set_entity(app->script_screen, eid);
-                                    app->current_screen = SCREEN_SCRIPT;
-                                } else if (strncmp(eid, "scene.", 6) == 0 && app->scene_screen) {
-                                    scene_screen_set_entity(app->scene_screen, eid);
-                                    app->current_screen = SCREEN_SCENE;
-                                } else if (info_screen_should_handle(eid) && app->info_screen) {
-                                    // Generic read-only info for sensors, etc.
-                                    info_screen_set_entity(app->info_screen, eid);
-                                    app->current_screen = SCREEN_INFO;
-                                } else if (app->device_screen) {
-                                    // Controllable entities (light, switch, fan, etc.)
-                                    device_screen_set_entity(app->device_screen, eid);
-                                    app->current_screen = SCREEN_DEVICE;
-                                }
+                                open_entity_detail(app, entity->entity_id, SCREEN_LIST);
                             }
+                        } else if (result == 2 && app->search_screen) {
+                            search_screen_reset(app->search_screen);
+                            app->current_screen = SCREEN_SEARCH;
+                        } else if (result == 3 && app->diagnostics_screen) {
+                            diagnostics_screen_reset(app->diagnostics_screen);
+                            app->current_screen = SCREEN_DIAGNOSTICS;
+                        }
+                    } else if (app->current_screen == SCREEN_SEARCH && app->search_screen) {
+                        int result = search_screen_handle_input(app->search_screen, &event);
+                        if (result == -1) {
+                            app->current_screen = SCREEN_LIST;
+                        } else if (result == 1) {
+                            open_entity_detail(app,
+                                               search_screen_get_selected_entity_id(app->search_screen),
+                                               SCREEN_SEARCH);
+                        }
+                    } else if (app->current_screen == SCREEN_DIAGNOSTICS && app->diagnostics_screen) {
+                        if (diagnostics_screen_handle_input(app->diagnostics_screen, &event) == -1) {
+                            app->current_screen = SCREEN_LIST;
                         }
                     } else if (app->current_screen == SCREEN_INFO && app->info_screen) {
                         int result = info_screen_handle_input(app->info_screen, &event);
                         if (result == -1) {
-                            app->current_screen = SCREEN_LIST;
+                            app->current_screen = app->detail_return_screen;
                         }
                     } else if (app->current_screen == SCREEN_AUTOMATION && app->automation_screen) {
                         int result = automation_screen_handle_input(app->automation_screen, &event);
                         if (result == -1) {
-                            app->current_screen = SCREEN_LIST;
-                            list_screen_refresh(app->list_screen);
+                            close_entity_detail(app);
                         }
                     } else if (app->current_screen == SCREEN_SCRIPT && app->script_screen) {
                         int result = script_screen_handle_input(app->script_screen, &event);
                         if (result == -1) {
-                            app->current_screen = SCREEN_LIST;
-                            list_screen_refresh(app->list_screen);
+                            close_entity_detail(app);
                         }
                     } else if (app->current_screen == SCREEN_SCENE && app->scene_screen) {
                         int result = scene_screen_handle_input(app->scene_screen, &event);
                         if (result == -1) {
-                            app->current_screen = SCREEN_LIST;
-                            list_screen_refresh(app->list_screen);
+                            close_entity_detail(app);
                         }
                     } else if (app->current_screen == SCREEN_DEVICE && app->device_screen) {
                         int result = device_screen_handle_input(app->device_screen, &event);
                         if (result == -1) {
-                            // Back to list
-                            app->current_screen = SCREEN_LIST;
-                            list_screen_refresh(app->list_screen);
+                            // Back to list (or search)
+                            close_entity_detail(app);
                         }
                     } else if (app->current_screen == SCREEN_TEST && app->test_screen) {
                         test_screen_handle_input(app->test_screen, &event);
@@ -362,6 +496,10 @@ static void render(app_state_t *app) {
         script_screen_render(app->script_screen);
     } else if (app->current_screen == SCREEN_SCENE && app->scene_screen) {
         scene_screen_render(app->scene_screen);
+    } else if (app->current_screen == SCREEN_SEARCH && app->search_screen) {
+        search_screen_render(app->search_screen);
+    } else if (app->current_screen == SCREEN_DIAGNOSTICS && app->diagnostics_screen) {
+        diagnostics_screen_render(app->diagnostics_screen);
     } else if (app->current_screen == SCREEN_TEST && app->test_screen) {
         test_screen_render(app->test_screen);
     }
@@ -375,42 +513,299 @@ static void render(app_state_t *app) {
     SDL_RenderPresent(app->renderer);
 }
 
+/**
+ * What the user is doing, for the sync scheduler
+ */
+static sync_activity_t current_activity(app_state_t *app, Uint32 now) {
+    if (now - app->last_input_time > SYNC_IDLE_MS) {
+        return SYNC_ACTIVITY_IDLE;
+    }
+
+    switch (app->current_screen) {
+        case SCREEN_DEVICE:
+        case SCREEN_INFO:
+        case SCREEN_AUTOMATION:
+        case SCREEN_SCRIPT:
+        case SCREEN_SCENE:
+            return SYNC_ACTIVITY_DETAIL;
+        default:
+            return SYNC_ACTIVITY_LIST;
+    }
+}
+
+/**
+ * Detail screens show "Last changed: N sec ago", which moves every second
+ */
+static int screen_shows_clock(app_state_t *app) {
+    switch (app->current_screen) {
+        case SCREEN_DEVICE:
+        case SCREEN_INFO:
+        case SCREEN_AUTOMATION:
+        case SCREEN_SCRIPT:
+        case SCREEN_SCENE:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Collect the status the current screen may show
+ */
+static void read_render_status(app_state_t *app, render_status_t *status) {
+    memset(status, 0, sizeof(*status));   // Compared with memcmp, padding included
+
+    if (app->cache_mgr) {
+        const sync_schedule_t *schedule = cache_manager_get_schedule(app->cache_mgr);
+        const sync_stats_t *latest = cache_manager_get_sync_stats(app->cache_mgr, 0);
+
+        status->online = cache_manager_is_online(app->cache_mgr);
+        status->syncing = cache_manager_is_syncing(app->cache_mgr);
+        status->last_sync = cache_manager_get_last_sync(app->cache_mgr);
+        status->failures = schedule->failures;
+        status->interval = schedule->interval;
+        status->reason = schedule->reason;
+        status->sync_history_count = app->cache_mgr->sync_history_count;
+        status->last_write_ms = latest ? latest->write_ms : 0;
+    }
+
+    if (screen_shows_clock(app)) {
+        status->clock = time(NULL);
+    }
+}
+
+/**
+ * Decide whether this frame needs drawing: input and cache changes set
+ * app->dirty as they happen, status is compared with what was last shown
+ */
+static int frame_needs_render(app_state_t *app) {
+    render_status_t status;
+    read_render_status(app, &status);
+
+    if (memcmp(&status, &app->shown_status, sizeof(status)) != 0) {
+        app->shown_status = status;
+        app->dirty = 1;
+    }
+
+#if RENDER_ON_DAMAGE
+    return app->dirty;
+#else
+    return 1;
+#endif
+}
+
+/**
+ * Log how many frames were drawn and the process CPU time over the last
+ * interval (and at exit, with final = 1)
+ */
+static void log_render_stats(app_state_t *app, Uint32 now, int final) {
+    Uint32 elapsed = now - app->stats_start;
+    if (!final && elapsed < RENDER_STATS_INTERVAL_MS) {
+        return;
+    }
+
+    clock_t cpu = clock();
+    double cpu_ms = (double)(cpu - app->stats_cpu) * 1000.0 / CLOCKS_PER_SEC;
+    printf("Frames: %lu rendered, %lu wakeups, CPU %.1f%% over %u ms\n",
+           app->frames_rendered, app->wakeups,
+           elapsed > 0 ? cpu_ms * 100.0 / elapsed : 0.0, elapsed);
+
+    app->frames_rendered = 0;
+    app->wakeups = 0;
+    app->stats_start = now;
+    app->stats_cpu = cpu;
+}
+
+/**
+ * Helper: the earlier of a timeout and a deadline (negative: none)
+ */
+static int sooner(int timeout, int candidate) {
+    if (candidate < 0) {
+        return timeout;
+    }
+    return candidate < timeout ? candidate : timeout;
+}
+
+/**
+ * Helper: milliseconds from now until a tick deadline (0 if passed)
+ */
+static int until(Uint32 deadline, Uint32 now) {
+    Sint32 remaining = (Sint32)(deadline - now);
+    return remaining > 0 ? remaining : 0;
+}
+
+/**
+ * How long the loop may sleep before something needs doing: the next
+ * frame when one is waiting to be drawn, a key repeat, the cache
+ * manager's next sync or refresh, the clock on detail screens, the
+ * database snapshot, the scheduler's idle switch and the stats log.
+ * Events (input and sync thread results) end the sleep early.
+ */
+static int next_timeout(app_state_t *app, Uint32 now) {
+    int timeout = WAIT_MAX_MS;
+
+    // Drawing is paced here, so it holds whether or not present waits for vsync
+    if (app->dirty || !RENDER_ON_DAMAGE) {
+        timeout = sooner(timeout, until(app->last_frame + FRAME_DELAY, now));
+    }
+
+    timeout = sooner(timeout, input_repeat_timeout());
+
+    if (app->cache_mgr) {
+        timeout = sooner(timeout, cache_manager_poll_timeout(app->cache_mgr));
+
+        // Without a wake event, sync results are only seen by polling
+        if (app->cache_mgr->sync && !app->wake_event) {
+            timeout = sooner(timeout, FRAME_DELAY);
+        }
+    }
+
+    if (screen_shows_clock(app)) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        timeout = sooner(timeout, 1000 - (int)(ts.tv_nsec / 1000000));
+    }
+
+    if (app->db && app->db->in_memory) {
+        Uint32 idle_at = app->last_input_time + DB_SNAPSHOT_IDLE_MS;
+        Uint32 quiet_at = app->last_snapshot + DB_SNAPSHOT_IDLE_MS;
+        timeout = sooner(timeout, until(app->last_snapshot + DB_SNAPSHOT_INTERVAL_MS, now) + 1);
+        timeout = sooner(timeout, until((Sint32)(idle_at - quiet_at) > 0 ? idle_at : quiet_at,
+                                        now) + 1);
+    }
+
+    if (now - app->last_input_time <= SYNC_IDLE_MS) {
+        timeout = sooner(timeout, until(app->last_input_time + SYNC_IDLE_MS, now) + 1);
+    }
+
+    return sooner(timeout, until(app->stats_start + RENDER_STATS_INTERVAL_MS, now));
+}
+
+/**
+ * Log a startup milestone with the time since SDL came up
+ */
+static void log_startup(const char *milestone) {
+    printf("Startup: %s at %u ms\n", milestone, SDL_GetTicks());
+}
+
+/**
+ * Log when the first frame is up and when the initial sync has replaced
+ * the cached data (or failed, leaving it in place)
+ */
+static void track_startup(app_state_t *app) {
+    if (!app->first_frame_shown) {
+        app->first_frame_shown = 1;
+        log_startup("first frame");
+    }
+
+    if (app->startup_synced || !app->cache_mgr) {
+        return;
+    }
+    if (cache_manager_get_last_sync(app->cache_mgr) != app->cached_sync) {
+        app->startup_synced = 1;
+        log_startup("fresh data");
+    } else if (cache_manager_get_schedule(app->cache_mgr)->failures > 0) {
+        app->startup_synced = 1;
+        log_startup("initial sync failed, showing cached data");
+    }
+}
+
+/**
+ * Entities the current screen shows, for the visible-set refresh
+ */
+static int visible_entities(app_state_t *app, const char **ids, int max_ids) {
+    const char *entity_id = NULL;
+
+    switch (app->current_screen) {
+        case SCREEN_LIST:
+            return app->list_screen ?
+                list_screen_get_visible_ids(app->list_screen, ids, max_ids) : 0;
+        case SCREEN_DEVICE:
+            entity_id = app->device_screen ? app->device_screen->entity_id : NULL;
+            break;
+        case SCREEN_INFO:
+            entity_id = app->info_screen ? app->info_screen->entity_id : NULL;
+            break;
+        case SCREEN_AUTOMATION:
+            entity_id = app->automation_screen ? app->automation_screen->entity_id : NULL;
+            break;
+        case SCREEN_SCRIPT:
+            entity_id = app->script_screen ? app->script_screen->entity_id : NULL;
+            break;
+        case SCREEN_SCENE:
+            entity_id = app->scene_screen ? app->scene_screen->entity_id : NULL;
+            break;
+        default:
+            return 0;
+    }
+
+    if (!entity_id || !entity_id[0] || max_ids < 1) {
+        return 0;
+    }
+    ids[0] = entity_id;
+    return 1;
+}
+
 /**
  * Main application loop
  */
 static void main_loop(app_state_t *app) {
     Uint32 frame_start;
-    int frame_time;
+
+    app->dirty = 1;
+    app->stats_start = SDL_GetTicks();
+    app->stats_cpu = clock();
+    app->last_frame = app->stats_start - FRAME_DELAY;
 
     while (app->running) {
+        // Sleep until an event or the next deadline, then process input
+        handle_events(app, next_timeout(app, SDL_GetTicks()));
         frame_start = SDL_GetTicks();
+        app->wakeups++;
+
+        // Phase 12: Let the scheduler pick the sync rate and track what is
+        // on screen, then merge a finished background sync at the frame
+        // boundary; subscribed screens patch the rows it changed
+        if (app->cache_mgr) {
+            const char *visible[CACHE_MAX_VISIBLE];
+            int visible_count = visible_entities(app, visible, CACHE_MAX_VISIBLE);
+
+            cache_manager_set_activity(app->cache_mgr, current_activity(app, frame_start));
+            cache_manager_set_visible(app->cache_mgr, visible, visible_count);
+            cache_manager_poll(app->cache_mgr);
+        }
 
-        // Process input
-        handle_events(app);
-
-        // Phase 12: Background sync check every 60 seconds
-        if (app->cache_mgr && (frame_start - app->last_sync_check > 60000)) {
-            if (cache_manager_should_sync(app->cache_mgr)) {
-                int synced = cache_manager_sync(app->cache_mgr);
-                if (synced > 0 && app->list_screen) {
-                    list_screen_refresh(app->list_screen);
+        // Write the in-memory cache back to the SD card (no-op when unchanged)
+        if (app->db && app->db->in_memory) {
+            Uint32 since_snapshot = frame_start - app->last_snapshot;
+            int idle = (frame_start - app->last_input_time) > DB_SNAPSHOT_IDLE_MS;
+            if (since_snapshot > DB_SNAPSHOT_INTERVAL_MS ||
+                (idle && since_snapshot > DB_SNAPSHOT_IDLE_MS)) {
+                if (app->cache_mgr) {
+                    cache_manager_snapshot(app->cache_mgr);
+                } else {
+                    database_snapshot(app->db, 0);
                 }
+                app->last_snapshot = frame_start;
             }
-            app->last_sync_check = frame_start;
         }
 
-        // Render frame
-        render(app);
+        // Render frame when something changed and the last one is a
+        // frame time ago; otherwise the display keeps the last one
+        if (frame_needs_render(app) && frame_start - app->last_frame >= FRAME_DELAY) {
+            app->last_frame = frame_start;
+            render(app);
+            app->dirty = 0;
+            app->frames_rendered++;
+        }
+        track_startup(app);
+        log_render_stats(app, frame_start, 0);
 
         // Reset input state for next frame
         input_reset();
-
-        // Frame rate limiting
-        frame_time = SDL_GetTicks() - frame_start;
-        if (frame_time < FRAME_DELAY) {
-            SDL_Delay(FRAME_DELAY - frame_time);
-        }
     }
+
+    log_render_stats(app, SDL_GetTicks(), 1);
 }
 
 /**
@@ -418,6 +813,12 @@ static void main_loop(app_state_t *app) {
  */
 static void cleanup(app_state_t *app) {
     // Phase 5-9: Cleanup screens
+    if (app->diagnostics_screen) {
+        diagnostics_screen_destroy(app->diagnostics_screen);
+    }
+    if (app->search_screen) {
+        search_screen_destroy(app->search_screen);
+    }
     if (app->scene_screen) {
         scene_screen_destroy(app->scene_screen);
     }
@@ -447,16 +848,24 @@ static void cleanup(app_state_t *app) {
     if (app->icons) {
         icons_destroy(app->icons);
     }
+    if (app->text_cache) {
+        printf("Text cache: %lu hits, %lu misses, %lu evictions\n",
+               app->text_cache->hits, app->text_cache->misses, app->text_cache->evictions);
+        ui_set_text_cache(NULL);
+        text_cache_destroy(app->text_cache);
+    }
     if (app->fonts) {
         fonts_destroy(app->fonts);
     }
 
     // Phase 3: Cleanup cache manager and database
     if (app->cache_mgr) {
+        // Barrier: every queued write reaches disk before the writer stops
+        cache_manager_flush(app->cache_mgr);
         cache_manager_destroy(app->cache_mgr);
     }
     if (app->db) {
-        database_close(app->db);
+        database_close(app->db);   // Final snapshot when in memory
     }
 
     // Phase 2: Cleanup API client and config
@@ -525,7 +934,11 @@ int main(int argc, char *argv[]) {
 #else
     // Phase 3: Open database
     printf("Opening database...\n");
+#if DB_IN_MEMORY
+    app.db = database_open_in_memory("hacompanion.db");
+#else
     app.db = database_open("hacompanion.db");
+#endif
     if (!app.db) {
         fprintf(stderr, "Failed to open database\n");
         cleanup(&app);
@@ -537,6 +950,7 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     printf("Database ready (cached entities: %d)\n", database_get_entity_count(app.db));
+    log_startup("database open");
 
     // Phase 2: Load configuration
     printf("Loading configuration...\n");
@@ -568,20 +982,34 @@ int main(int argc, char *argv[]) {
         cleanup(&app);
         return 1;
     }
+    cache_manager_subscribe(app.cache_mgr, on_cache_change, &app);
+
+    // Lets the sync thread wake the main loop when a result is ready
+    app.wake_event = SDL_RegisterEvents(1);
+    if (app.wake_event == (Uint32)-1) {
+        app.wake_event = 0;
+    }
 
-    // Initial sync if online
+    printf("Cached entities: %d\n", cache_manager_get_entity_count(app.cache_mgr));
+    log_startup("cache loaded");
+    app.cached_sync = cache_manager_get_last_sync(app.cache_mgr);
+
+    // Show the cache right away; the initial sync runs in the background
+    // and patches the screens when it lands
     if (app.ha_client) {
-        int synced = cache_manager_sync(app.cache_mgr);
-        if (synced > 0) {
-            printf("Synced %d entities from Home Assistant\n", synced);
-        } else if (synced == 0) {
-            printf("Connected (no entities to sync)\n");
+        if (cache_manager_start_sync_thread(app.cache_mgr,
+                                            app.wake_event ? wake_main_loop : NULL, &app)) {
+            cache_manager_request_sync(app.cache_mgr);
         } else {
-            printf("Sync failed - using cached data\n");
+            fprintf(stderr, "Background sync unavailable, syncing now\n");
+            int synced = cache_manager_sync(app.cache_mgr);
+            if (synced < 0) {
+                printf("Sync failed - using cached data\n");
+            }
         }
+    } else {
+        app.startup_synced = 1;   // Offline: the cache is all there is
     }
-
-    printf("Cached entities: %d\n", cache_manager_get_entity_count(app.cache_mgr));
 #endif
 
 #if SKIP_NETWORK_TEST
@@ -648,6 +1076,11 @@ int main(int argc, char *argv[]) {
         cleanup(&app);
         return 1;
     }
+    if (!fonts_build_atlases(app.fonts, app.renderer)) {
+        fprintf(stderr, "Glyph atlases unavailable, rendering text per call\n");
+    }
+    app.text_cache = text_cache_create(app.renderer);
+    ui_set_text_cache(app.text_cache);
 
     printf("Initializing icons...\n");
     app.icons = icons_init(app.renderer, "assets/icons");
@@ -735,12 +1168,33 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    // Create search screen
+    printf("Creating search screen...\n");
+    app.search_screen = search_screen_create(app.renderer, app.fonts, app.icons, app.cache_mgr);
+    if (!app.search_screen) {
+        fprintf(stderr, "Failed to create search screen\n");
+        cleanup(&app);
+        return 1;
+    }
+
+    // Create sync diagnostics screen
+    printf("Creating diagnostics screen...\n");
+    app.diagnostics_screen = diagnostics_screen_create(app.renderer, app.fonts, app.icons,
+                                                       app.cache_mgr);
+    if (!app.diagnostics_screen) {
+        fprintf(stderr, "Failed to create diagnostics screen\n");
+        cleanup(&app);
+        return 1;
+    }
+
     // Start on list screen (skip setup since we already connected during init)
     app.current_screen = SCREEN_LIST;
+    app.detail_return_screen = SCREEN_LIST;
 
     printf("\nReady! Press Menu/Escape to exit\n");
     printf("Setup: D-Pad=Select, A=Connect, START=Continue\n");
-    printf("List: L1/R1=Tabs, D-Pad=Navigate, A=Toggle, SEL=Detail, Y=Favorite\n");
+    printf("List: L1/R1=Tabs, D-Pad=Navigate, A=Toggle, SEL=Detail, Y=Favorite, R2=Search\n");
+    printf("Search: Left/Right=Pick, A=Add, X=Delete, SEL=Open, B=Back\n");
     printf("Detail: D-Pad=Select, A=Action, Y=Favorite, B=Back\n\n");
 
     // Run main loop
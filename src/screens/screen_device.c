@@ -46,6 +46,7 @@ static void draw_slider_row(device_screen_t *screen, int y, const char *label,
                             int is_selected, int is_temp_kelvin);
 static void draw_control(device_screen_t *screen);
 static void format_last_changed(const char *iso_time, char *output, size_t output_size);
+static void on_cache_change(const entity_changes_t *changes, void *ctx);
 
 device_screen_t* device_screen_create(SDL_Renderer *renderer,
                                        font_manager_t *fonts,
@@ -71,12 +72,18 @@ device_screen_t* device_screen_create(SDL_Renderer *renderer,
     screen->control_type = CTRL_NONE;
     screen->selected_control = 0;
 
+    if (cache_mgr) {
+        cache_manager_subscribe(cache_mgr, on_cache_change, screen);
+    }
+
     return screen;
 }
 
 void device_screen_destroy(device_screen_t *screen) {
     if (!screen) return;
 
+    if (screen->cache_mgr) cache_manager_unsubscribe(screen->cache_mgr, on_cache_change, screen);
+
     if (screen->entity) {
         free_entity(screen->entity);
     }
@@ -94,10 +101,11 @@ int device_screen_set_entity(device_screen_t *screen, const char *entity_id) {
     }
 
     strncpy(screen->entity_id, entity_id, sizeof(screen->entity_id) - 1);
+    screen->icon = icons_get_for_domain(entity_id);
 
     // Load entity from cache
     if (screen->cache_mgr) {
-        screen->entity = cache_manager_get_entity(screen->cache_mgr, entity_id);
+        screen->entity = copy_entity(cache_manager_get_entity(screen->cache_mgr, entity_id));
     }
 
     if (!screen->entity) {
@@ -271,8 +279,10 @@ int device_screen_handle_input(device_screen_t *screen, SDL_Event *event) {
 
     // START - refresh
     if (input_button_pressed(BTN_START)) {
-        device_screen_refresh(screen);
-        strcpy(screen->status_message, "Refreshed");
+        // Without a sync thread the refresh has already finished
+        int queued = device_screen_refresh(screen);
+        strcpy(screen->status_message, !queued ? "Refresh failed" :
+               screen->cache_mgr->sync ? "Refreshing..." : "Refreshed");
         return 0;
     }
 
@@ -317,9 +327,11 @@ void device_screen_render(device_screen_t *screen) {
     // Large icon
     draw_large_icon(screen, 320, 140);
 
-    // Current state
-    char state_text[64];
-    snprintf(state_text, sizeof(state_text), "%s", screen->entity->state);
+    // Current state ("..." while an action awaits the server)
+    int pending = screen->cache_mgr &&
+                  cache_manager_is_pending(screen->cache_mgr, screen->entity_id);
+    char state_text[72];
+    snprintf(state_text, sizeof(state_text), "%s%s", screen->entity->state, pending ? "..." : "");
     // Capitalize first letter
     if (state_text[0] >= 'a' && state_text[0] <= 'z') {
         state_text[0] -= 32;
@@ -349,7 +361,7 @@ void device_screen_render(device_screen_t *screen) {
         ui_draw_filled_rect(r, sel_bg, COLOR_SELECTED);
     }
 
-    icons_draw(screen->icons, screen->is_favorite ? "star_filled" : "star_empty", 80, fav_y, 16);
+    icons_draw(screen->icons, screen->is_favorite ? ICON_ID_STAR_FILLED : ICON_ID_STAR_EMPTY, 80, fav_y, 16);
     ui_draw_text(r, font_body, screen->is_favorite ? "Favorited" : "Add to Favorites",
                 100, fav_y, fav_selected ? COLOR_GB_DARKEST : COLOR_TEXT_PRIMARY, TEXT_ALIGN_LEFT);
 
@@ -364,18 +376,12 @@ void device_screen_render(device_screen_t *screen) {
     ui_draw_button_hints(r, font_body, hints, 4);
 }
 
-void device_screen_refresh(device_screen_t *screen) {
-    if (!screen || !screen->cache_mgr) return;
+int device_screen_refresh(device_screen_t *screen) {
+    if (!screen || !screen->cache_mgr) return 0;
 
-    // Refresh from API
-    ha_entity_t *updated = cache_manager_refresh_entity(screen->cache_mgr, screen->entity_id);
-    if (updated) {
-        if (screen->entity) {
-            free_entity(screen->entity);
-        }
-        screen->entity = updated;
-        extract_control_value(screen);
-    }
+    // Read on the sync thread (or right here without one); the new state
+    // arrives through on_cache_change
+    return cache_manager_request_refresh(screen->cache_mgr, screen->entity_id);
 }
 
 /* ============================================
@@ -527,7 +533,7 @@ static void extract_control_value(device_screen_t *screen) {
 }
 
 static int send_control_action(device_screen_t *screen) {
-    if (!screen || !screen->client_ptr || !*screen->client_ptr || !screen->entity) {
+    if (!screen || !screen->cache_mgr || !screen->entity) {
         return 0;
     }
 
@@ -612,30 +618,17 @@ static int send_control_action(device_screen_t *screen) {
 
     if (!service) return 0;
 
-    ha_response_t *response = ha_client_call_service(
-        *screen->client_ptr, domain, service, screen->entity->entity_id,
-        strlen(params) > 0 ? params : NULL
-    );
-
-    int success = (response && response->success);
-    if (response) {
-        ha_response_free(response);
-    }
-
-    // Refresh entity after action
-    if (success) {
-        device_screen_refresh(screen);
-    }
-
-    return success;
+    // The predicted state arrives through on_cache_change() right away;
+    // the server's answer (or a rollback) follows the same way
+    return cache_manager_call_service(screen->cache_mgr, domain, service,
+                                      screen->entity->entity_id,
+                                      strlen(params) > 0 ? params : NULL);
 }
 
 static void draw_large_icon(device_screen_t *screen, int x, int y) {
     if (!screen || !screen->entity) return;
 
     // Draw 4x scaled icon (64x64)
-    const char *icon_name = icons_get_for_domain(screen->entity->entity_id);
-
     // Draw icon at 4x scale (16*4 = 64)
     // We'll draw it 4 times offset
     int base_size = 16;
@@ -644,7 +637,7 @@ static void draw_large_icon(device_screen_t *screen, int x, int y) {
     int offset_y = y;
 
     // Simple scaling: draw the icon larger
-    icons_draw(screen->icons, icon_name, offset_x, offset_y, base_size * scale);
+    icons_draw(screen->icons, screen->icon, offset_x, offset_y, base_size * scale);
 }
 
 static void format_last_changed(const char *iso_time, char *output, size_t output_size) {
@@ -820,3 +813,29 @@ static void draw_control(device_screen_t *screen) {
                        screen->selected_control == 1, 0);
     }
 }
+
+/**
+ * Cache change callback: pick up new state for the shown entity
+ */
+static void on_cache_change(const entity_changes_t *changes, void *ctx) {
+    device_screen_t *screen = ctx;
+    if (!screen->entity) return;
+
+    const entity_change_t *change = entity_changes_find(changes, screen->entity_id);
+    if (!change) return;
+
+    if (change->type == ENTITY_CHANGE_REMOVED) {
+        strcpy(screen->status_message, "Removed from Home Assistant");
+        return;
+    }
+    if (change->type == ENTITY_CHANGE_REJECTED) {
+        strcpy(screen->status_message, "Action failed");
+    }
+
+    ha_entity_t *updated = copy_entity(cache_manager_get_entity(screen->cache_mgr, screen->entity_id));
+    if (updated) {
+        free_entity(screen->entity);
+        screen->entity = updated;
+        extract_control_value(screen);
+    }
+}
@@ -44,6 +44,7 @@ typedef struct {
     // Current entity
     ha_entity_t *entity;
     char entity_id[128];
+    icon_id_t icon;          // Domain icon, resolved when the entity is set
 
     // Control state
     control_type_t control_type;
@@ -119,10 +120,11 @@ int device_screen_handle_input(device_screen_t *screen, SDL_Event *event);
 void device_screen_render(device_screen_t *screen);
 
 /**
- * Refresh entity data
+ * Request fresh entity data (answered asynchronously with a sync thread)
  *
  * @param screen Device screen
+ * @return 1 if the refresh was queued or done, 0 otherwise
  */
-void device_screen_refresh(device_screen_t *screen);
+int device_screen_refresh(device_screen_t *screen);
 
 #endif // SCREEN_DEVICE_H
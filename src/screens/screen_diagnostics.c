@@ -0,0 +1,253 @@
+/**
+ * screen_diagnostics.c - Sync Diagnostics Screen Implementation
+ *
+ * curl reports each phase as time since the request started; the
+ * breakdown shows the difference between consecutive phases so the
+ * bars add up to the request.
+ */
+
+#include "screen_diagnostics.h"
+#include "../utils/input.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define HISTORY_VISIBLE 12
+#define HISTORY_ITEM_HEIGHT 28
+#define PHASE_BAR_WIDTH 120
+
+static void draw_history(diagnostics_screen_t *screen, int count);
+static void draw_breakdown(diagnostics_screen_t *screen, const sync_stats_t *stats);
+
+diagnostics_screen_t* diagnostics_screen_create(SDL_Renderer *renderer,
+                                                 font_manager_t *fonts,
+                                                 icon_manager_t *icons,
+                                                 cache_manager_t *cache_mgr) {
+    if (!renderer || !fonts || !icons) {
+        return NULL;
+    }
+
+    diagnostics_screen_t *screen = calloc(1, sizeof(diagnostics_screen_t));
+    if (!screen) {
+        return NULL;
+    }
+
+    screen->renderer = renderer;
+    screen->fonts = fonts;
+    screen->icons = icons;
+    screen->cache_mgr = cache_mgr;
+
+    return screen;
+}
+
+void diagnostics_screen_destroy(diagnostics_screen_t *screen) {
+    free(screen);
+}
+
+void diagnostics_screen_reset(diagnostics_screen_t *screen) {
+    if (!screen) return;
+
+    screen->selected_index = 0;
+    screen->scroll_offset = 0;
+}
+
+int diagnostics_screen_handle_input(diagnostics_screen_t *screen, SDL_Event *event) {
+    if (!screen || !event || event->type != SDL_KEYDOWN) return 0;
+
+    int count = 0;
+    while (cache_manager_get_sync_stats(screen->cache_mgr, count)) {
+        count++;
+    }
+
+    if (input_button_pressed(BTN_DPAD_UP)) {
+        if (screen->selected_index > 0) screen->selected_index--;
+    } else if (input_button_pressed(BTN_DPAD_DOWN)) {
+        if (screen->selected_index < count - 1) screen->selected_index++;
+    } else if (input_button_pressed(BTN_START)) {
+        cache_manager_request_sync(screen->cache_mgr);
+        screen->selected_index = 0;
+    } else if (input_button_pressed(BTN_B)) {
+        return -1;
+    }
+
+    // Keep the selection in view
+    if (screen->selected_index < screen->scroll_offset) {
+        screen->scroll_offset = screen->selected_index;
+    }
+    if (screen->selected_index >= screen->scroll_offset + HISTORY_VISIBLE) {
+        screen->scroll_offset = screen->selected_index - HISTORY_VISIBLE + 1;
+    }
+
+    return 0;
+}
+
+void diagnostics_screen_render(diagnostics_screen_t *screen) {
+    if (!screen) return;
+
+    SDL_Renderer *r = screen->renderer;
+    TTF_Font *font_header = fonts_get(screen->fonts, FONT_SIZE_HEADER);
+    TTF_Font *font_body = fonts_get(screen->fonts, FONT_SIZE_BODY);
+    TTF_Font *font_small = fonts_get(screen->fonts, FONT_SIZE_SMALL);
+
+    set_render_color(r, COLOR_BACKGROUND);
+    SDL_RenderClear(r);
+
+    int is_online = screen->cache_mgr ? cache_manager_is_online(screen->cache_mgr) : 0;
+    ui_draw_header(r, font_header, font_small, "SYNC DIAGNOSTICS", is_online);
+
+    int count = 0;
+    while (cache_manager_get_sync_stats(screen->cache_mgr, count)) {
+        count++;
+    }
+
+    if (count == 0) {
+        const char *msg = cache_manager_is_syncing(screen->cache_mgr) ? "Syncing..." :
+                                                                        "No syncs yet";
+        ui_draw_text(r, font_body, msg, 320, 240, COLOR_TEXT_SECONDARY, TEXT_ALIGN_CENTER);
+    } else {
+        if (screen->selected_index >= count) {
+            screen->selected_index = count - 1;
+        }
+        draw_history(screen, count);
+        draw_breakdown(screen, cache_manager_get_sync_stats(screen->cache_mgr,
+                                                            screen->selected_index));
+    }
+
+    // Scheduler decision, for context
+    const sync_schedule_t *schedule = cache_manager_get_schedule(screen->cache_mgr);
+    if (schedule) {
+        char next[96];
+        snprintf(next, sizeof(next), "Next: %s, every %ds", schedule->reason ? schedule->reason : "-",
+                 schedule->interval);
+        ui_draw_text(r, font_small, next, 20, 404, COLOR_TEXT_SECONDARY, TEXT_ALIGN_LEFT);
+    }
+
+    const char *hints[] = {"[UP/DN] Pick", "[START] Sync", "[B] Back"};
+    ui_draw_button_hints(r, font_body, hints, 3);
+}
+
+/* ============================================
+ * Static Helper Functions
+ * ============================================ */
+
+static double phase(double end, double start) {
+    return end > start ? end - start : 0;
+}
+
+static void format_clock(time_t when, char *buf, size_t size) {
+    struct tm tm;
+    if (when && localtime_r(&when, &tm)) {
+        strftime(buf, size, "%H:%M:%S", &tm);
+    } else {
+        snprintf(buf, size, "--:--:--");
+    }
+}
+
+/**
+ * Recent syncs, newest first
+ */
+static void draw_history(diagnostics_screen_t *screen, int count) {
+    SDL_Renderer *r = screen->renderer;
+    TTF_Font *font_body = fonts_get(screen->fonts, FONT_SIZE_BODY);
+    int list_y = 55;
+
+    for (int i = 0; i < HISTORY_VISIBLE && screen->scroll_offset + i < count; i++) {
+        int idx = screen->scroll_offset + i;
+        const sync_stats_t *stats = cache_manager_get_sync_stats(screen->cache_mgr, idx);
+        int y = list_y + i * HISTORY_ITEM_HEIGHT;
+        int is_selected = (idx == screen->selected_index);
+
+        if (is_selected) {
+            SDL_Rect bg = {20, y, 190, HISTORY_ITEM_HEIGHT - 2};
+            ui_draw_filled_rect(r, bg, COLOR_SELECTED);
+        }
+
+        SDL_Color text_color = is_selected ? COLOR_GB_DARKEST : COLOR_TEXT_PRIMARY;
+        char clock[16];
+        char took[24];
+        format_clock(stats->started, clock, sizeof(clock));
+        if (stats->success) {
+            snprintf(took, sizeof(took), "%.0f ms", stats->fetch_ms);
+        } else {
+            snprintf(took, sizeof(took), "failed");
+        }
+
+        ui_draw_text(r, font_body, clock, 28, y + 6, text_color, TEXT_ALIGN_LEFT);
+        ui_draw_text(r, font_body, took, 202, y + 6, text_color, TEXT_ALIGN_RIGHT);
+    }
+
+    if (count > HISTORY_VISIBLE) {
+        ui_draw_scrollbar(r, 216, list_y, HISTORY_VISIBLE * HISTORY_ITEM_HEIGHT,
+                          count, HISTORY_VISIBLE, screen->scroll_offset);
+    }
+}
+
+/**
+ * One line of the breakdown: label, duration and a bar scaled to the sync
+ */
+static void draw_phase(diagnostics_screen_t *screen, int y, const char *label,
+                       double ms, double scale_ms) {
+    SDL_Renderer *r = screen->renderer;
+    TTF_Font *font_body = fonts_get(screen->fonts, FONT_SIZE_BODY);
+
+    char value[24];
+    if (ms < 0) {
+        snprintf(value, sizeof(value), "...");
+    } else {
+        snprintf(value, sizeof(value), "%.1f ms", ms);
+    }
+
+    ui_draw_text(r, font_body, label, 240, y, COLOR_TEXT_SECONDARY, TEXT_ALIGN_LEFT);
+    ui_draw_text(r, font_body, value, 460, y, COLOR_TEXT_PRIMARY, TEXT_ALIGN_RIGHT);
+
+    if (ms > 0 && scale_ms > 0) {
+        int width = (int)(PHASE_BAR_WIDTH * ms / scale_ms);
+        SDL_Rect bar = {475, y + 3, width > 0 ? width : 1, 8};
+        ui_draw_filled_rect(r, bar, COLOR_ACCENT);
+    }
+}
+
+/**
+ * Phase breakdown of one sync
+ */
+static void draw_breakdown(diagnostics_screen_t *screen, const sync_stats_t *stats) {
+    SDL_Renderer *r = screen->renderer;
+    TTF_Font *font_body = fonts_get(screen->fonts, FONT_SIZE_BODY);
+
+    SDL_Rect panel = {225, 55, 395, 340};
+    ui_draw_bordered_rect(r, panel, COLOR_PANEL, COLOR_BORDER, 2);
+
+    const ha_timing_t *t = &stats->states;
+    double connected = t->tls_ms > 0 ? t->tls_ms : t->connect_ms;
+    double areas_ms = stats->areas.total_ms + stats->area_parse_ms;
+    double write_ms = stats->write_ms;
+    double scale = stats->fetch_ms + stats->apply_ms + (write_ms > 0 ? write_ms : 0);
+
+    char line[96];
+    char clock[16];
+    format_clock(stats->started, clock, sizeof(clock));
+    snprintf(line, sizeof(line), "%s  %s (HTTP %d)", clock, stats->success ? "OK" : "Failed",
+             stats->status_code);
+    ui_draw_text(r, font_body, line, 240, 65, COLOR_TEXT_PRIMARY, TEXT_ALIGN_LEFT);
+
+    int y = 92;
+    int step = 22;
+    draw_phase(screen, y, "DNS", t->dns_ms, scale);
+    draw_phase(screen, y += step, "Connect", phase(t->connect_ms, t->dns_ms), scale);
+    draw_phase(screen, y += step, "TLS", phase(t->tls_ms, t->connect_ms), scale);
+    draw_phase(screen, y += step, "First byte", phase(t->ttfb_ms, connected), scale);
+    draw_phase(screen, y += step, "Download", phase(t->total_ms, t->ttfb_ms), scale);
+    draw_phase(screen, y += step, "Parse", stats->parse_ms, scale);
+    draw_phase(screen, y += step, "Areas", areas_ms, scale);
+    draw_phase(screen, y += step, "Apply", stats->apply_ms, scale);
+    draw_phase(screen, y += step, "DB write", stats->success ? write_ms : 0, scale);
+    draw_phase(screen, y += step, "Fetch total", stats->fetch_ms, scale);
+
+    y += step + 8;
+    snprintf(line, sizeof(line), "%.1f KB received", stats->bytes / 1024.0);
+    ui_draw_text(r, font_body, line, 240, y, COLOR_TEXT_PRIMARY, TEXT_ALIGN_LEFT);
+    snprintf(line, sizeof(line), "%d entities, %d changed", stats->entity_count,
+             stats->changed_count);
+    ui_draw_text(r, font_body, line, 240, y + step, COLOR_TEXT_PRIMARY, TEXT_ALIGN_LEFT);
+}
@@ -0,0 +1,77 @@
+/**
+ * screen_diagnostics.h - Sync Diagnostics Screen
+ *
+ * Shows where recent syncs spent their time: DNS, connect, TLS, first
+ * byte and download from curl, JSON parsing, the area request, merging
+ * into the cache and the database write. Up/Down pick a sync from the
+ * history kept by the cache manager, newest first.
+ */
+
+#ifndef SCREEN_DIAGNOSTICS_H
+#define SCREEN_DIAGNOSTICS_H
+
+#include <SDL.h>
+#include "../ui/fonts.h"
+#include "../ui/icons.h"
+#include "../ui/components.h"
+#include "../cache_manager.h"
+
+/**
+ * Diagnostics screen state
+ */
+typedef struct {
+    // Dependencies
+    SDL_Renderer *renderer;
+    font_manager_t *fonts;
+    icon_manager_t *icons;
+    cache_manager_t *cache_mgr;
+
+    int selected_index;        // 0 = latest sync
+    int scroll_offset;
+} diagnostics_screen_t;
+
+/**
+ * Create diagnostics screen
+ *
+ * @param renderer SDL renderer
+ * @param fonts Font manager
+ * @param icons Icon manager
+ * @param cache_mgr Cache manager (keeps the sync history)
+ * @return diagnostics_screen_t pointer or NULL on failure
+ */
+diagnostics_screen_t* diagnostics_screen_create(SDL_Renderer *renderer,
+                                                 font_manager_t *fonts,
+                                                 icon_manager_t *icons,
+                                                 cache_manager_t *cache_mgr);
+
+/**
+ * Destroy diagnostics screen
+ *
+ * @param screen Diagnostics screen to destroy
+ */
+void diagnostics_screen_destroy(diagnostics_screen_t *screen);
+
+/**
+ * Select the latest sync (call when opening the screen)
+ *
+ * @param screen Diagnostics screen
+ */
+void diagnostics_screen_reset(diagnostics_screen_t *screen);
+
+/**
+ * Handle input for diagnostics screen
+ *
+ * @param screen Diagnostics screen
+ * @param event SDL event
+ * @return 0 to stay, -1 to go back
+ */
+int diagnostics_screen_handle_input(diagnostics_screen_t *screen, SDL_Event *event);
+
+/**
+ * Render diagnostics screen
+ *
+ * @param screen Diagnostics screen
+ */
+void diagnostics_screen_render(diagnostics_screen_t *screen);
+
+#endif // SCREEN_DIAGNOSTICS_H
@@ -15,6 +15,8 @@
 #include <time.h>
 
 static void parse_entity_info(info_screen_t *screen);
+static void on_cache_change(const entity_changes_t *changes, void *ctx);
+static void load_history(info_screen_t *screen);
 static void format_timestamp(const char *iso_time, char *output, size_t output_size);
 static const char* get_domain_display_name(const char *entity_id);
 
@@ -34,11 +36,16 @@ info_screen_t* info_screen_create(SDL_Renderer *renderer,
     screen->cache_mgr = cache_mgr;
     screen->client_ptr = client_ptr;
 
+    if (cache_mgr) {
+        cache_manager_subscribe(cache_mgr, on_cache_change, screen);
+    }
+
     return screen;
 }
 
 void info_screen_destroy(info_screen_t *screen) {
     if (!screen) return;
+    if (screen->cache_mgr) cache_manager_unsubscribe(screen->cache_mgr, on_cache_change, screen);
     if (screen->entity) free_entity(screen->entity);
     free(screen);
 }
@@ -52,9 +59,10 @@ int info_screen_set_entity(info_screen_t *screen, const char *entity_id) {
     }
 
     strncpy(screen->entity_id, entity_id, sizeof(screen->entity_id) - 1);
+    screen->icon = icons_get_for_domain(entity_id);
 
     if (screen->cache_mgr) {
-        screen->entity = cache_manager_get_entity(screen->cache_mgr, entity_id);
+        screen->entity = copy_entity(cache_manager_get_entity(screen->cache_mgr, entity_id));
     }
 
     if (!screen->entity) {
@@ -67,6 +75,7 @@ int info_screen_set_entity(info_screen_t *screen, const char *entity_id) {
     }
 
     parse_entity_info(screen);
+    load_history(screen);
     screen->status_message[0] = '\0';
     return 1;
 }
@@ -122,8 +131,7 @@ void info_screen_render(info_screen_t *screen) {
     ui_draw_text(r, font_header, name, 320, 90, COLOR_TEXT_PRIMARY, TEXT_ALIGN_CENTER);
 
     // Large icon
-    const char *icon_name = icons_get_for_domain(screen->entity->entity_id);
-    icons_draw(screen->icons, icon_name, 320 - 32, 120, 64);
+    icons_draw(screen->icons, screen->icon, 320 - 32, 120, 64);
 
     // Current state (large, prominent)
     char state_display[128];
@@ -145,12 +153,23 @@ void info_screen_render(info_screen_t *screen) {
     // Show some key attributes (simplified display)
     if (strlen(screen->description) > 0) {
         ui_draw_text_truncated(r, font_small, screen->description, 70, 288, 500, COLOR_TEXT_SECONDARY);
-    } else {
+    } else if (screen->history_count < 2) {
         ui_draw_text(r, font_small, "(Read-only entity)", 320, 300, COLOR_TEXT_SECONDARY, TEXT_ALIGN_CENTER);
     }
 
+    // 24h sparkline for numeric sensors
+    if (screen->history_count >= 2) {
+        char range_text[64];
+        snprintf(range_text, sizeof(range_text), "24h: %.4g - %.4g",
+                 screen->history_min, screen->history_max);
+        ui_draw_text(r, font_small, range_text, 570, 268, COLOR_TEXT_SECONDARY, TEXT_ALIGN_RIGHT);
+
+        SDL_Rect chart = {70, 308, 500, 44};
+        ui_draw_sparkline(r, chart, screen->history, screen->history_count, COLOR_TEXT_PRIMARY);
+    }
+
     // Favorite
-    icons_draw(screen->icons, screen->is_favorite ? "star_filled" : "star_empty", 60, 370, 16);
+    icons_draw(screen->icons, screen->is_favorite ? ICON_ID_STAR_FILLED : ICON_ID_STAR_EMPTY, 60, 370, 16);
     ui_draw_text(r, font_small, screen->is_favorite ? "Favorited" : "Add to Favorites", 80, 372, COLOR_TEXT_PRIMARY, TEXT_ALIGN_LEFT);
 
     // Entity ID
@@ -240,6 +259,47 @@ static void parse_entity_info(info_screen_t *screen) {
     }
 }
 
+static void load_history(info_screen_t *screen) {
+    screen->history_count = 0;
+    if (!screen->cache_mgr) return;
+
+    history_point_t points[INFO_HISTORY_POINTS];
+    time_t now = time(NULL);
+    int count = cache_manager_get_history(screen->cache_mgr, screen->entity_id,
+                                          now - INFO_HISTORY_SECONDS, now + 1,
+                                          points, INFO_HISTORY_POINTS);
+
+    for (int i = 0; i < count; i++) {
+        screen->history[i] = (float)points[i].value;
+        if (i == 0 || points[i].min_value < screen->history_min) {
+            screen->history_min = points[i].min_value;
+        }
+        if (i == 0 || points[i].max_value > screen->history_max) {
+            screen->history_max = points[i].max_value;
+        }
+    }
+
+    // The newest sample may still be queued on the database writer, so
+    // end the series on the state the screen shows
+    const char *state = screen->entity ? screen->entity->state : "";
+    char *end = NULL;
+    double current = strtod(state, &end);
+    if (end != state && *end == '\0' && current == current) {
+        if (count == INFO_HISTORY_POINTS) {
+            count--;   // The last span is the one "now" falls in
+        }
+        screen->history[count] = (float)current;
+        if (count == 0 || current < screen->history_min) {
+            screen->history_min = current;
+        }
+        if (count == 0 || current > screen->history_max) {
+            screen->history_max = current;
+        }
+        count++;
+    }
+    screen->history_count = count;
+}
+
 static void format_timestamp(const char *iso_time, char *output, size_t output_size) {
     if (!iso_time || strlen(iso_time) == 0) {
         snprintf(output, output_size, "Last changed: Unknown");
@@ -295,3 +355,27 @@ static const char* get_domain_display_name(const char *entity_id) {
 
     return "ENTITY INFO";
 }
+
+/**
+ * Cache change callback: pick up new state for the shown entity
+ */
+static void on_cache_change(const entity_changes_t *changes, void *ctx) {
+    info_screen_t *screen = ctx;
+    if (!screen->entity) return;
+
+    const entity_change_t *change = entity_changes_find(changes, screen->entity_id);
+    if (!change) return;
+
+    if (change->type == ENTITY_CHANGE_REMOVED) {
+        strcpy(screen->status_message, "Removed from Home Assistant");
+        return;
+    }
+
+    ha_entity_t *updated = copy_entity(cache_manager_get_entity(screen->cache_mgr, screen->entity_id));
+    if (updated) {
+        free_entity(screen->entity);
+        screen->entity = updated;
+        parse_entity_info(screen);
+        load_history(screen);
+    }
+}
@@ -17,6 +17,12 @@
 #include "../cache_manager.h"
 #include "../ha_client.h"
 
+/**
+ * History sparkline - time span shown and maximum points fetched
+ */
+#define INFO_HISTORY_SECONDS 86400
+#define INFO_HISTORY_POINTS 96
+
 /**
  * Info screen state
  */
@@ -31,6 +37,7 @@ typedef struct {
     // Current entity
     ha_entity_t *entity;
     char entity_id[128];
+    icon_id_t icon;          // Domain icon, resolved when the entity is set
 
     // Parsed info
     char description[512];
@@ -39,6 +46,12 @@ typedef struct {
     int is_enabled;
     int is_favorite;
 
+    // Recent history for numeric states (downsampled, oldest first)
+    float history[INFO_HISTORY_POINTS];
+    int history_count;
+    double history_min;
+    double history_max;
+
     // Status
     char status_message[128];
 } info_screen_t;
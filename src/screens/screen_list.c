@@ -34,12 +34,20 @@ static const char* DOMAIN_DISPLAY_NAMES[][2] = {
     {NULL, NULL}
 };
 
+/* List geometry */
+#define LIST_Y 95
+#define LIST_HEIGHT 340
+
 /* Forward declarations */
-static void load_entities_for_tab(list_screen_t *screen);
-static void populate_list_items(list_screen_t *screen);
-static int is_mvp_domain(const char *domain);
-static void build_domain_tabs(list_screen_t *screen, ha_entity_t **all_entities, int total_count);
-static void build_room_tabs(list_screen_t *screen, ha_entity_t **all_entities, int total_count);
+static void load_tab(list_screen_t *screen);
+static void select_rows(list_screen_t *screen);
+static void ensure_view(list_screen_t *screen);
+static void update_scroll(list_screen_t *screen);
+static void set_tab_filter(list_screen_t *screen);
+static int build_tabs(list_screen_t *screen, const char *keep_value);
+static void on_cache_change(const entity_changes_t *changes, void *ctx);
+static void build_domain_tabs(list_screen_t *screen);
+static void build_room_tabs(list_screen_t *screen, char **areas, int area_count);
 static const char* get_domain_display_name(const char *domain);
 static void format_area_display_name(const char *area_id, char *output, size_t output_size);
 
@@ -68,15 +76,8 @@ list_screen_t* list_screen_create(SDL_Renderer *renderer,
     screen->current_tab = 0;
     screen->tab_count = 0;
 
-    // Initialize list
-    screen->list_capacity = 512;
-    screen->list_items = calloc(screen->list_capacity, sizeof(list_item_t));
-    if (!screen->list_items) {
-        free(screen);
-        return NULL;
-    }
-
-    screen->entity_list.items = screen->list_items;
+    // Initialize list (rows come from the cache view)
+    screen->entity_list.items = NULL;
     screen->entity_list.item_count = 0;
     ui_list_init(&screen->entity_list, 40);
 
@@ -85,25 +86,30 @@ list_screen_t* list_screen_create(SDL_Renderer *renderer,
     // Load initial entities and build tabs
     list_screen_refresh(screen);
 
+    // Patch rows as the cache changes instead of reloading
+    if (cache_mgr) {
+        cache_manager_subscribe(cache_mgr, on_cache_change, screen);
+    }
+
     return screen;
 }
 
 void list_screen_destroy(list_screen_t *screen) {
     if (!screen) return;
 
-    if (screen->list_items) {
-        free(screen->list_items);
-    }
-    if (screen->entities) {
-        free_entities(screen->entities, screen->entity_count);
+    if (screen->cache_mgr) {
+        cache_manager_unsubscribe(screen->cache_mgr, on_cache_change, screen);
     }
-
+    free(screen->rows);
+    free(screen->row_icons);
     free(screen);
 }
 
 int list_screen_handle_input(list_screen_t *screen, SDL_Event *event) {
     if (!screen || !event || event->type != SDL_KEYDOWN) return 0;
 
+    ensure_view(screen);
+
     // View mode toggle (X button) - cycles Domain → Room → Favorites → Domain
     if (input_button_pressed(BTN_X)) {
         if (screen->view_mode == VIEW_BY_DOMAIN) {
@@ -127,10 +133,7 @@ int list_screen_handle_input(list_screen_t *screen, SDL_Event *event) {
         if (screen->tab_count > 0) {
             ui_tab_navigate(&screen->tabs, -1);
             screen->current_tab = screen->tabs.active_tab;
-            load_entities_for_tab(screen);
-            populate_list_items(screen);
-            screen->entity_list.selected_index = 0;
-            screen->entity_list.scroll_offset = 0;
+            load_tab(screen);
         }
         return 0;
     }
@@ -138,10 +141,7 @@ int list_screen_handle_input(list_screen_t *screen, SDL_Event *event) {
         if (screen->tab_count > 0) {
             ui_tab_navigate(&screen->tabs, 1);
             screen->current_tab = screen->tabs.active_tab;
-            load_entities_for_tab(screen);
-            populate_list_items(screen);
-            screen->entity_list.selected_index = 0;
-            screen->entity_list.scroll_offset = 0;
+            load_tab(screen);
         }
         return 0;
     }
@@ -149,10 +149,12 @@ int list_screen_handle_input(list_screen_t *screen, SDL_Event *event) {
     // List navigation
     if (input_button_pressed(BTN_DPAD_UP)) {
         ui_list_navigate(&screen->entity_list, -1);
+        update_scroll(screen);
         return 0;
     }
     if (input_button_pressed(BTN_DPAD_DOWN)) {
         ui_list_navigate(&screen->entity_list, 1);
+        update_scroll(screen);
         return 0;
     }
 
@@ -171,20 +173,30 @@ int list_screen_handle_input(list_screen_t *screen, SDL_Event *event) {
         return 1;
     }
 
+    // Open search
+    if (input_button_pressed(BTN_R2)) {
+        return 2;
+    }
+
+    // Open sync diagnostics
+    if (input_button_pressed(BTN_L2)) {
+        return 3;
+    }
+
     // Refresh
     if (input_button_pressed(BTN_START)) {
-        strcpy(screen->status_message, "Refreshing...");
         if (screen->cache_mgr) {
-            cache_manager_sync(screen->cache_mgr);
+            // Runs in the background; changed rows arrive through on_cache_change()
+            int result = cache_manager_request_sync(screen->cache_mgr);
+            strcpy(screen->status_message, result == 0 ? "Refresh requested" :
+                                           result > 0 ? "Refreshed" : "Refresh failed");
         }
-        list_screen_refresh(screen);
-        strcpy(screen->status_message, "Refreshed");
         return 0;
     }
 
     // Toggle favorite with Y
     if (input_button_pressed(BTN_Y)) {
-        ha_entity_t *entity = list_screen_get_selected_entity(screen);
+        const ha_entity_t *entity = list_screen_get_selected_entity(screen);
         if (entity && screen->cache_mgr) {
             int result = cache_manager_toggle_favorite(screen->cache_mgr, entity->entity_id);
             if (result == 1) {
@@ -207,6 +219,8 @@ int list_screen_handle_input(list_screen_t *screen, SDL_Event *event) {
 void list_screen_render(list_screen_t *screen) {
     if (!screen) return;
 
+    ensure_view(screen);
+
     SDL_Renderer *r = screen->renderer;
     TTF_Font *font_header = fonts_get(screen->fonts, FONT_SIZE_HEADER);
     TTF_Font *font_body = fonts_get(screen->fonts, FONT_SIZE_BODY);
@@ -226,6 +240,7 @@ void list_screen_render(list_screen_t *screen) {
         header_text = "FAVORITES";
     }
     int is_online = screen->cache_mgr ? cache_manager_is_online(screen->cache_mgr) : 0;
+    int syncing = screen->cache_mgr ? cache_manager_is_syncing(screen->cache_mgr) : 0;
     ui_draw_header(r, font_header, font_small, header_text, is_online);
 
     // Tab bar (if we have tabs - not in favorites mode)
@@ -240,22 +255,15 @@ void list_screen_render(list_screen_t *screen) {
 
     // Entity list
     if (screen->entity_list.item_count > 0) {
-        int list_y = 95;
-        int list_height = 340;
+        int list_y = LIST_Y;
+        int list_height = LIST_HEIGHT;
         int item_height = screen->entity_list.item_height;
         int visible = list_height / item_height;
 
-        // Adjust scroll
-        if (screen->entity_list.selected_index < screen->entity_list.scroll_offset) {
-            screen->entity_list.scroll_offset = screen->entity_list.selected_index;
-        }
-        if (screen->entity_list.selected_index >= screen->entity_list.scroll_offset + visible) {
-            screen->entity_list.scroll_offset = screen->entity_list.selected_index - visible + 1;
-        }
-
+        // Scroll offset is kept in range by update_scroll()
         for (int i = 0; i < visible && (i + screen->entity_list.scroll_offset) < screen->entity_list.item_count; i++) {
             int idx = i + screen->entity_list.scroll_offset;
-            list_item_t *item = &screen->list_items[idx];
+            const ha_entity_t *entity = screen->rows[idx];
             int y = list_y + (i * item_height);
 
             // Selection background
@@ -273,21 +281,26 @@ void list_screen_render(list_screen_t *screen) {
                 ui_draw_text(r, font_body, ">", 25, y + 10, text_color, TEXT_ALIGN_LEFT);
             }
 
-            // Icon
-            icons_draw(screen->icons, item->icon_name, 45, y + 8, 16);
+            // Icon based on domain
+            icons_draw(screen->icons, screen->row_icons[idx], 45, y + 8, 16);
 
-            // Name (truncated)
-            ui_draw_text_truncated(r, font_body, item->text, 70, y + 10, 400, text_color);
+            // Name (truncated), falling back to entity_id
+            const char *name = entity->friendly_name[0] ? entity->friendly_name : entity->entity_id;
+            ui_draw_text_truncated(r, font_body, name, 70, y + 10, 400, text_color);
 
-            // State
-            ui_draw_text(r, font_small, item->subtext, 600, y + 12, sub_color, TEXT_ALIGN_RIGHT);
+            // State ("..." while an action awaits the server)
+            if (screen->cache_mgr && cache_manager_is_pending(screen->cache_mgr, entity->entity_id)) {
+                char pending_state[72];
+                snprintf(pending_state, sizeof(pending_state), "%s...", entity->state);
+                ui_draw_text(r, font_small, pending_state, 600, y + 12, sub_color, TEXT_ALIGN_RIGHT);
+            } else {
+                ui_draw_text(r, font_small, entity->state, 600, y + 12, sub_color, TEXT_ALIGN_RIGHT);
+            }
 
             // Favorite indicator
-            if (screen->cache_mgr && item->user_data) {
-                ha_entity_t *entity = (ha_entity_t*)item->user_data;
-                if (cache_manager_is_favorite(screen->cache_mgr, entity->entity_id)) {
-                    icons_draw(screen->icons, "star_filled", 480, y + 10, 16);
-                }
+            if (screen->cache_mgr &&
+                cache_manager_is_favorite(screen->cache_mgr, entity->entity_id)) {
+                icons_draw(screen->icons, ICON_ID_STAR_FILLED, 480, y + 10, 16);
             }
         }
 
@@ -304,6 +317,10 @@ void list_screen_render(list_screen_t *screen) {
                         320, 200, COLOR_TEXT_SECONDARY, TEXT_ALIGN_CENTER);
             ui_draw_text(r, font_small, "Press Y on any entity to add",
                         320, 240, COLOR_TEXT_SECONDARY, TEXT_ALIGN_CENTER);
+        } else if (syncing) {
+            // First run: nothing cached yet, the initial sync fills the list
+            ui_draw_text(r, font_body, "Loading entities...",
+                        320, 200, COLOR_TEXT_SECONDARY, TEXT_ALIGN_CENTER);
         } else {
             ui_draw_text(r, font_body, "No entities found",
                         320, 200, COLOR_TEXT_SECONDARY, TEXT_ALIGN_CENTER);
@@ -312,10 +329,13 @@ void list_screen_render(list_screen_t *screen) {
         }
     }
 
-    // Status message
+    // Status message; otherwise say when cached rows are being refreshed
     if (strlen(screen->status_message) > 0) {
         ui_draw_text(r, font_small, screen->status_message,
                     320, 440, COLOR_TEXT_SECONDARY, TEXT_ALIGN_CENTER);
+    } else if (syncing) {
+        ui_draw_text(r, font_small, "Syncing...",
+                    320, 440, COLOR_TEXT_SECONDARY, TEXT_ALIGN_CENTER);
     }
 
     // Button hints
@@ -326,79 +346,53 @@ void list_screen_render(list_screen_t *screen) {
 void list_screen_refresh(list_screen_t *screen) {
     if (!screen || !screen->cache_mgr) return;
 
-    // Free old entities
-    if (screen->entities) {
-        free_entities(screen->entities, screen->entity_count);
-        screen->entities = NULL;
-        screen->entity_count = 0;
-    }
-
-    // Favorites mode - load directly from favorites
-    if (screen->view_mode == VIEW_FAVORITES) {
-        screen->tab_count = 0;  // No tabs in favorites mode
-        screen->tabs.tab_count = 0;
-        memset(screen->tabs.tabs, 0, sizeof(screen->tabs.tabs));
-        screen->entities = cache_manager_get_favorites(screen->cache_mgr, &screen->entity_count);
-        populate_list_items(screen);
-        screen->entity_list.selected_index = 0;
-        screen->entity_list.scroll_offset = 0;
-        return;
-    }
-
-    // Get all entities and build tabs based on view mode
-    int total_count = 0;
-    ha_entity_t **all_entities = cache_manager_get_entities(screen->cache_mgr, &total_count);
+    build_tabs(screen, NULL);
 
-    if (!all_entities || total_count == 0) {
-        screen->tab_count = 0;
+    if (screen->view_mode != VIEW_FAVORITES && screen->tab_count == 0) {
         screen->entity_list.item_count = 0;
+        screen->view_version = cache_manager_get_version(screen->cache_mgr);
         return;
     }
 
-    // Build tabs based on current view mode
-    if (screen->view_mode == VIEW_BY_DOMAIN) {
-        build_domain_tabs(screen, all_entities, total_count);
-    } else {
-        build_room_tabs(screen, all_entities, total_count);
-    }
-
-    // Free the full entity list (we'll load filtered ones below)
-    free_entities(all_entities, total_count);
+    // Select the current tab's rows (resets scroll position)
+    load_tab(screen);
+}
 
-    // Ensure current tab is valid
-    if (screen->current_tab >= screen->tab_count) {
-        screen->current_tab = 0;
-        screen->tabs.active_tab = 0;
+int list_screen_get_visible_ids(list_screen_t *screen, const char **ids, int max_ids) {
+    if (!screen || !ids) {
+        return 0;
     }
 
-    // Load entities for current tab
-    load_entities_for_tab(screen);
-    populate_list_items(screen);
+    ensure_view(screen);
+    const list_view_t *list = &screen->entity_list;
+    int visible = (list->item_height > 0) ? LIST_HEIGHT / list->item_height : 1;
 
-    // Reset scroll position
-    screen->entity_list.selected_index = 0;
-    screen->entity_list.scroll_offset = 0;
+    int n = 0;
+    for (int i = list->scroll_offset; i < list->item_count && n < visible && n < max_ids; i++) {
+        ids[n++] = screen->rows[i]->entity_id;
+    }
+    return n;
 }
 
-ha_entity_t* list_screen_get_selected_entity(list_screen_t *screen) {
-    if (!screen || screen->entity_list.item_count == 0) {
+const ha_entity_t* list_screen_get_selected_entity(list_screen_t *screen) {
+    if (!screen) {
         return NULL;
     }
 
-    int idx = screen->entity_list.selected_index;
-    if (idx >= 0 && idx < screen->entity_list.item_count) {
-        return (ha_entity_t*)screen->list_items[idx].user_data;
+    ensure_view(screen);
+    if (screen->entity_list.item_count == 0) {
+        return NULL;
     }
 
-    return NULL;
+    return screen->rows[screen->entity_list.selected_index];
 }
 
 int list_screen_toggle_selected(list_screen_t *screen) {
-    if (!screen || !screen->client_ptr || !*screen->client_ptr) {
+    if (!screen || !screen->cache_mgr) {
         return 0;
     }
 
-    ha_entity_t *entity = list_screen_get_selected_entity(screen);
+    const ha_entity_t *entity = list_screen_get_selected_entity(screen);
     if (!entity) return 0;
 
     // Determine domain and service
@@ -433,40 +427,15 @@ int list_screen_toggle_selected(list_screen_t *screen) {
         return 0;
     }
 
-    // Call service
-    ha_response_t *response = ha_client_call_service(
-        *screen->client_ptr, domain, service, entity->entity_id, NULL
-    );
-
-    int success = (response && response->success);
-    if (response) {
-        ha_response_free(response);
-    }
-
-    // Refresh entity after action
-    if (success && screen->cache_mgr) {
-        cache_manager_refresh_entity(screen->cache_mgr, entity->entity_id);
-        load_entities_for_tab(screen);
-        populate_list_items(screen);
-    }
-
-    return success;
+    // The row shows the predicted state at once; the answer arrives later
+    return cache_manager_call_service(screen->cache_mgr, domain, service,
+                                      entity->entity_id, NULL);
 }
 
 /* ============================================
  * Static Helper Functions
  * ============================================ */
 
-static int is_mvp_domain(const char *domain) {
-    if (!domain) return 0;
-    for (int i = 0; i < MVP_DOMAIN_COUNT; i++) {
-        if (strcmp(domain, MVP_DOMAINS[i]) == 0) {
-            return 1;
-        }
-    }
-    return 0;
-}
-
 static const char* get_domain_display_name(const char *domain) {
     for (int i = 0; DOMAIN_DISPLAY_NAMES[i][0] != NULL; i++) {
         if (strcmp(domain, DOMAIN_DISPLAY_NAMES[i][0]) == 0) {
@@ -500,26 +469,105 @@ static void format_area_display_name(const char *area_id, char *output, size_t o
     }
 }
 
-static void build_domain_tabs(list_screen_t *screen, ha_entity_t **all_entities, int total_count) {
-    // Clear tabs array first
-    memset(screen->tabs.tabs, 0, sizeof(screen->tabs.tabs));
+/**
+ * Build tabs from the domains/areas present in the cache.
+ * keep_value selects the tab to stay on; if it is NULL or gone, the
+ * current tab index is kept when still in range.
+ * Returns 1 if the tab kept its value.
+ */
+static int build_tabs(list_screen_t *screen, const char *keep_value) {
+    // Favorites mode - no tabs, one filtered list
+    if (screen->view_mode == VIEW_FAVORITES) {
+        screen->tab_count = 0;
+        screen->tabs.tab_count = 0;
+        memset(screen->tabs.tabs, 0, sizeof(screen->tabs.tabs));
+        return 1;
+    }
+
+    if (screen->view_mode == VIEW_BY_DOMAIN) {
+        build_domain_tabs(screen);
+    } else {
+        entity_filter_t mvp_only = {0};
+        mvp_only.domains = MVP_DOMAINS;
+        mvp_only.domain_count = MVP_DOMAIN_COUNT;
+
+        int area_count = 0;
+        char **areas = cache_manager_get_group_values(screen->cache_mgr, ENTITY_GROUP_AREA,
+                                                      &mvp_only, &area_count);
+        build_room_tabs(screen, areas, area_count);
 
-    // Find unique MVP domains that have entities
-    int found_domains[MVP_DOMAIN_COUNT] = {0};
+        for (int i = 0; i < area_count; i++) {
+            free(areas[i]);
+        }
+        free(areas);
+    }
 
-    for (int i = 0; i < total_count; i++) {
-        for (int d = 0; d < MVP_DOMAIN_COUNT; d++) {
-            if (strcmp(all_entities[i]->domain, MVP_DOMAINS[d]) == 0) {
-                found_domains[d] = 1;
+    int kept = 0;
+    if (keep_value) {
+        for (int i = 0; i < screen->tab_count; i++) {
+            if (strcmp(screen->tab_values[i], keep_value) == 0) {
+                screen->current_tab = i;
+                kept = 1;
                 break;
             }
         }
     }
 
-    // Build tabs for domains that have entities
+    // Ensure current tab is valid
+    if (screen->current_tab >= screen->tab_count) {
+        screen->current_tab = 0;
+    }
+    screen->tabs.active_tab = screen->current_tab;
+    return kept;
+}
+
+/**
+ * Cache change callback: patch the view instead of reloading it.
+ * State changes need nothing (rows are read live). When rows were added,
+ * removed or regrouped, tabs are rebuilt and the tab re-selected with the
+ * selection and scroll position kept.
+ */
+static void on_cache_change(const entity_changes_t *changes, void *ctx) {
+    list_screen_t *screen = ctx;
+    if (changes->rejected > 0) {
+        strcpy(screen->status_message, "Action failed");
+    }
+    if (!changes->layout) return;
+
+    char current[64] = "";
+    int had_tab = screen->current_tab < screen->tab_count;
+    if (had_tab) {
+        strncpy(current, screen->tab_values[screen->current_tab], sizeof(current) - 1);
+    }
+
+    int kept = build_tabs(screen, had_tab ? current : NULL);
+
+    if (screen->view_mode != VIEW_FAVORITES && screen->tab_count == 0) {
+        screen->entity_list.item_count = 0;
+        screen->view_version = cache_manager_get_version(screen->cache_mgr);
+        return;
+    }
+
+    if (screen->view_mode == VIEW_FAVORITES || kept) {
+        set_tab_filter(screen);
+        select_rows(screen);
+    } else {
+        // The tab itself disappeared
+        load_tab(screen);
+    }
+}
+
+static void build_domain_tabs(list_screen_t *screen) {
+    // Clear tabs array first
+    memset(screen->tabs.tabs, 0, sizeof(screen->tabs.tabs));
+
+    // Tabs follow MVP_DOMAINS order, for domains that have entities
+    // (each count is a lookup in the cache's domain index)
     screen->tab_count = 0;
     for (int d = 0; d < MVP_DOMAIN_COUNT && screen->tab_count < MAX_TABS; d++) {
-        if (found_domains[d]) {
+        entity_filter_t domain = {ENTITY_GROUP_DOMAIN, MVP_DOMAINS[d], NULL, 0};
+
+        if (cache_manager_count_entities(screen->cache_mgr, &domain) > 0) {
             strncpy(screen->tab_values[screen->tab_count], MVP_DOMAINS[d], 63);
             const char *display = get_domain_display_name(MVP_DOMAINS[d]);
             strncpy(screen->tab_names[screen->tab_count], display, 31);
@@ -531,58 +579,26 @@ static void build_domain_tabs(list_screen_t *screen, ha_entity_t **all_entities,
     screen->tabs.tab_count = screen->tab_count;
 }
 
-static void build_room_tabs(list_screen_t *screen, ha_entity_t **all_entities, int total_count) {
+static void build_room_tabs(list_screen_t *screen, char **areas, int area_count) {
     // Clear tabs array first
     memset(screen->tabs.tabs, 0, sizeof(screen->tabs.tabs));
 
-    // Find unique area_ids from MVP-domain entities
-    char unique_areas[MAX_TABS][64];
-    int area_count = 0;
-    int has_unassigned = 0;
-
-    for (int i = 0; i < total_count; i++) {
-        // Only consider MVP domains
-        if (!is_mvp_domain(all_entities[i]->domain)) {
-            continue;
-        }
-
-        const char *area = all_entities[i]->area_id;
-
-        // Handle unassigned entities
-        if (!area || strlen(area) == 0) {
-            has_unassigned = 1;
-            continue;
-        }
-
-        // Check if already in list
-        int found = 0;
-        for (int a = 0; a < area_count; a++) {
-            if (strcmp(unique_areas[a], area) == 0) {
-                found = 1;
-                break;
-            }
-        }
-
-        if (!found && area_count < MAX_TABS - 1) {
-            strncpy(unique_areas[area_count], area, 63);
-            area_count++;
-        }
-    }
-
-    // Build tabs - unassigned first if present
     screen->tab_count = 0;
 
-    if (has_unassigned && screen->tab_count < MAX_TABS) {
+    // Unassigned first if present (areas are sorted, so "" leads)
+    if (area_count > 0 && areas[0][0] == '\0') {
         strcpy(screen->tab_values[screen->tab_count], "");
         strcpy(screen->tab_names[screen->tab_count], "UNASSIGNED");
         screen->tabs.tabs[screen->tab_count] = screen->tab_names[screen->tab_count];
         screen->tab_count++;
     }
 
-    // Then add sorted areas (we'll just add in order found for simplicity)
+    // Then the named areas, already sorted by the query
     for (int a = 0; a < area_count && screen->tab_count < MAX_TABS; a++) {
-        strncpy(screen->tab_values[screen->tab_count], unique_areas[a], 63);
-        format_area_display_name(unique_areas[a], screen->tab_names[screen->tab_count], 32);
+        if (areas[a][0] == '\0') continue;
+        strncpy(screen->tab_values[screen->tab_count], areas[a], 63);
+        screen->tab_values[screen->tab_count][63] = '\0';
+        format_area_display_name(areas[a], screen->tab_names[screen->tab_count], 32);
         screen->tabs.tabs[screen->tab_count] = screen->tab_names[screen->tab_count];
         screen->tab_count++;
     }
@@ -590,104 +606,139 @@ static void build_room_tabs(list_screen_t *screen, ha_entity_t **all_entities, i
     screen->tabs.tab_count = screen->tab_count;
 }
 
-static void load_entities_for_tab(list_screen_t *screen) {
-    if (!screen || !screen->cache_mgr || screen->tab_count == 0) {
-        screen->entity_count = 0;
-        return;
-    }
-
-    // Free old entities
-    if (screen->entities) {
-        free_entities(screen->entities, screen->entity_count);
-        screen->entities = NULL;
-        screen->entity_count = 0;
-    }
+/* ============================================
+ * Row View
+ * ============================================ */
 
-    // Get all entities
-    int total_count = 0;
-    ha_entity_t **all_entities = cache_manager_get_entities(screen->cache_mgr, &total_count);
+static void set_tab_filter(list_screen_t *screen) {
+    entity_filter_t *filter = &screen->filter;
+    memset(filter, 0, sizeof(*filter));
 
-    if (!all_entities || total_count == 0) {
+    if (screen->view_mode == VIEW_FAVORITES) {
+        filter->group = ENTITY_GROUP_FAVORITES;
         return;
     }
 
-    // Allocate for filtered entities
-    screen->entities = calloc(total_count, sizeof(ha_entity_t*));
-    screen->entity_count = 0;
-
     // Safety check: ensure current_tab is valid
     if (screen->current_tab < 0 || screen->current_tab >= screen->tab_count) {
         screen->current_tab = 0;
     }
 
-    const char *filter_value = (screen->tab_count > 0) ? screen->tab_values[screen->current_tab] : NULL;
+    filter->value = screen->tab_values[screen->current_tab];
+    if (screen->view_mode == VIEW_BY_DOMAIN) {
+        // Domain tabs are MVP domains already: the tab is its index bucket as is
+        filter->group = ENTITY_GROUP_DOMAIN;
+        return;
+    }
 
-    for (int i = 0; i < total_count; i++) {
-        ha_entity_t *e = all_entities[i];
-        int match = 0;
+    filter->group = ENTITY_GROUP_AREA;
+    filter->domains = MVP_DOMAINS;
+    filter->domain_count = MVP_DOMAIN_COUNT;
+}
 
-        // Only consider MVP domains
-        if (!is_mvp_domain(e->domain)) {
-            continue;
-        }
+/**
+ * Keep the selection in range and on screen, and remember which entity
+ * it is on
+ */
+static void update_scroll(list_screen_t *screen) {
+    list_view_t *list = &screen->entity_list;
+    int visible = (list->item_height > 0) ? LIST_HEIGHT / list->item_height : 1;
 
-        if (screen->view_mode == VIEW_BY_DOMAIN) {
-            // Match by domain
-            match = (filter_value && strcmp(e->domain, filter_value) == 0);
-        } else {
-            // Match by area_id
-            if (!filter_value || strlen(filter_value) == 0) {
-                // Unassigned tab - match entities with empty area_id
-                match = (strlen(e->area_id) == 0);
-            } else {
-                match = (strcmp(e->area_id, filter_value) == 0);
-            }
-        }
+    if (list->selected_index >= list->item_count) {
+        list->selected_index = list->item_count > 0 ? list->item_count - 1 : 0;
+    }
+    if (list->scroll_offset > list->selected_index) {
+        list->scroll_offset = list->selected_index;
+    }
+    if (list->selected_index >= list->scroll_offset + visible) {
+        list->scroll_offset = list->selected_index - visible + 1;
+    }
+    if (list->scroll_offset < 0) {
+        list->scroll_offset = 0;
+    }
 
-        if (match) {
-            screen->entities[screen->entity_count++] = e;
-            all_entities[i] = NULL;  // Don't free this one
-        }
+    if (list->item_count > 0) {
+        snprintf(screen->selected_id, sizeof(screen->selected_id), "%s",
+                 screen->rows[list->selected_index]->entity_id);
+    } else {
+        screen->selected_id[0] = '\0';
     }
+}
 
-    // Free entities we didn't keep
-    for (int i = 0; i < total_count; i++) {
-        if (all_entities[i]) {
-            free_entity(all_entities[i]);
+/**
+ * Select the current filter's rows from the cache into the view.
+ * The selected entity keeps its place on screen if it is still listed.
+ */
+static void select_rows(list_screen_t *screen) {
+    list_view_t *list = &screen->entity_list;
+    int screen_row = list->selected_index - list->scroll_offset;
+
+    screen->view_version = cache_manager_get_version(screen->cache_mgr);
+
+    int total = cache_manager_select(screen->cache_mgr, &screen->filter,
+                                     screen->rows, screen->row_capacity);
+    if (total > screen->row_capacity) {
+        const ha_entity_t **grown = realloc(screen->rows, total * sizeof(ha_entity_t *));
+        if (grown) {
+            screen->rows = grown;
+        }
+        icon_id_t *grown_icons = grown ? realloc(screen->row_icons, total * sizeof(icon_id_t)) :
+                                         NULL;
+        if (grown_icons) {
+            screen->row_icons = grown_icons;
+            screen->row_capacity = total;
+            cache_manager_select(screen->cache_mgr, &screen->filter, screen->rows, total);
+        } else {
+            total = screen->row_capacity;
         }
     }
-    free(all_entities);
-}
 
-static void populate_list_items(list_screen_t *screen) {
-    if (!screen) return;
+    list->item_count = total;
 
-    int count = screen->entity_count;
-    if (count > screen->list_capacity) {
-        count = screen->list_capacity;
+    // Icons are looked up here, not per row per frame
+    for (int i = 0; i < total; i++) {
+        screen->row_icons[i] = icons_get_for_domain(screen->rows[i]->entity_id);
     }
 
-    for (int i = 0; i < count; i++) {
-        ha_entity_t *entity = screen->entities[i];
-
-        // Use friendly name if available, otherwise entity_id
-        if (strlen(entity->friendly_name) > 0) {
-            strncpy(screen->list_items[i].text, entity->friendly_name, 127);
-        } else {
-            strncpy(screen->list_items[i].text, entity->entity_id, 127);
+    // Old row pointers may be gone; find the selection by ID
+    if (screen->selected_id[0]) {
+        for (int i = 0; i < total; i++) {
+            if (strcmp(screen->rows[i]->entity_id, screen->selected_id) == 0) {
+                list->selected_index = i;
+                list->scroll_offset = i - screen_row;
+                break;
+            }
         }
+    }
 
-        // State as subtext
-        strncpy(screen->list_items[i].subtext, entity->state, 63);
+    update_scroll(screen);
+}
 
-        // Icon based on domain
-        const char *icon = icons_get_for_domain(entity->entity_id);
-        strncpy(screen->list_items[i].icon_name, icon, 31);
+/**
+ * Re-select if entities were added, removed or reordered since the view
+ * was taken. State changes need nothing: rows are read live.
+ */
+static void ensure_view(list_screen_t *screen) {
+    if (!screen->cache_mgr) return;
+    if (screen->view_mode != VIEW_FAVORITES && screen->tab_count == 0) return;
 
-        // Store entity pointer for later use
-        screen->list_items[i].user_data = entity;
+    if (screen->view_version != cache_manager_get_version(screen->cache_mgr)) {
+        select_rows(screen);
     }
+}
+
+/**
+ * Switch to the current tab and select its rows
+ */
+static void load_tab(list_screen_t *screen) {
+    screen->selected_id[0] = '\0';
+    screen->entity_list.selected_index = 0;
+    screen->entity_list.scroll_offset = 0;
+    screen->entity_list.item_count = 0;
+
+    if (!screen->cache_mgr) return;
+    if (screen->view_mode != VIEW_FAVORITES && screen->tab_count == 0) return;
 
-    screen->entity_list.item_count = count;
-    screen->entity_list.items = screen->list_items;
+    set_tab_filter(screen);
+    select_rows(screen);
 }
@@ -58,14 +58,16 @@ typedef struct {
     char tab_values[MAX_TABS][64];     // Domain or area_id for each tab
     int tab_count;
 
-    // List state per tab
+    // List state per tab (rows are drawn straight from the view)
     list_view_t entity_list;
-    list_item_t *list_items;
-    int list_capacity;
 
-    // Cached entity data
-    ha_entity_t **entities;
-    int entity_count;
+    // Borrowed view of the current tab; rows are owned by the cache
+    entity_filter_t filter;
+    const ha_entity_t **rows;
+    icon_id_t *row_icons;          // Domain icon per row, resolved when selected
+    int row_capacity;
+    unsigned int view_version;     // Cache version the rows were selected at
+    char selected_id[128];         // Selected entity, kept across re-selects
 
     // Status
     char status_message[128];
@@ -100,7 +102,8 @@ void list_screen_destroy(list_screen_t *screen);
  *
  * @param screen List screen
  * @param event SDL event
- * @return 0 to stay, 1 to go to detail, -1 to go back to setup
+ * @return 0 to stay, 1 to go to detail, 2 to open search, 3 to open sync diagnostics,
+ *         -1 to go back to setup
  */
 int list_screen_handle_input(list_screen_t *screen, SDL_Event *event);
 
@@ -112,7 +115,8 @@ int list_screen_handle_input(list_screen_t *screen, SDL_Event *event);
 void list_screen_render(list_screen_t *screen);
 
 /**
- * Refresh entity list for current tab
+ * Rebuild tabs and reload the current tab from the top
+ * Cache changes are applied without this (the screen subscribes to them).
  *
  * @param screen List screen
  */
@@ -120,17 +124,30 @@ void list_screen_refresh(list_screen_t *screen);
 
 /**
  * Get currently selected entity
+ * The pointer is borrowed from the cache; copy it to keep it past a sync.
  *
  * @param screen List screen
- * @return ha_entity_t pointer or NULL
+ * @return Entity pointer or NULL
  */
-ha_entity_t* list_screen_get_selected_entity(list_screen_t *screen);
+const ha_entity_t* list_screen_get_selected_entity(list_screen_t *screen);
+
+/**
+ * Get the IDs of the rows currently on screen, top to bottom
+ * The strings are borrowed from the cache and valid until the next sync.
+ *
+ * @param screen List screen
+ * @param ids Output: entity IDs
+ * @param max_ids Capacity of ids
+ * @return Number of IDs written
+ */
+int list_screen_get_visible_ids(list_screen_t *screen, const char **ids, int max_ids);
 
 /**
  * Toggle/activate the selected entity
+ * The row shows the predicted state immediately (see cache_manager_call_service).
  *
  * @param screen List screen
- * @return 1 on success, 0 on failure
+ * @return 1 if sent, 0 on failure
  */
 int list_screen_toggle_selected(list_screen_t *screen);
 
@@ -10,6 +10,7 @@
 #include <time.h>
 
 static void parse_scene_info(scene_screen_t *screen);
+static void on_cache_change(const entity_changes_t *changes, void *ctx);
 static void format_timestamp(const char *iso_time, char *output, size_t output_size, const char *prefix);
 static int activate_scene(scene_screen_t *screen);
 
@@ -29,11 +30,16 @@ scene_screen_t* scene_screen_create(SDL_Renderer *renderer,
     screen->cache_mgr = cache_mgr;
     screen->client_ptr = client_ptr;
 
+    if (cache_mgr) {
+        cache_manager_subscribe(cache_mgr, on_cache_change, screen);
+    }
+
     return screen;
 }
 
 void scene_screen_destroy(scene_screen_t *screen) {
     if (!screen) return;
+    if (screen->cache_mgr) cache_manager_unsubscribe(screen->cache_mgr, on_cache_change, screen);
     if (screen->entity) free_entity(screen->entity);
     free(screen);
 }
@@ -49,7 +55,7 @@ int scene_screen_set_entity(scene_screen_t *screen, const char *entity_id) {
     strncpy(screen->entity_id, entity_id, sizeof(screen->entity_id) - 1);
 
     if (screen->cache_mgr) {
-        screen->entity = cache_manager_get_entity(screen->cache_mgr, entity_id);
+        screen->entity = copy_entity(cache_manager_get_entity(screen->cache_mgr, entity_id));
     }
 
     if (!screen->entity) {
@@ -123,7 +129,7 @@ void scene_screen_render(scene_screen_t *screen) {
     ui_draw_text(r, font_header, name, 320, 90, COLOR_TEXT_PRIMARY, TEXT_ALIGN_CENTER);
 
     // Icon
-    icons_draw(screen->icons, "scene_stars", 320 - 32, 130, 64);
+    icons_draw(screen->icons, ICON_ID_SCENE_STARS, 320 - 32, 130, 64);
 
     // Last activated
     ui_draw_text(r, font_small, screen->last_activated, 320, 220, COLOR_TEXT_SECONDARY, TEXT_ALIGN_CENTER);
@@ -141,7 +147,7 @@ void scene_screen_render(scene_screen_t *screen) {
     ui_draw_text(r, font_header, "[A] ACTIVATE", 320, 305, COLOR_GB_DARKEST, TEXT_ALIGN_CENTER);
 
     // Favorite
-    icons_draw(screen->icons, screen->is_favorite ? "star_filled" : "star_empty", 60, 360, 16);
+    icons_draw(screen->icons, screen->is_favorite ? ICON_ID_STAR_FILLED : ICON_ID_STAR_EMPTY, 60, 360, 16);
     ui_draw_text(r, font_small, screen->is_favorite ? "Favorited" : "Add to Favorites", 80, 362, COLOR_TEXT_PRIMARY, TEXT_ALIGN_LEFT);
 
     // Entity ID
@@ -211,13 +217,36 @@ static void format_timestamp(const char *iso_time, char *output, size_t output_s
 }
 
 static int activate_scene(scene_screen_t *screen) {
-    if (!screen || !screen->client_ptr || !*screen->client_ptr || !screen->entity) return 0;
+    if (!screen || !screen->cache_mgr || !screen->entity) return 0;
+
+    // The lights and switches the scene sets come back in one batch
+    return cache_manager_call_service(screen->cache_mgr, "scene", "turn_on",
+                                      screen->entity->entity_id, NULL);
+}
+
+/**
+ * Cache change callback: pick up new state for the shown scene
+ */
+static void on_cache_change(const entity_changes_t *changes, void *ctx) {
+    scene_screen_t *screen = ctx;
+    if (!screen->entity) return;
 
-    ha_response_t *response = ha_client_call_service(
-        *screen->client_ptr, "scene", "turn_on", screen->entity->entity_id, NULL
-    );
+    const entity_change_t *change = entity_changes_find(changes, screen->entity_id);
+    if (!change) return;
 
-    int success = (response && response->success);
-    if (response) ha_response_free(response);
-    return success;
+    if (change->type == ENTITY_CHANGE_REMOVED) {
+        strcpy(screen->status_message, "Removed from Home Assistant");
+        return;
+    }
+    if (change->type == ENTITY_CHANGE_REJECTED) {
+        strcpy(screen->status_message, "Activation failed");
+        return;
+    }
+
+    ha_entity_t *updated = copy_entity(cache_manager_get_entity(screen->cache_mgr, screen->entity_id));
+    if (updated) {
+        free_entity(screen->entity);
+        screen->entity = updated;
+        parse_scene_info(screen);
+    }
 }
@@ -0,0 +1,255 @@
+/**
+ * screen_search.c - Entity Search Screen Implementation
+ */
+
+#include "screen_search.h"
+#include "../utils/input.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Characters offered by the picker (space separates words) */
+static const char PICKER_CHARS[] = "abcdefghijklmnopqrstuvwxyz0123456789 ._";
+#define PICKER_COUNT ((int)sizeof(PICKER_CHARS) - 1)
+#define PICKER_VISIBLE 15
+
+static void run_query(search_screen_t *screen);
+static void on_cache_change(const entity_changes_t *changes, void *ctx);
+
+search_screen_t* search_screen_create(SDL_Renderer *renderer,
+                                       font_manager_t *fonts,
+                                       icon_manager_t *icons,
+                                       cache_manager_t *cache_mgr) {
+    if (!renderer || !fonts || !icons) {
+        return NULL;
+    }
+
+    search_screen_t *screen = calloc(1, sizeof(search_screen_t));
+    if (!screen) {
+        return NULL;
+    }
+
+    screen->renderer = renderer;
+    screen->fonts = fonts;
+    screen->icons = icons;
+    screen->cache_mgr = cache_mgr;
+
+    search_screen_reset(screen);
+
+    // Names and IDs only change with the layout; re-run the query then
+    if (cache_mgr) {
+        cache_manager_subscribe(cache_mgr, on_cache_change, screen);
+    }
+
+    return screen;
+}
+
+void search_screen_destroy(search_screen_t *screen) {
+    if (screen && screen->cache_mgr) {
+        cache_manager_unsubscribe(screen->cache_mgr, on_cache_change, screen);
+    }
+    free(screen);
+}
+
+void search_screen_reset(search_screen_t *screen) {
+    if (!screen) return;
+
+    screen->text[0] = '\0';
+    screen->text_len = 0;
+    screen->result_count = 0;
+    screen->selected_index = 0;
+    search_query_reset(&screen->query);
+}
+
+void search_screen_refresh(search_screen_t *screen) {
+    if (!screen) return;
+    run_query(screen);
+}
+
+/**
+ * Cache change callback: results are copies, so only a rebuilt index
+ * (rows added, removed or renamed) can make them stale
+ */
+static void on_cache_change(const entity_changes_t *changes, void *ctx) {
+    search_screen_t *screen = ctx;
+    if (!changes->layout) return;
+
+    char selected[128] = "";
+    if (screen->selected_index < screen->result_count) {
+        strncpy(selected, screen->results[screen->selected_index].entity_id, sizeof(selected) - 1);
+    }
+
+    run_query(screen);
+
+    // Keep the cursor on the same entity if it is still a hit
+    for (int i = 0; selected[0] && i < screen->result_count; i++) {
+        if (strcmp(screen->results[i].entity_id, selected) == 0) {
+            screen->selected_index = i;
+            break;
+        }
+    }
+}
+
+int search_screen_handle_input(search_screen_t *screen, SDL_Event *event) {
+    if (!screen || !event || event->type != SDL_KEYDOWN) return 0;
+
+    // Character picker
+    if (input_button_pressed(BTN_DPAD_LEFT)) {
+        screen->picker_index = (screen->picker_index + PICKER_COUNT - 1) % PICKER_COUNT;
+        return 0;
+    }
+    if (input_button_pressed(BTN_DPAD_RIGHT)) {
+        screen->picker_index = (screen->picker_index + 1) % PICKER_COUNT;
+        return 0;
+    }
+
+    // Add character
+    if (input_button_pressed(BTN_A)) {
+        if (screen->text_len < SEARCH_MAX_QUERY - 1) {
+            screen->text[screen->text_len++] = PICKER_CHARS[screen->picker_index];
+            screen->text[screen->text_len] = '\0';
+            run_query(screen);
+        }
+        return 0;
+    }
+
+    // Delete character
+    if (input_button_pressed(BTN_X)) {
+        if (screen->text_len > 0) {
+            screen->text[--screen->text_len] = '\0';
+            run_query(screen);
+        }
+        return 0;
+    }
+
+    // Result navigation
+    if (input_button_pressed(BTN_DPAD_UP)) {
+        if (screen->selected_index > 0) screen->selected_index--;
+        return 0;
+    }
+    if (input_button_pressed(BTN_DPAD_DOWN)) {
+        if (screen->selected_index < screen->result_count - 1) screen->selected_index++;
+        return 0;
+    }
+
+    // Open selected match
+    if (input_button_pressed(BTN_SELECT) || input_button_pressed(BTN_START)) {
+        return search_screen_get_selected_entity_id(screen) ? 1 : 0;
+    }
+
+    if (input_button_pressed(BTN_B)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+void search_screen_render(search_screen_t *screen) {
+    if (!screen) return;
+
+    SDL_Renderer *r = screen->renderer;
+    TTF_Font *font_header = fonts_get(screen->fonts, FONT_SIZE_HEADER);
+    TTF_Font *font_body = fonts_get(screen->fonts, FONT_SIZE_BODY);
+    TTF_Font *font_small = fonts_get(screen->fonts, FONT_SIZE_SMALL);
+
+    set_render_color(r, COLOR_BACKGROUND);
+    SDL_RenderClear(r);
+
+    int is_online = screen->cache_mgr ? cache_manager_is_online(screen->cache_mgr) : 0;
+    ui_draw_header(r, font_header, font_small, "SEARCH", is_online);
+
+    // Query box
+    SDL_Rect box = {20, 55, 600, 32};
+    ui_draw_bordered_rect(r, box, COLOR_PANEL, COLOR_BORDER, 2);
+    char shown[SEARCH_MAX_QUERY + 2];
+    snprintf(shown, sizeof(shown), "%s_", screen->text);
+    ui_draw_text_truncated(r, font_body, shown, 30, 64, 580, COLOR_TEXT_PRIMARY);
+
+    // Character picker, centred on the selected character
+    int cell = 36;
+    int picker_x = 320 - (PICKER_VISIBLE / 2) * cell - cell / 2;
+    for (int i = 0; i < PICKER_VISIBLE; i++) {
+        int idx = (screen->picker_index - PICKER_VISIBLE / 2 + i + PICKER_COUNT) % PICKER_COUNT;
+        int x = picker_x + i * cell;
+        int is_selected = (i == PICKER_VISIBLE / 2);
+
+        if (is_selected) {
+            SDL_Rect sel = {x, 96, cell - 2, 28};
+            ui_draw_filled_rect(r, sel, COLOR_SELECTED);
+        }
+
+        char label[4];
+        if (PICKER_CHARS[idx] == ' ') {
+            strcpy(label, "SP");
+        } else {
+            label[0] = PICKER_CHARS[idx];
+            label[1] = '\0';
+        }
+        ui_draw_text(r, is_selected ? font_body : font_small, label, x + cell / 2, 104,
+                     is_selected ? COLOR_GB_DARKEST : COLOR_TEXT_SECONDARY, TEXT_ALIGN_CENTER);
+    }
+
+    // Results
+    int list_y = 136;
+    int item_height = 36;
+    if (screen->result_count == 0) {
+        const char *msg = screen->text_len > 0 ? "No matches" : "Type a name or entity ID";
+        ui_draw_text(r, font_body, msg, 320, 240, COLOR_TEXT_SECONDARY, TEXT_ALIGN_CENTER);
+    }
+
+    for (int i = 0; i < screen->result_count; i++) {
+        search_result_t *res = &screen->results[i];
+        int y = list_y + i * item_height;
+        int is_selected = (i == screen->selected_index);
+
+        if (is_selected) {
+            SDL_Rect bg = {20, y, 600, item_height - 2};
+            ui_draw_filled_rect(r, bg, COLOR_SELECTED);
+        }
+
+        SDL_Color text_color = is_selected ? COLOR_GB_DARKEST : COLOR_TEXT_PRIMARY;
+        SDL_Color sub_color = is_selected ? COLOR_GB_DARK : COLOR_TEXT_SECONDARY;
+
+        icons_draw(screen->icons, screen->result_icons[i], 30, y + 8, 16);
+
+        const char *name = strlen(res->friendly_name) > 0 ? res->friendly_name : res->entity_id;
+        ui_draw_text_truncated(r, font_body, name, 55, y + 4, 550, text_color);
+        ui_draw_text_truncated(r, font_small, res->entity_id, 55, y + 22, 550, sub_color);
+    }
+
+    const char *hints[] = {"[A] Add", "[X] Del", "[SEL] Open", "[B] Back"};
+    ui_draw_button_hints(r, font_body, hints, 4);
+}
+
+const char* search_screen_get_selected_entity_id(search_screen_t *screen) {
+    if (!screen || screen->selected_index < 0 ||
+        screen->selected_index >= screen->result_count) {
+        return NULL;
+    }
+
+    return screen->results[screen->selected_index].entity_id;
+}
+
+/* ============================================
+ * Static Helper Functions
+ * ============================================ */
+
+static void run_query(search_screen_t *screen) {
+    screen->result_count = 0;
+    screen->selected_index = 0;
+
+    if (screen->text_len == 0) {
+        search_query_reset(&screen->query);
+        return;
+    }
+
+    if (screen->cache_mgr) {
+        screen->result_count = cache_manager_search(screen->cache_mgr, &screen->query,
+                                                    screen->text, screen->results,
+                                                    SEARCH_MAX_RESULTS);
+    }
+
+    for (int i = 0; i < screen->result_count; i++) {
+        screen->result_icons[i] = icons_get_for_domain(screen->results[i].entity_id);
+    }
+}
@@ -0,0 +1,106 @@
+/**
+ * screen_search.h - Entity Search Screen
+ *
+ * Find an entity by typing part of its name or ID with the D-pad.
+ * Left/Right pick a character, A adds it, X deletes one, Up/Down move
+ * through the matches. Results update on every keystroke from the
+ * cache manager's in-memory search index.
+ */
+
+#ifndef SCREEN_SEARCH_H
+#define SCREEN_SEARCH_H
+
+#include <SDL.h>
+#include "../ui/fonts.h"
+#include "../ui/icons.h"
+#include "../ui/components.h"
+#include "../cache_manager.h"
+
+/**
+ * Number of matches shown
+ */
+#define SEARCH_MAX_RESULTS 8
+
+/**
+ * Search screen state
+ */
+typedef struct {
+    // Dependencies
+    SDL_Renderer *renderer;
+    font_manager_t *fonts;
+    icon_manager_t *icons;
+    cache_manager_t *cache_mgr;
+
+    // Query being typed
+    char text[SEARCH_MAX_QUERY];
+    int text_len;
+    int picker_index;          // Selected character in the picker
+    search_query_t query;
+
+    // Matches
+    search_result_t results[SEARCH_MAX_RESULTS];
+    icon_id_t result_icons[SEARCH_MAX_RESULTS]; // Resolved with the results
+    int result_count;
+    int selected_index;
+} search_screen_t;
+
+/**
+ * Create search screen
+ *
+ * @param renderer SDL renderer
+ * @param fonts Font manager
+ * @param icons Icon manager
+ * @param cache_mgr Cache manager (owns the search index)
+ * @return search_screen_t pointer or NULL on failure
+ */
+search_screen_t* search_screen_create(SDL_Renderer *renderer,
+                                       font_manager_t *fonts,
+                                       icon_manager_t *icons,
+                                       cache_manager_t *cache_mgr);
+
+/**
+ * Destroy search screen
+ *
+ * @param screen Search screen to destroy
+ */
+void search_screen_destroy(search_screen_t *screen);
+
+/**
+ * Clear the query and results (call when opening the screen)
+ *
+ * @param screen Search screen
+ */
+void search_screen_reset(search_screen_t *screen);
+
+/**
+ * Re-run the current query (e.g. after the index was rebuilt by a sync)
+ *
+ * @param screen Search screen
+ */
+void search_screen_refresh(search_screen_t *screen);
+
+/**
+ * Handle input for search screen
+ *
+ * @param screen Search screen
+ * @param event SDL event
+ * @return 0 to stay, 1 to open the selected entity, -1 to go back
+ */
+int search_screen_handle_input(search_screen_t *screen, SDL_Event *event);
+
+/**
+ * Render search screen
+ *
+ * @param screen Search screen
+ */
+void search_screen_render(search_screen_t *screen);
+
+/**
+ * Get entity ID of the selected match
+ *
+ * @param screen Search screen
+ * @return Entity ID or NULL if nothing is selected
+ */
+const char* search_screen_get_selected_entity_id(search_screen_t *screen);
+
+#endif // SCREEN_SEARCH_H
@@ -180,28 +180,28 @@ void setup_screen_render(setup_screen_t *screen) {
         // Connection status icon and text
         const char *status_text;
         SDL_Color status_color;
-        const char *status_icon;
+        icon_id_t status_icon;
 
         switch (screen->server_status[i]) {
             case CONN_STATUS_TESTING:
                 status_text = "TESTING...";
                 status_color = COLOR_TEXT_SECONDARY;
-                status_icon = "wifi_off";
+                status_icon = ICON_ID_WIFI_OFF;
                 break;
             case CONN_STATUS_CONNECTED:
                 status_text = "CONNECTED";
                 status_color = COLOR_ACCENT;
-                status_icon = "wifi_on";
+                status_icon = ICON_ID_WIFI_ON;
                 break;
             case CONN_STATUS_FAILED:
                 status_text = "FAILED";
                 status_color = COLOR_TEXT_SECONDARY;
-                status_icon = "wifi_off";
+                status_icon = ICON_ID_WIFI_OFF;
                 break;
             default:
                 status_text = "UNKNOWN";
                 status_color = COLOR_TEXT_SECONDARY;
-                status_icon = "wifi_off";
+                status_icon = ICON_ID_WIFI_OFF;
                 break;
         }
 
@@ -211,7 +211,7 @@ void setup_screen_render(setup_screen_t *screen) {
 
         // Default server indicator
         if (i == screen->config->default_server) {
-            icons_draw(screen->icons, "star_filled", 490, y + 12, 16);
+            icons_draw(screen->icons, ICON_ID_STAR_FILLED, 490, y + 12, 16);
         }
     }
 
@@ -210,17 +210,17 @@ void test_screen_render(test_screen_t *screen) {
                 // Section: Icons
                 ui_draw_text(r, font_body, "ICONS:", 20, 175, COLOR_TEXT_PRIMARY, TEXT_ALIGN_LEFT);
                 int icon_x = 100;
-                icons_draw(screen->icons, "light_bulb", icon_x, 170, 16); icon_x += 24;
-                icons_draw(screen->icons, "switch_toggle", icon_x, 170, 16); icon_x += 24;
-                icons_draw(screen->icons, "climate_thermo", icon_x, 170, 16); icon_x += 24;
-                icons_draw(screen->icons, "sensor_generic", icon_x, 170, 16); icon_x += 24;
-                icons_draw(screen->icons, "automation_robot", icon_x, 170, 16); icon_x += 24;
-                icons_draw(screen->icons, "script_code", icon_x, 170, 16); icon_x += 24;
-                icons_draw(screen->icons, "scene_stars", icon_x, 170, 16); icon_x += 24;
-                icons_draw(screen->icons, "star_filled", icon_x, 170, 16); icon_x += 24;
-                icons_draw(screen->icons, "star_empty", icon_x, 170, 16); icon_x += 24;
-                icons_draw(screen->icons, "wifi_on", icon_x, 170, 16); icon_x += 24;
-                icons_draw(screen->icons, "wifi_off", icon_x, 170, 16); icon_x += 24;
+                icons_draw(screen->icons, ICON_ID_LIGHT_BULB, icon_x, 170, 16); icon_x += 24;
+                icons_draw(screen->icons, ICON_ID_SWITCH_TOGGLE, icon_x, 170, 16); icon_x += 24;
+                icons_draw(screen->icons, ICON_ID_CLIMATE_THERMO, icon_x, 170, 16); icon_x += 24;
+                icons_draw(screen->icons, ICON_ID_SENSOR_GENERIC, icon_x, 170, 16); icon_x += 24;
+                icons_draw(screen->icons, ICON_ID_AUTOMATION_ROBOT, icon_x, 170, 16); icon_x += 24;
+                icons_draw(screen->icons, ICON_ID_SCRIPT_CODE, icon_x, 170, 16); icon_x += 24;
+                icons_draw(screen->icons, ICON_ID_SCENE_STARS, icon_x, 170, 16); icon_x += 24;
+                icons_draw(screen->icons, ICON_ID_STAR_FILLED, icon_x, 170, 16); icon_x += 24;
+                icons_draw(screen->icons, ICON_ID_STAR_EMPTY, icon_x, 170, 16); icon_x += 24;
+                icons_draw(screen->icons, ICON_ID_WIFI_ON, icon_x, 170, 16); icon_x += 24;
+                icons_draw(screen->icons, ICON_ID_WIFI_OFF, icon_x, 170, 16); icon_x += 24;
 
                 // Section: Buttons
                 ui_draw_text(r, font_body, "BUTTONS:", 20, 210, COLOR_TEXT_PRIMARY, TEXT_ALIGN_LEFT);
@@ -254,11 +254,11 @@ void test_screen_render(test_screen_t *screen) {
                             COLOR_TEXT_PRIMARY, TEXT_ALIGN_LEFT);
 
                 int x = 50, y = 140;
-                const char *icon_list[] = {
-                    "light_bulb", "switch_toggle", "climate_thermo",
-                    "sensor_generic", "automation_robot", "script_code",
-                    "scene_stars", "star_filled", "star_empty",
-                    "wifi_on", "wifi_off", "generic"
+                const icon_id_t icon_list[] = {
+                    ICON_ID_LIGHT_BULB, ICON_ID_SWITCH_TOGGLE, ICON_ID_CLIMATE_THERMO,
+                    ICON_ID_SENSOR_GENERIC, ICON_ID_AUTOMATION_ROBOT, ICON_ID_SCRIPT_CODE,
+                    ICON_ID_SCENE_STARS, ICON_ID_STAR_FILLED, ICON_ID_STAR_EMPTY,
+                    ICON_ID_WIFI_ON, ICON_ID_WIFI_OFF, ICON_ID_GENERIC
                 };
                 const char *labels[] = {
                     "Light", "Switch", "Climate",
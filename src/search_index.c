@@ -0,0 +1,270 @@
+/**
+ * search_index.c - In-Memory Entity Search Index Implementation
+ */
+
+#include "search_index.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/* Rank offset for matches inside entity_id (weaker than name matches) */
+#define RANK_ENTITY_ID 8
+
+/* Most results a single query can rank */
+#define MAX_RANKED 64
+
+/* Text being sorted (qsort has no context argument) */
+static const char *sort_text = NULL;
+
+static int compare_tokens(const void *a, const void *b) {
+    const search_token_t *ta = a;
+    const search_token_t *tb = b;
+
+    int cmp = strcmp(sort_text + ta->text_offset, sort_text + tb->text_offset);
+    if (cmp != 0) return cmp;
+    if (ta->entity != tb->entity) return ta->entity - tb->entity;
+    return ta->rank - tb->rank;
+}
+
+static void clear_index(search_index_t *index) {
+    unsigned int generation = index->generation;
+
+    free(index->names);
+    free(index->entity_offsets);
+    free(index->folded);
+    free(index->tokens);
+    memset(index, 0, sizeof(*index));
+
+    // Any range held by a query is now stale
+    index->generation = generation + 1;
+}
+
+search_index_t* search_index_create(void) {
+    return calloc(1, sizeof(search_index_t));
+}
+
+void search_index_destroy(search_index_t *index) {
+    if (!index) return;
+    clear_index(index);
+    free(index);
+}
+
+/**
+ * Helper: Count word starts in a folded string
+ */
+static int count_word_starts(const char *text) {
+    int count = 0;
+    for (int i = 0; text[i]; i++) {
+        if (isalnum((unsigned char)text[i]) &&
+            (i == 0 || !isalnum((unsigned char)text[i - 1]))) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * Helper: Add a token for each word start in text
+ */
+static void add_word_starts(search_index_t *index, int offset, int entity, int base_rank) {
+    const char *text = index->folded + offset;
+    int word = 0;
+
+    for (int i = 0; text[i]; i++) {
+        if (isalnum((unsigned char)text[i]) &&
+            (i == 0 || !isalnum((unsigned char)text[i - 1]))) {
+            search_token_t *t = &index->tokens[index->token_count++];
+            t->text_offset = offset + i;
+            t->entity = entity;
+            t->rank = base_rank + word++;
+        }
+    }
+}
+
+int search_index_rebuild(search_index_t *index, const ha_entity_t *const *entities, int count) {
+    if (!index) return 0;
+
+    clear_index(index);
+    if (!entities || count <= 0) return 1;
+
+    // Size the arena: "entity_id\0friendly_name\0" per entity
+    size_t text_size = 0;
+    for (int i = 0; i < count; i++) {
+        text_size += strlen(entities[i]->entity_id) + strlen(entities[i]->friendly_name) + 2;
+    }
+
+    index->names = malloc(text_size);
+    index->folded = malloc(text_size);
+    index->entity_offsets = malloc(count * sizeof(int));
+    if (!index->names || !index->folded || !index->entity_offsets) {
+        clear_index(index);
+        return 0;
+    }
+
+    size_t pos = 0;
+    int token_total = 0;
+    for (int i = 0; i < count; i++) {
+        index->entity_offsets[i] = (int)pos;
+
+        size_t id_len = strlen(entities[i]->entity_id) + 1;
+        memcpy(index->names + pos, entities[i]->entity_id, id_len);
+        pos += id_len;
+
+        size_t name_len = strlen(entities[i]->friendly_name) + 1;
+        memcpy(index->names + pos, entities[i]->friendly_name, name_len);
+        pos += name_len;
+    }
+    for (size_t i = 0; i < text_size; i++) {
+        index->folded[i] = (char)tolower((unsigned char)index->names[i]);
+    }
+    index->entity_count = count;
+
+    for (int i = 0; i < count; i++) {
+        const char *id = index->folded + index->entity_offsets[i];
+        token_total += count_word_starts(id) + count_word_starts(id + strlen(id) + 1);
+    }
+
+    index->tokens = malloc((token_total > 0 ? token_total : 1) * sizeof(search_token_t));
+    if (!index->tokens) {
+        clear_index(index);
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        int id_offset = index->entity_offsets[i];
+        int name_offset = id_offset + (int)strlen(index->folded + id_offset) + 1;
+        add_word_starts(index, name_offset, i, 0);
+        add_word_starts(index, id_offset, i, RANK_ENTITY_ID);
+    }
+
+    sort_text = index->folded;
+    qsort(index->tokens, index->token_count, sizeof(search_token_t), compare_tokens);
+    sort_text = NULL;
+
+    return 1;
+}
+
+void search_query_reset(search_query_t *query) {
+    if (!query) return;
+    memset(query, 0, sizeof(*query));
+}
+
+/**
+ * Helper: First token in [lo, hi) whose text compares >= prefix
+ * (or > prefix when upper is set), looking only at prefix_len chars.
+ */
+static int bound(const search_index_t *index, int lo, int hi,
+                 const char *prefix, size_t prefix_len, int upper) {
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        int cmp = strncmp(index->folded + index->tokens[mid].text_offset, prefix, prefix_len);
+        if (cmp < 0 || (upper && cmp == 0)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+int search_index_query(search_index_t *index, search_query_t *query, const char *prefix,
+                       search_result_t *results, int max_results) {
+    if (!index || !query || !prefix || !results || max_results <= 0) {
+        return 0;
+    }
+
+    char folded[SEARCH_MAX_QUERY];
+    size_t len = 0;
+    while (prefix[len] && len < sizeof(folded) - 1) {
+        folded[len] = (char)tolower((unsigned char)prefix[len]);
+        len++;
+    }
+    folded[len] = '\0';
+
+    if (len == 0 || index->token_count == 0) {
+        search_query_reset(query);
+        return 0;
+    }
+
+    // Typing more characters only narrows the previous range
+    int lo = 0;
+    int hi = index->token_count;
+    size_t prev_len = strlen(query->prefix);
+    if (prev_len > 0 && prev_len <= len && strncmp(folded, query->prefix, prev_len) == 0 &&
+        query->generation == index->generation) {
+        lo = query->lo;
+        hi = query->hi;
+    }
+
+    lo = bound(index, lo, hi, folded, len, 0);
+    hi = bound(index, lo, hi, folded, len, 1);
+
+    memcpy(query->prefix, folded, len + 1);
+    query->lo = lo;
+    query->hi = hi;
+    query->generation = index->generation;
+
+    // Keep the best-scoring token per entity among the top candidates
+    if (max_results > MAX_RANKED) max_results = MAX_RANKED;
+    int ranked_entity[MAX_RANKED];
+    int ranked_score[MAX_RANKED];
+    int ranked = 0;
+
+    for (int t = lo; t < hi; t++) {
+        const search_token_t *token = &index->tokens[t];
+        const char *id = index->names + index->entity_offsets[token->entity];
+        int name_len = (int)strlen(id + strlen(id) + 1);
+        int score = token->rank * 256 + (name_len < 255 ? name_len : 255);
+
+        int slot = -1;
+        for (int r = 0; r < ranked; r++) {
+            if (ranked_entity[r] == token->entity) {
+                slot = r;
+                break;
+            }
+        }
+
+        if (slot >= 0) {
+            if (score < ranked_score[slot]) ranked_score[slot] = score;
+            continue;
+        }
+
+        if (ranked < max_results) {
+            slot = ranked++;
+        } else {
+            int worst = 0;
+            for (int r = 1; r < ranked; r++) {
+                if (ranked_score[r] > ranked_score[worst]) worst = r;
+            }
+            if (score >= ranked_score[worst]) continue;
+            slot = worst;
+        }
+        ranked_entity[slot] = token->entity;
+        ranked_score[slot] = score;
+    }
+
+    // Order by score (insertion sort, at most MAX_RANKED entries)
+    for (int i = 1; i < ranked; i++) {
+        int e = ranked_entity[i];
+        int s = ranked_score[i];
+        int j = i - 1;
+        while (j >= 0 && ranked_score[j] > s) {
+            ranked_entity[j + 1] = ranked_entity[j];
+            ranked_score[j + 1] = ranked_score[j];
+            j--;
+        }
+        ranked_entity[j + 1] = e;
+        ranked_score[j + 1] = s;
+    }
+
+    for (int i = 0; i < ranked; i++) {
+        const char *id = index->names + index->entity_offsets[ranked_entity[i]];
+        const char *name = id + strlen(id) + 1;
+        memset(&results[i], 0, sizeof(results[i]));
+        strncpy(results[i].entity_id, id, sizeof(results[i].entity_id) - 1);
+        strncpy(results[i].friendly_name, name, sizeof(results[i].friendly_name) - 1);
+    }
+
+    return ranked;
+}
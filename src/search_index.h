@@ -0,0 +1,113 @@
+/**
+ * search_index.h - In-Memory Entity Search Index
+ *
+ * Prefix search over entity friendly_name and entity_id. Every word
+ * start of both strings is indexed, so "kit" finds "Kitchen Light" and
+ * "light.kitchen", and "kitchen li" matches across words.
+ *
+ * The index is rebuilt from the cache after each sync; queries never
+ * touch the database.
+ */
+
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include "utils/json_helpers.h"
+
+/**
+ * Longest prefix a query will use
+ */
+#define SEARCH_MAX_QUERY 64
+
+/**
+ * One search hit (copied out of the index)
+ */
+typedef struct {
+    char entity_id[128];
+    char friendly_name[128];
+} search_result_t;
+
+/**
+ * Indexed word start: points into the lowercased text arena
+ */
+typedef struct {
+    int text_offset;       // Start of the suffix in folded text
+    int entity;            // Index into entity_offsets
+    int rank;              // 0 = start of friendly_name, higher = weaker
+} search_token_t;
+
+/**
+ * Search index (sorted suffix table over word starts)
+ */
+typedef struct {
+    char *names;           // "entity_id\0friendly_name\0" per entity
+    int *entity_offsets;   // Offset of each entity in names
+    int entity_count;
+
+    char *folded;          // Lowercased copies used for matching
+    search_token_t *tokens;
+    int token_count;
+
+    unsigned int generation; // Bumped on every rebuild
+} search_index_t;
+
+/**
+ * Incremental query state
+ * Reusing it while the user types narrows the search range instead of
+ * searching the whole table again.
+ */
+typedef struct {
+    char prefix[SEARCH_MAX_QUERY];
+    int lo;                // Matching token range [lo, hi)
+    int hi;
+    unsigned int generation; // Index generation the range belongs to
+} search_query_t;
+
+/**
+ * Create an empty index
+ *
+ * @return search_index_t pointer or NULL on failure
+ */
+search_index_t* search_index_create(void);
+
+/**
+ * Destroy index
+ *
+ * @param index Index to destroy
+ */
+void search_index_destroy(search_index_t *index);
+
+/**
+ * Replace the index contents with a set of entities
+ *
+ * @param index Search index
+ * @param entities Array of entity pointers (only read during the call)
+ * @param count Number of entities
+ * @return 1 on success, 0 on failure (index left empty)
+ */
+int search_index_rebuild(search_index_t *index, const ha_entity_t *const *entities, int count);
+
+/**
+ * Reset query state (e.g. when the query text is cleared)
+ *
+ * @param query Query state
+ */
+void search_query_reset(search_query_t *query);
+
+/**
+ * Run a prefix query, returning the best matches
+ *
+ * Results favour matches at the start of the friendly name, then
+ * earlier words, then shorter names. Each entity appears once.
+ *
+ * @param index Search index
+ * @param query Query state (updated; pass the same one while typing)
+ * @param prefix Text typed so far (case-insensitive)
+ * @param results Output buffer
+ * @param max_results Capacity of results
+ * @return Number of results written
+ */
+int search_index_query(search_index_t *index, search_query_t *query, const char *prefix,
+                       search_result_t *results, int max_results);
+
+#endif // SEARCH_INDEX_H
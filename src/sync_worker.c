@@ -0,0 +1,475 @@
+/**
+ * sync_worker.c - Background Sync Thread Implementation
+ *
+ * The pending slot holds at most one snapshot. Publishing is an atomic
+ * exchange: if the UI has not taken the previous snapshot yet, the
+ * worker gets it back and frees it. Since the UI only ever receives a
+ * snapshot through the same exchange, nothing it holds is ever freed
+ * underneath it.
+ *
+ * Calls and results use Treiber stacks: producers push with a CAS and the
+ * single consumer takes the whole stack with one exchange, then reverses
+ * it into arrival order. Taking everything at once avoids ABA.
+ */
+
+#include "sync_worker.h"
+#include "utils/json_helpers.h"
+#include "utils/str_map.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================
+ * Fetch
+ * ============================================ */
+
+/**
+ * Parse entity-area mappings from template API response into the
+ * freshly parsed entities (so the whole sync is saved in one job)
+ * JSON format: [{"e":"entity_id","a":"area_id"},...]
+ */
+static void parse_and_update_areas(ha_entity_t **entities, int count, const char *json) {
+    if (!entities || !json || strlen(json) < 2) {
+        return;
+    }
+
+    str_map_t index;
+    if (!str_map_init(&index, count)) {
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        str_map_put(&index, entities[i]->entity_id, i);
+    }
+
+    int updated = 0;
+    const char *ptr = json;
+
+    // Simple JSON array parser for [{"e":"...","a":"..."},...]
+    while ((ptr = strstr(ptr, "\"e\":\"")) != NULL) {
+        ptr += 5; // Skip "e":"
+
+        // Extract entity_id
+        char entity_id[128] = {0};
+        int i = 0;
+        while (*ptr && *ptr != '"' && i < 127) {
+            entity_id[i++] = *ptr++;
+        }
+        if (*ptr != '"') continue;
+        ptr++; // Skip closing quote
+
+        // Find area_id
+        const char *area_ptr = strstr(ptr, "\"a\":\"");
+        if (!area_ptr || area_ptr > ptr + 20) continue;
+        area_ptr += 5; // Skip "a":"
+
+        char area_id[64] = {0};
+        i = 0;
+        while (*area_ptr && *area_ptr != '"' && i < 63) {
+            area_id[i++] = *area_ptr++;
+        }
+
+        int idx;
+        if (strlen(area_id) > 0 && str_map_get(&index, entity_id, &idx)) {
+            snprintf(entities[idx]->area_id, sizeof(entities[idx]->area_id), "%s", area_id);
+            updated++;
+        }
+    }
+
+    str_map_free(&index);
+    printf("Updated area assignments for %d entities\n", updated);
+}
+
+static double elapsed_ms(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 +
+           (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+sync_snapshot_t* sync_fetch(ha_client_t *client) {
+    sync_snapshot_t *snapshot = calloc(1, sizeof(sync_snapshot_t));
+    if (!snapshot || !client) {
+        return snapshot;
+    }
+
+    sync_stats_t *stats = &snapshot->stats;
+    struct timespec fetch_start, phase_start;
+    clock_gettime(CLOCK_MONOTONIC, &fetch_start);
+    stats->started = time(NULL);
+    stats->write_ms = -1;
+
+    printf("Syncing with Home Assistant...\n");
+
+    // Fetch all states from HA
+    ha_response_t *response = ha_client_get_states(client);
+    if (!response) {
+        fprintf(stderr, "Sync failed: no response from HA\n");
+        stats->fetch_ms = elapsed_ms(&fetch_start);
+        return snapshot;
+    }
+
+    stats->states = response->timing;
+    stats->status_code = response->status_code;
+    stats->bytes = response->size;
+
+    if (!response->success) {
+        fprintf(stderr, "Sync failed: %s (HTTP %d)\n",
+                response->error_message, response->status_code);
+        ha_response_free(response);
+        stats->fetch_ms = elapsed_ms(&fetch_start);
+        return snapshot;
+    }
+
+    // Parse entities
+    int count = 0;
+    clock_gettime(CLOCK_MONOTONIC, &phase_start);
+    ha_entity_t **entities = parse_entities_array(response->data, &count);
+    stats->parse_ms = elapsed_ms(&phase_start);
+    ha_response_free(response);
+
+    if (!entities || count == 0) {
+        fprintf(stderr, "Sync failed: no entities parsed\n");
+        free_entities(entities, count);
+        stats->fetch_ms = elapsed_ms(&fetch_start);
+        return snapshot;
+    }
+
+    printf("Parsed %d entities from Home Assistant\n", count);
+
+    // Fetch and merge area assignments from entity registry
+    printf("Fetching area assignments...\n");
+    ha_response_t *area_response = ha_client_get_entity_registry(client);
+    if (area_response) {
+        stats->areas = area_response->timing;
+        stats->bytes += area_response->size;
+    }
+    if (area_response && area_response->success && area_response->data) {
+        clock_gettime(CLOCK_MONOTONIC, &phase_start);
+        parse_and_update_areas(entities, count, area_response->data);
+        stats->area_parse_ms = elapsed_ms(&phase_start);
+    } else {
+        printf("Area fetch skipped (no response or error)\n");
+    }
+    if (area_response) {
+        ha_response_free(area_response);
+    }
+
+    stats->success = 1;
+    stats->entity_count = count;
+    stats->fetch_ms = elapsed_ms(&fetch_start);
+
+    snapshot->success = 1;
+    snapshot->entities = entities;
+    snapshot->count = count;
+    snapshot->fetched_at = time(NULL);
+    return snapshot;
+}
+
+void sync_snapshot_free(sync_snapshot_t *snapshot) {
+    if (!snapshot) {
+        return;
+    }
+
+    if (snapshot->entities) {
+        free_entities(snapshot->entities, snapshot->count);
+    }
+    free(snapshot);
+}
+
+/* ============================================
+ * Service Calls
+ * ============================================ */
+
+sync_call_t* sync_call_create(const char *domain, const char *service,
+                              const char *entity_id, const char *params_json) {
+    if (!domain || !service) {
+        return NULL;
+    }
+
+    sync_call_t *call = calloc(1, sizeof(sync_call_t));
+    if (!call) {
+        return NULL;
+    }
+
+    strncpy(call->domain, domain, sizeof(call->domain) - 1);
+    strncpy(call->service, service, sizeof(call->service) - 1);
+    if (entity_id) {
+        strncpy(call->entity_id, entity_id, sizeof(call->entity_id) - 1);
+    }
+    if (params_json) {
+        call->params_json = strdup(params_json);
+        if (!call->params_json) {
+            free(call);
+            return NULL;
+        }
+    }
+
+    return call;
+}
+
+sync_call_t* sync_call_create_refresh(const char *const *entity_ids, int count) {
+    if (!entity_ids || count <= 0) {
+        return NULL;
+    }
+
+    sync_call_t *call = calloc(1, sizeof(sync_call_t));
+    if (!call) {
+        return NULL;
+    }
+
+    call->type = SYNC_CALL_REFRESH;
+    call->entity_ids = calloc(count, sizeof(char *));
+    if (!call->entity_ids) {
+        free(call);
+        return NULL;
+    }
+
+    for (int i = 0; i < count; i++) {
+        call->entity_ids[i] = strdup(entity_ids[i]);
+        if (!call->entity_ids[i]) {
+            sync_call_free(call);
+            return NULL;
+        }
+        call->entity_count++;
+    }
+
+    return call;
+}
+
+void sync_call_run(ha_client_t *client, sync_call_t *call) {
+    ha_response_t *response;
+    if (call->type == SYNC_CALL_REFRESH) {
+        response = ha_client_get_states_of(client, (const char *const *)call->entity_ids,
+                                           call->entity_count);
+    } else {
+        response = ha_client_call_service(client, call->domain, call->service,
+                                          call->entity_id[0] ? call->entity_id : NULL,
+                                          call->params_json);
+    }
+
+    call->success = (response && response->success);
+    call->status_code = response ? response->status_code : 0;
+
+    // The body lists the changed states; no need to read them back
+    if (call->success && response->data) {
+        call->changed = parse_entities_array(response->data, &call->changed_count);
+    }
+
+    if (response) {
+        ha_response_free(response);
+    }
+}
+
+void sync_call_free(sync_call_t *call) {
+    if (!call) {
+        return;
+    }
+
+    if (call->changed) {
+        free_entities(call->changed, call->changed_count);
+    }
+    for (int i = 0; i < call->entity_count; i++) {
+        free(call->entity_ids[i]);
+    }
+    free(call->entity_ids);
+    free(call->params_json);
+    free(call);
+}
+
+static void stack_push(sync_call_t **head, sync_call_t *call) {
+    sync_call_t *top = __atomic_load_n(head, __ATOMIC_RELAXED);
+    do {
+        call->next = top;
+    } while (!__atomic_compare_exchange_n(head, &top, call, 1,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/**
+ * Take the whole stack and return it oldest first
+ */
+static sync_call_t* stack_take_all(sync_call_t **head) {
+    if (!__atomic_load_n(head, __ATOMIC_RELAXED)) {
+        return NULL;
+    }
+
+    sync_call_t *list = __atomic_exchange_n(head, NULL, __ATOMIC_ACQUIRE);
+    sync_call_t *ordered = NULL;
+    while (list) {
+        sync_call_t *next = list->next;
+        list->next = ordered;
+        ordered = list;
+        list = next;
+    }
+    return ordered;
+}
+
+static void notify_ready(sync_worker_t *worker) {
+    if (worker->notify) {
+        worker->notify(worker->notify_ctx);
+    }
+}
+
+static void run_calls(sync_worker_t *worker) {
+    sync_call_t *call = stack_take_all(&worker->calls);
+    while (call) {
+        sync_call_t *next = call->next;
+        sync_call_run(worker->client, call);
+        stack_push(&worker->results, call);
+        notify_ready(worker);
+        call = next;
+    }
+}
+
+/* ============================================
+ * Thread
+ * ============================================ */
+
+static void* worker_thread(void *arg) {
+    sync_worker_t *worker = arg;
+
+    while (!__atomic_load_n(&worker->stop, __ATOMIC_ACQUIRE)) {
+        int interval = __atomic_load_n(&worker->interval, __ATOMIC_RELAXED);
+        struct timespec deadline = {0, 0};
+        deadline.tv_sec = worker->last_fetch + interval;
+
+        int woken = (interval > 0) ? sem_timedwait(&worker->wakeup, &deadline) == 0
+                                   : sem_wait(&worker->wakeup) == 0;
+        if (woken) {
+            // User actions first: they are what the user is waiting for
+            run_calls(worker);
+            if (__atomic_load_n(&worker->stop, __ATOMIC_ACQUIRE)) {
+                break;
+            }
+            if (!__atomic_exchange_n(&worker->requested, 0, __ATOMIC_ACQ_REL)) {
+                continue;   // Call or interval change: wait again
+            }
+        } else if (errno != ETIMEDOUT) {
+            continue;       // EINTR
+        }
+
+        sync_snapshot_t *snapshot = sync_fetch(worker->client);
+        worker->last_fetch = time(NULL);
+        if (!snapshot) {
+            continue;
+        }
+
+        // Publish; a snapshot the UI never took is ours again
+        sync_snapshot_t *stale = __atomic_exchange_n(&worker->pending, snapshot, __ATOMIC_ACQ_REL);
+        sync_snapshot_free(stale);
+        notify_ready(worker);
+    }
+
+    // Calls queued while the last fetch was running
+    run_calls(worker);
+    return NULL;
+}
+
+/* ============================================
+ * Public API
+ * ============================================ */
+
+sync_worker_t* sync_worker_start(ha_client_t *client, int interval, time_t last_sync,
+                                 sync_notify_fn notify, void *notify_ctx) {
+    if (!client || interval < 0) {
+        return NULL;
+    }
+
+    sync_worker_t *worker = calloc(1, sizeof(sync_worker_t));
+    if (!worker) {
+        return NULL;
+    }
+
+    worker->client = client;
+    worker->interval = interval;
+    worker->last_fetch = last_sync;
+    worker->notify = notify;
+    worker->notify_ctx = notify_ctx;
+
+    if (sem_init(&worker->wakeup, 0, 0) != 0) {
+        free(worker);
+        return NULL;
+    }
+
+    if (pthread_create(&worker->thread, NULL, worker_thread, worker) != 0) {
+        fprintf(stderr, "Failed to start sync thread\n");
+        sem_destroy(&worker->wakeup);
+        free(worker);
+        return NULL;
+    }
+
+    worker->running = 1;
+    return worker;
+}
+
+void sync_worker_stop(sync_worker_t *worker) {
+    if (!worker) {
+        return;
+    }
+
+    if (worker->running) {
+        __atomic_store_n(&worker->stop, 1, __ATOMIC_RELEASE);
+        sem_post(&worker->wakeup);
+        pthread_join(worker->thread, NULL);
+        worker->running = 0;
+    }
+
+    sync_snapshot_free(sync_worker_take(worker));
+    sync_call_t *call = sync_worker_take_results(worker);
+    while (call) {
+        sync_call_t *next = call->next;
+        sync_call_free(call);
+        call = next;
+    }
+    sem_destroy(&worker->wakeup);
+    free(worker);
+}
+
+void sync_worker_request(sync_worker_t *worker) {
+    if (!worker || !worker->running) {
+        return;
+    }
+
+    // Only post once per request so repeated presses don't queue fetches
+    if (!__atomic_exchange_n(&worker->requested, 1, __ATOMIC_ACQ_REL)) {
+        sem_post(&worker->wakeup);
+    }
+}
+
+void sync_worker_set_interval(sync_worker_t *worker, int seconds) {
+    if (!worker || seconds < 0) {
+        return;
+    }
+
+    __atomic_store_n(&worker->interval, seconds, __ATOMIC_RELAXED);
+    if (worker->running) {
+        sem_post(&worker->wakeup);
+    }
+}
+
+sync_snapshot_t* sync_worker_take(sync_worker_t *worker) {
+    if (!worker) {
+        return NULL;
+    }
+
+    // Cheap check first: most frames have nothing pending
+    if (!__atomic_load_n(&worker->pending, __ATOMIC_RELAXED)) {
+        return NULL;
+    }
+
+    return __atomic_exchange_n(&worker->pending, NULL, __ATOMIC_ACQ_REL);
+}
+
+int sync_worker_call(sync_worker_t *worker, sync_call_t *call) {
+    if (!worker || !worker->running || !call) {
+        return 0;
+    }
+
+    stack_push(&worker->calls, call);
+    sem_post(&worker->wakeup);
+    return 1;
+}
+
+sync_call_t* sync_worker_take_results(sync_worker_t *worker) {
+    return worker ? stack_take_all(&worker->results) : NULL;
+}
@@ -0,0 +1,231 @@
+/**
+ * sync_worker.h - Background Sync Thread
+ *
+ * Fetches all states and area assignments from Home Assistant on a
+ * dedicated thread, so the network round trips and JSON parsing never
+ * stall a frame. Each finished fetch becomes an immutable snapshot that
+ * is published by swapping it into a single pending slot. The UI thread
+ * takes the slot at a frame boundary and merges the snapshot into the
+ * cache, so screens only ever see a complete sync.
+ *
+ * Ownership moves with the pointer: a snapshot belongs to the worker
+ * until it is swapped in, to the slot until it is taken or superseded
+ * (the worker frees one that was never taken), and to the taker after.
+ *
+ * Service calls run on the same thread, ahead of any pending fetch.
+ * Finished calls come back on a result list the UI drains each frame.
+ * Refreshes of the entities on screen travel the same way: they are
+ * calls that read a few states instead of calling a service.
+ */
+
+#ifndef SYNC_WORKER_H
+#define SYNC_WORKER_H
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include "database.h"
+#include "ha_client.h"
+
+/**
+ * Where one sync's time went (milliseconds unless noted)
+ * The fetch fills in the network and parse phases; the cache adds the
+ * apply and write phases when it takes the snapshot.
+ */
+typedef struct {
+    time_t started;
+    int success;
+    int status_code;          // HTTP status of the states request (0: no response)
+    ha_timing_t states;       // GET /api/states phases
+    ha_timing_t areas;        // Area template request phases
+    double parse_ms;          // States JSON to entities
+    double area_parse_ms;     // Area assignments merged
+    double fetch_ms;          // Whole fetch on the worker thread
+    double apply_ms;          // Merge into the cache on the UI thread
+    double write_ms;          // Database write (-1 while the writer has not reported)
+    size_t bytes;             // Response bodies received
+    int entity_count;
+    int changed_count;        // Entities whose row changed
+    unsigned long write_job;  // Writer job still to report write_ms (0: none)
+} sync_stats_t;
+
+/**
+ * Result of one full fetch (immutable once published)
+ */
+typedef struct {
+    int success;              // 0: HA unreachable or returned nothing usable
+    ha_entity_t **entities;   // Owned, with registry areas merged in
+    int count;
+    time_t fetched_at;
+    sync_stats_t stats;
+} sync_snapshot_t;
+
+/**
+ * What a call does
+ */
+typedef enum {
+    SYNC_CALL_SERVICE,        // Call domain.service on entity_id
+    SYNC_CALL_REFRESH         // Read the states of entity_ids
+} sync_call_type_t;
+
+/**
+ * Service call or state refresh run on the worker thread
+ */
+typedef struct sync_call {
+    struct sync_call *next;   // Queue link
+    unsigned long id;         // Caller's tag
+    sync_call_type_t type;
+    char domain[32];
+    char service[64];
+    char entity_id[128];      // Service target; for a refresh, the pending entity it confirms
+    char *params_json;        // Owned, can be NULL
+    char **entity_ids;        // Refresh targets (owned)
+    int entity_count;
+
+    // Result, filled in by sync_call_run()
+    int success;
+    int status_code;
+    ha_entity_t **changed;    // States the call changed, from the response (owned, can be NULL)
+    int changed_count;
+} sync_call_t;
+
+/**
+ * Called on the worker thread when a snapshot or finished calls are
+ * ready to take; must be safe to call from any thread
+ */
+typedef void (*sync_notify_fn)(void *ctx);
+
+/**
+ * Worker context
+ */
+typedef struct {
+    ha_client_t *client;      // Shared with the UI; every request uses its own handle
+    pthread_t thread;
+    sem_t wakeup;             // Posted by requests, interval changes and stop
+    int running;
+    int stop;                 // Atomic
+    int requested;            // Atomic: sync now
+    int interval;             // Seconds between syncs, 0 = on request only (atomic)
+    time_t last_fetch;        // Worker thread only
+    sync_snapshot_t *pending; // Latest snapshot not yet taken (atomic swap)
+    sync_call_t *calls;       // Queued calls, newest first (atomic push)
+    sync_call_t *results;     // Finished calls, newest first (atomic push)
+    sync_notify_fn notify;    // Set before the thread starts (can be NULL)
+    void *notify_ctx;
+} sync_worker_t;
+
+/**
+ * Fetch states and areas and build a snapshot (blocking)
+ *
+ * @param client HA client
+ * @return Snapshot (check success), NULL on allocation failure
+ */
+sync_snapshot_t* sync_fetch(ha_client_t *client);
+
+/**
+ * Free a snapshot and its entities
+ *
+ * @param snapshot Snapshot to free (can be NULL)
+ */
+void sync_snapshot_free(sync_snapshot_t *snapshot);
+
+/**
+ * Create a service call
+ *
+ * @param domain Service domain
+ * @param service Service name
+ * @param entity_id Target entity (can be NULL)
+ * @param params_json Extra service data as a JSON object (can be NULL)
+ * @return New call or NULL on allocation failure
+ */
+sync_call_t* sync_call_create(const char *domain, const char *service,
+                              const char *entity_id, const char *params_json);
+
+/**
+ * Create a refresh of a few entities' states
+ *
+ * @param entity_ids Entity IDs (copied)
+ * @param count Number of IDs
+ * @return New call or NULL on allocation failure
+ */
+sync_call_t* sync_call_create_refresh(const char *const *entity_ids, int count);
+
+/**
+ * Run a call and parse the states it returned into changed (blocking)
+ * For a service call Home Assistant answers with every entity the call
+ * changed, including side effects such as the lights a scene switched.
+ *
+ * @param client HA client
+ * @param call Call to run; its result fields are filled in
+ */
+void sync_call_run(ha_client_t *client, sync_call_t *call);
+
+/**
+ * Free a call
+ *
+ * @param call Call to free (can be NULL)
+ */
+void sync_call_free(sync_call_t *call);
+
+/**
+ * Start the sync thread
+ *
+ * @param client HA client (not owned)
+ * @param interval Seconds between syncs (0: only on request)
+ * @param last_sync Time of the last completed sync (first sync is due interval later)
+ * @param notify Called when something is ready to take (can be NULL)
+ * @param notify_ctx Passed to notify
+ * @return sync_worker_t pointer or NULL on failure
+ */
+sync_worker_t* sync_worker_start(ha_client_t *client, int interval, time_t last_sync,
+                                 sync_notify_fn notify, void *notify_ctx);
+
+/**
+ * Stop the thread (runs queued calls, waits for a fetch in progress)
+ * and free any untaken snapshot and results
+ *
+ * @param worker Worker to stop (can be NULL)
+ */
+void sync_worker_stop(sync_worker_t *worker);
+
+/**
+ * Ask for a sync now instead of at the next interval
+ *
+ * @param worker Worker
+ */
+void sync_worker_request(sync_worker_t *worker);
+
+/**
+ * Change the interval; takes effect from the next wait
+ *
+ * @param worker Worker
+ * @param seconds Seconds between syncs (0: only on request)
+ */
+void sync_worker_set_interval(sync_worker_t *worker, int seconds);
+
+/**
+ * Queue a service call (takes ownership)
+ *
+ * @param worker Worker
+ * @param call Call to run
+ * @return 1 if queued, 0 if the worker is not running (call not taken)
+ */
+int sync_worker_call(sync_worker_t *worker, sync_call_t *call);
+
+/**
+ * Take every finished call (UI thread, once per frame)
+ *
+ * @param worker Worker
+ * @return List linked by next in completion order, now owned by the caller
+ */
+sync_call_t* sync_worker_take_results(sync_worker_t *worker);
+
+/**
+ * Take the pending snapshot, if any (UI thread, once per frame)
+ *
+ * @param worker Worker
+ * @return Snapshot now owned by the caller, or NULL if none is pending
+ */
+sync_snapshot_t* sync_worker_take(sync_worker_t *worker);
+
+#endif // SYNC_WORKER_H
@@ -10,9 +10,48 @@
  * Text Rendering
  * ============================================ */
 
+// Textures of strings the glyph atlases cannot draw (NULL: none)
+static text_cache_t *text_cache = NULL;
+
+void ui_set_text_cache(text_cache_t *cache) {
+    text_cache = cache;
+}
+
+/**
+ * Left edge of text of the given width drawn at x
+ */
+static int align_x(int x, int width, text_align_t align) {
+    switch (align) {
+        case TEXT_ALIGN_CENTER:
+            return x - width / 2;
+        case TEXT_ALIGN_RIGHT:
+            return x - width;
+        case TEXT_ALIGN_LEFT:
+        default:
+            return x;
+    }
+}
+
 void ui_draw_text(SDL_Renderer *renderer, TTF_Font *font, const char *text,
                   int x, int y, SDL_Color color, text_align_t align) {
-    if (!renderer || !font || !text || strlen(text) == 0) {
+    if (!renderer || !font || !text || text[0] == '\0') {
+        return;
+    }
+
+    // Common case: every character is in the font's atlas
+    const font_atlas_t *atlas = fonts_find_atlas(font);
+    int width;
+    if (atlas && fonts_atlas_measure(atlas, text, &width)) {
+        fonts_atlas_draw(renderer, atlas, text, align_x(x, width, align), y, color);
+        return;
+    }
+
+    // Anything else is rendered by SDL_ttf, once while it stays cached
+    int height;
+    SDL_Texture *cached = text_cache_get(text_cache, font, text, color, &width, &height);
+    if (cached) {
+        SDL_Rect dest = {align_x(x, width, align), y, width, height};
+        SDL_RenderCopy(renderer, cached, NULL, &dest);
         return;
     }
 
@@ -27,59 +66,107 @@ void ui_draw_text(SDL_Renderer *renderer, TTF_Font *font, const char *text,
         return;
     }
 
-    SDL_Rect dest = {x, y, surface->w, surface->h};
-
-    // Adjust x based on alignment
-    switch (align) {
-        case TEXT_ALIGN_CENTER:
-            dest.x = x - (surface->w / 2);
-            break;
-        case TEXT_ALIGN_RIGHT:
-            dest.x = x - surface->w;
-            break;
-        case TEXT_ALIGN_LEFT:
-        default:
-            break;
-    }
-
+    SDL_Rect dest = {align_x(x, surface->w, align), y, surface->w, surface->h};
     SDL_RenderCopy(renderer, texture, NULL, &dest);
 
     SDL_FreeSurface(surface);
     SDL_DestroyTexture(texture);
 }
 
-void ui_draw_text_truncated(SDL_Renderer *renderer, TTF_Font *font, const char *text,
-                            int x, int y, int max_width, SDL_Color color) {
-    if (!renderer || !font || !text || strlen(text) == 0) {
-        return;
+/**
+ * Bytes of text kept before "..." when it is wider than max_width,
+ * -1 if it fits as it is
+ */
+static int find_cut(TTF_Font *font, const char *text, int max_width) {
+    // Advance table: one pass, no layout
+    const font_atlas_t *atlas = fonts_find_atlas(font);
+    int text_width, ellipsis_width;
+    if (atlas && fonts_atlas_measure(atlas, text, &text_width) &&
+        fonts_atlas_measure(atlas, "...", &ellipsis_width)) {
+        return text_width <= max_width ? -1 :
+               fonts_atlas_fit(atlas, text, max_width, ellipsis_width);
     }
 
-    int text_width, text_height;
-    TTF_SizeText(font, text, &text_width, &text_height);
-
+    // Characters outside the atlas: measure candidates with SDL_ttf
+    int text_height;
+    TTF_SizeUTF8(font, text, &text_width, &text_height);
     if (text_width <= max_width) {
-        ui_draw_text(renderer, font, text, x, y, color, TEXT_ALIGN_LEFT);
-        return;
+        return -1;
     }
 
-    // Need to truncate
-    char truncated[256];
-    strncpy(truncated, text, sizeof(truncated) - 4);
-    truncated[sizeof(truncated) - 4] = '\0';
-
-    // Find length that fits
-    int len = strlen(truncated);
+    char candidate[256];
+    int len = (int)strlen(text);
+    if (len > (int)sizeof(candidate) - 4) {
+        len = (int)sizeof(candidate) - 4;
+    }
     while (len > 0) {
-        truncated[len] = '\0';
-        strcat(truncated, "...");
-        TTF_SizeText(font, truncated, &text_width, &text_height);
+        // Never cut inside a UTF-8 sequence
+        if (((unsigned char)text[len] & 0xC0) == 0x80) {
+            len--;
+            continue;
+        }
+        memcpy(candidate, text, len);
+        strcpy(candidate + len, "...");
+        TTF_SizeUTF8(font, candidate, &text_width, &text_height);
         if (text_width <= max_width) {
             break;
         }
-        truncated[len] = '\0';
         len--;
     }
+    return len;
+}
+
+/**
+ * Truncation cut points of recently drawn strings, direct-mapped by hash.
+ * Rows are drawn with the same text and width every frame, so the cut
+ * is found once per string.
+ */
+#define TRUNCATION_SLOTS 64
+
+typedef struct {
+    TTF_Font *font;              // NULL: empty
+    int max_width;
+    Uint32 hash;
+    char text[TEXT_CACHE_MAX_TEXT];
+    int cut;                     // find_cut() result
+} truncation_t;
+
+static truncation_t truncations[TRUNCATION_SLOTS];
+
+void ui_draw_text_truncated(SDL_Renderer *renderer, TTF_Font *font, const char *text,
+                            int x, int y, int max_width, SDL_Color color) {
+    if (!renderer || !font || !text || text[0] == '\0') {
+        return;
+    }
+
+    int cut;
+    if (strlen(text) < TEXT_CACHE_MAX_TEXT) {
+        Uint32 hash = text_cache_hash(font, (Uint32)max_width, text);
+        truncation_t *slot = &truncations[hash & (TRUNCATION_SLOTS - 1)];
+        if (slot->font != font || slot->max_width != max_width || slot->hash != hash ||
+            strcmp(slot->text, text) != 0) {
+            slot->font = font;
+            slot->max_width = max_width;
+            slot->hash = hash;
+            strcpy(slot->text, text);
+            slot->cut = find_cut(font, text, max_width);
+        }
+        cut = slot->cut;
+    } else {
+        cut = find_cut(font, text, max_width);
+    }
+
+    if (cut < 0) {
+        ui_draw_text(renderer, font, text, x, y, color, TEXT_ALIGN_LEFT);
+        return;
+    }
 
+    char truncated[256];
+    if (cut > (int)sizeof(truncated) - 4) {
+        cut = (int)sizeof(truncated) - 4;
+    }
+    memcpy(truncated, text, cut);
+    strcpy(truncated + cut, "...");
     ui_draw_text(renderer, font, truncated, x, y, color, TEXT_ALIGN_LEFT);
 }
 
@@ -495,3 +582,36 @@ void ui_draw_scrollbar(SDL_Renderer *renderer, int x, int y, int height,
     SDL_Rect thumb = {x, scrollbar_y, 4, scrollbar_height};
     ui_draw_filled_rect(renderer, thumb, COLOR_BORDER);
 }
+
+/* ============================================
+ * Sparkline
+ * ============================================ */
+
+void ui_draw_sparkline(SDL_Renderer *renderer, SDL_Rect rect,
+                       const float *values, int count, SDL_Color color) {
+    if (!renderer || !values || count < 2 || rect.w < 2 || rect.h < 2) return;
+
+    float min_val = values[0];
+    float max_val = values[0];
+    for (int i = 1; i < count; i++) {
+        if (values[i] < min_val) min_val = values[i];
+        if (values[i] > max_val) max_val = values[i];
+    }
+    float range = max_val - min_val;
+
+    set_render_color(renderer, color);
+
+    int prev_x = 0, prev_y = 0;
+    for (int i = 0; i < count; i++) {
+        int x = rect.x + (i * (rect.w - 1)) / (count - 1);
+        // Flat series sits in the middle
+        float t = (range > 0.0f) ? (values[i] - min_val) / range : 0.5f;
+        int y = rect.y + rect.h - 1 - (int)(t * (rect.h - 1));
+
+        if (i > 0) {
+            SDL_RenderDrawLine(renderer, prev_x, prev_y, x, y);
+        }
+        prev_x = x;
+        prev_y = y;
+    }
+}
@@ -12,6 +12,7 @@
 #include <SDL_ttf.h>
 #include "colors.h"
 #include "fonts.h"
+#include "text_cache.h"
 
 /* ============================================
  * Text Alignment
@@ -83,6 +84,13 @@ typedef struct {
  * Text Rendering
  * ============================================ */
 
+/**
+ * Set the cache used for text the glyph atlases cannot draw
+ *
+ * @param cache Text cache (not owned, NULL to render such text per call)
+ */
+void ui_set_text_cache(text_cache_t *cache);
+
 /**
  * Draw text with alignment
  *
@@ -313,4 +321,20 @@ void ui_dialog_navigate(dialog_t *dialog, int delta);
 void ui_draw_scrollbar(SDL_Renderer *renderer, int x, int y, int height,
                        int total_items, int visible_items, int scroll_offset);
 
+/* ============================================
+ * Sparkline
+ * ============================================ */
+
+/**
+ * Draw a line chart of values scaled to fit the rectangle
+ *
+ * @param renderer SDL renderer
+ * @param rect Chart area
+ * @param values Values, oldest first
+ * @param count Number of values (needs at least 2)
+ * @param color Line color
+ */
+void ui_draw_sparkline(SDL_Renderer *renderer, SDL_Rect rect,
+                       const float *values, int count, SDL_Color color);
+
 #endif // COMPONENTS_H
@@ -1,5 +1,11 @@
 /**
  * fonts.c - Font Management Implementation
+ *
+ * Glyph atlases are shelf-packed: glyphs go left to right in rows
+ * ATLAS_WIDTH pixels wide, with a one pixel gap so scaling never bleeds
+ * a neighbour in. Each glyph is rendered as a one-character string, so
+ * its cell already includes the bearing and baseline offset SDL_ttf
+ * would apply inside a longer string.
  */
 
 #include "fonts.h"
@@ -7,6 +13,15 @@
 #include <stdlib.h>
 #include <string.h>
 
+#define ATLAS_WIDTH 256
+
+// Manager whose atlases fonts_find_atlas() searches
+static font_manager_t *atlas_owner = NULL;
+
+static font_atlas_t* build_atlas(SDL_Renderer *renderer, TTF_Font *font);
+static void free_atlas(font_atlas_t *atlas);
+static int next_glyph(const char **text);
+
 font_manager_t* fonts_init(const char *font_path) {
     if (!font_path) {
         fprintf(stderr, "Font path is NULL\n");
@@ -59,6 +74,13 @@ font_manager_t* fonts_init(const char *font_path) {
 void fonts_destroy(font_manager_t *fonts) {
     if (!fonts) return;
 
+    if (atlas_owner == fonts) {
+        atlas_owner = NULL;
+    }
+    for (int i = 0; i < 3; i++) {
+        free_atlas(fonts->atlases[i]);
+    }
+
     if (fonts->font_small) {
         TTF_CloseFont(fonts->font_small);
     }
@@ -72,6 +94,110 @@ void fonts_destroy(font_manager_t *fonts) {
     free(fonts);
 }
 
+int fonts_build_atlases(font_manager_t *fonts, SDL_Renderer *renderer) {
+    if (!fonts || !renderer) {
+        return 0;
+    }
+
+    TTF_Font *sizes[3] = {fonts->font_small, fonts->font_body, fonts->font_header};
+    int built = 1;
+    for (int i = 0; i < 3; i++) {
+        free_atlas(fonts->atlases[i]);
+        fonts->atlases[i] = build_atlas(renderer, sizes[i]);
+        if (!fonts->atlases[i]) {
+            built = 0;
+        }
+    }
+
+    atlas_owner = fonts;
+    if (built) {
+        printf("Glyph atlases built (8px, 12px, 16px)\n");
+    }
+    return built;
+}
+
+const font_atlas_t* fonts_find_atlas(TTF_Font *font) {
+    if (!atlas_owner || !font) {
+        return NULL;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        font_atlas_t *atlas = atlas_owner->atlases[i];
+        if (atlas && atlas->font == font) {
+            return atlas;
+        }
+    }
+    return NULL;
+}
+
+int fonts_atlas_measure(const font_atlas_t *atlas, const char *text, int *width) {
+    if (!atlas || !text) {
+        return 0;
+    }
+
+    int total = 0;
+    while (*text) {
+        int glyph = next_glyph(&text);
+        if (glyph < 0 || atlas->glyphs[glyph].w == 0) {
+            return 0;
+        }
+        total += atlas->advance[glyph];
+    }
+
+    if (width) *width = total;
+    return 1;
+}
+
+int fonts_atlas_fit(const font_atlas_t *atlas, const char *text, int max_width,
+                    int suffix_width) {
+    if (!atlas || !text) {
+        return -1;
+    }
+
+    // Running prefix width; stop at the first glyph that would overflow
+    const char *start = text;
+    int width = suffix_width;
+    int fit = 0;
+    while (*text) {
+        int glyph = next_glyph(&text);
+        if (glyph < 0 || atlas->glyphs[glyph].w == 0) {
+            return -1;
+        }
+
+        width += atlas->advance[glyph];
+        if (width > max_width) {
+            break;
+        }
+        fit = (int)(text - start);
+    }
+
+    return fit;
+}
+
+void fonts_atlas_draw(SDL_Renderer *renderer, const font_atlas_t *atlas, const char *text,
+                      int x, int y, SDL_Color color) {
+    if (!renderer || !atlas || !text) {
+        return;
+    }
+
+    SDL_SetTextureColorMod(atlas->texture, color.r, color.g, color.b);
+
+    int pen = x;
+    while (*text) {
+        int glyph = next_glyph(&text);
+        if (glyph < 0) {
+            break;
+        }
+
+        const SDL_Rect *src = &atlas->glyphs[glyph];
+        if (src->w > 0 && glyph != ' ' - FONT_ATLAS_FIRST) {
+            SDL_Rect dest = {pen, y, src->w, src->h};
+            SDL_RenderCopy(renderer, atlas->texture, src, &dest);
+        }
+        pen += atlas->advance[glyph];
+    }
+}
+
 TTF_Font* fonts_get(font_manager_t *fonts, font_size_t size) {
     if (!fonts) return NULL;
 
@@ -96,3 +222,133 @@ int fonts_measure_text(TTF_Font *font, const char *text, int *width, int *height
 
     return TTF_SizeText(font, text, width, height) == 0;
 }
+
+/* ============================================
+ * Glyph Atlas
+ * ============================================ */
+
+/**
+ * Decode the next character and return its atlas slot, -1 if the atlas
+ * cannot hold it (control characters, code points above U+00FF)
+ */
+static int next_glyph(const char **text) {
+    const unsigned char *p = (const unsigned char *)*text;
+    int code = -1;
+
+    if (p[0] < 0x80) {
+        code = p[0];
+        *text += 1;
+    } else if ((p[0] == 0xC2 || p[0] == 0xC3) && (p[1] & 0xC0) == 0x80) {
+        code = ((p[0] & 0x1F) << 6) | (p[1] & 0x3F);
+        *text += 2;
+    } else {
+        *text += 1;
+    }
+
+    if (code < FONT_ATLAS_FIRST || code > FONT_ATLAS_LAST || (code >= 0x7F && code < 0xA0)) {
+        return -1;
+    }
+    return code - FONT_ATLAS_FIRST;
+}
+
+static font_atlas_t* build_atlas(SDL_Renderer *renderer, TTF_Font *font) {
+    if (!font) {
+        return NULL;
+    }
+
+    font_atlas_t *atlas = calloc(1, sizeof(font_atlas_t));
+    SDL_Surface **rendered = calloc(FONT_ATLAS_GLYPHS, sizeof(SDL_Surface *));
+    if (!atlas || !rendered) {
+        free(atlas);
+        free(rendered);
+        return NULL;
+    }
+
+    atlas->font = font;
+    atlas->height = TTF_FontHeight(font);
+
+    // Render every glyph the font has and place it
+    SDL_Color white = {255, 255, 255, 255};
+    int x = 0, y = 0, row_height = 0;
+    for (int i = 0; i < FONT_ATLAS_GLYPHS; i++) {
+        int code = FONT_ATLAS_FIRST + i;
+        if ((code >= 0x7F && code < 0xA0) || !TTF_GlyphIsProvided(font, (Uint16)code)) {
+            continue;
+        }
+
+        char utf8[3] = {0};
+        if (code < 0x80) {
+            utf8[0] = (char)code;
+        } else {
+            utf8[0] = (char)(0xC0 | (code >> 6));
+            utf8[1] = (char)(0x80 | (code & 0x3F));
+        }
+
+        rendered[i] = TTF_RenderUTF8_Solid(font, utf8, white);
+        if (!rendered[i]) {
+            continue;
+        }
+
+        int minx, maxx, miny, maxy, advance;
+        if (TTF_GlyphMetrics(font, (Uint16)code, &minx, &maxx, &miny, &maxy, &advance) != 0) {
+            advance = rendered[i]->w;
+        }
+
+        int w = rendered[i]->w;
+        int h = rendered[i]->h;
+        if (x + w > ATLAS_WIDTH) {
+            x = 0;
+            y += row_height + 1;
+            row_height = 0;
+        }
+
+        atlas->glyphs[i].x = x;
+        atlas->glyphs[i].y = y;
+        atlas->glyphs[i].w = w;
+        atlas->glyphs[i].h = h;
+        atlas->advance[i] = advance;
+
+        x += w + 1;
+        if (h > row_height) {
+            row_height = h;
+        }
+    }
+
+    // Copy the glyphs onto one transparent sheet and upload it once
+    SDL_Surface *sheet = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_WIDTH, y + row_height, 32,
+                                                        SDL_PIXELFORMAT_ARGB8888);
+    for (int i = 0; i < FONT_ATLAS_GLYPHS; i++) {
+        if (!rendered[i]) {
+            continue;
+        }
+        if (sheet) {
+            SDL_Rect dest = atlas->glyphs[i];
+            SDL_SetSurfaceBlendMode(rendered[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(rendered[i], NULL, sheet, &dest);
+        }
+        SDL_FreeSurface(rendered[i]);
+    }
+    free(rendered);
+
+    if (sheet) {
+        atlas->texture = SDL_CreateTextureFromSurface(renderer, sheet);
+        SDL_FreeSurface(sheet);
+    }
+    if (!atlas->texture) {
+        fprintf(stderr, "Failed to build glyph atlas: %s\n", SDL_GetError());
+        free(atlas);
+        return NULL;
+    }
+
+    SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+    return atlas;
+}
+
+static void free_atlas(font_atlas_t *atlas) {
+    if (!atlas) return;
+
+    if (atlas->texture) {
+        SDL_DestroyTexture(atlas->texture);
+    }
+    free(atlas);
+}
@@ -20,6 +20,25 @@ typedef enum {
     FONT_SIZE_HEADER = 16   // Screen titles, headers
 } font_size_t;
 
+/**
+ * Code points held in a glyph atlas: printable ASCII and Latin-1
+ */
+#define FONT_ATLAS_FIRST  32
+#define FONT_ATLAS_LAST   255
+#define FONT_ATLAS_GLYPHS (FONT_ATLAS_LAST - FONT_ATLAS_FIRST + 1)
+
+/**
+ * Every glyph of one font size rendered once into a single texture.
+ * Glyphs are white and tinted with a color mod when drawn.
+ */
+typedef struct {
+    TTF_Font *font;                        // Font the atlas was built from
+    SDL_Texture *texture;
+    SDL_Rect glyphs[FONT_ATLAS_GLYPHS];    // Source rect (w = 0: not in the font)
+    int advance[FONT_ATLAS_GLYPHS];        // Pen advance in pixels
+    int height;                            // Line height
+} font_atlas_t;
+
 /**
  * Font manager structure
  */
@@ -28,6 +47,7 @@ typedef struct {
     TTF_Font *font_body;     // 12px
     TTF_Font *font_header;   // 16px
     char font_path[256];     // Path to font file
+    font_atlas_t *atlases[3]; // Small, body, header (NULL until built)
 } font_manager_t;
 
 /**
@@ -45,6 +65,62 @@ font_manager_t* fonts_init(const char *font_path);
  */
 void fonts_destroy(font_manager_t *fonts);
 
+/**
+ * Render the glyph atlases for every font size (once, after the
+ * renderer exists). Text in fonts without an atlas is still drawn,
+ * just through SDL_ttf on every call.
+ *
+ * @param fonts Font manager
+ * @param renderer Renderer the atlas textures belong to
+ * @return 1 on success, 0 on failure
+ */
+int fonts_build_atlases(font_manager_t *fonts, SDL_Renderer *renderer);
+
+/**
+ * Find the atlas built for a font
+ *
+ * @param font Font returned by fonts_get()
+ * @return Atlas or NULL if none was built
+ */
+const font_atlas_t* fonts_find_atlas(TTF_Font *font);
+
+/**
+ * Measure text from an atlas
+ *
+ * @param atlas Glyph atlas
+ * @param text UTF-8 text
+ * @param width Output: text width in pixels
+ * @return 1 on success, 0 if a character is not in the atlas
+ */
+int fonts_atlas_measure(const font_atlas_t *atlas, const char *text, int *width);
+
+/**
+ * Find how much of a string fits in a width, leaving room for a suffix
+ * (one pass over the advance table, no layout)
+ *
+ * @param atlas Glyph atlas
+ * @param text UTF-8 text
+ * @param max_width Width available in pixels
+ * @param suffix_width Width kept free after the cut (e.g. for "...")
+ * @return Bytes of text that fit (always on a character boundary),
+ *         -1 if a character before the cut is not in the atlas
+ */
+int fonts_atlas_fit(const font_atlas_t *atlas, const char *text, int max_width,
+                    int suffix_width);
+
+/**
+ * Draw text from an atlas (no allocations)
+ *
+ * @param renderer SDL renderer
+ * @param atlas Glyph atlas
+ * @param text UTF-8 text, every character in the atlas (see fonts_atlas_measure)
+ * @param x Left edge
+ * @param y Top edge
+ * @param color Text color
+ */
+void fonts_atlas_draw(SDL_Renderer *renderer, const font_atlas_t *atlas, const char *text,
+                      int x, int y, SDL_Color color);
+
 /**
  * Get font by size enum
  *
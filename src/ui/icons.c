@@ -1,14 +1,21 @@
 /**
  * icons.c - Icon System Implementation
+ *
+ * The atlas is shelf-packed like the glyph atlases in fonts.c: icons go
+ * left to right in rows ATLAS_WIDTH pixels wide, with a one pixel gap so
+ * scaling never bleeds a neighbour in.
  */
 
 #include "icons.h"
 #include "colors.h"
 #include <SDL_image.h>
+#include <dirent.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#define ATLAS_WIDTH 256
+
 /* ============================================
  * Built-in Icon Pixel Data (16x16)
  * 0 = transparent, 1 = GB_LIGHTEST, 2 = GB_LIGHT
@@ -258,10 +265,44 @@ static const uint8_t ICON_GENERIC[256] = {
  * Helper Functions
  * ============================================ */
 
-static SDL_Texture* create_icon_texture(SDL_Renderer *renderer, const uint8_t *data) {
+// Built-in icons, in icon_id_t order
+static const struct {
+    const char *name;
+    const uint8_t *data;
+} BUILTINS[ICON_ID_BUILTIN_COUNT] = {
+    [ICON_ID_LIGHT_BULB]       = {"light_bulb", ICON_LIGHT_BULB},
+    [ICON_ID_SWITCH_TOGGLE]    = {"switch_toggle", ICON_SWITCH},
+    [ICON_ID_CLIMATE_THERMO]   = {"climate_thermo", ICON_CLIMATE},
+    [ICON_ID_SENSOR_GENERIC]   = {"sensor_generic", ICON_SENSOR},
+    [ICON_ID_AUTOMATION_ROBOT] = {"automation_robot", ICON_AUTOMATION},
+    [ICON_ID_SCRIPT_CODE]      = {"script_code", ICON_SCRIPT},
+    [ICON_ID_SCENE_STARS]      = {"scene_stars", ICON_SCENE},
+    [ICON_ID_STAR_FILLED]      = {"star_filled", ICON_STAR_FILLED},
+    [ICON_ID_STAR_EMPTY]       = {"star_empty", ICON_STAR_EMPTY},
+    [ICON_ID_WIFI_ON]          = {"wifi_on", ICON_WIFI_ON},
+    [ICON_ID_WIFI_OFF]         = {"wifi_off", ICON_WIFI_OFF},
+    [ICON_ID_GENERIC]          = {"generic", ICON_GENERIC},
+};
+
+// Entity domains with their own icon (anything else is generic)
+static const struct {
+    const char *domain;
+    icon_id_t icon;
+} DOMAIN_ICONS[] = {
+    {"light", ICON_ID_LIGHT_BULB},
+    {"switch", ICON_ID_SWITCH_TOGGLE},
+    {"climate", ICON_ID_CLIMATE_THERMO},
+    {"sensor", ICON_ID_SENSOR_GENERIC},
+    {"binary_sensor", ICON_ID_SENSOR_GENERIC},
+    {"automation", ICON_ID_AUTOMATION_ROBOT},
+    {"script", ICON_ID_SCRIPT_CODE},
+    {"scene", ICON_ID_SCENE_STARS},
+};
+
+static SDL_Surface* create_icon_surface(const uint8_t *data) {
     // Create surface
     SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(
-        0, 16, 16, 32, SDL_PIXELFORMAT_RGBA8888
+        0, 16, 16, 32, SDL_PIXELFORMAT_ARGB8888
     );
     if (!surface) {
         return NULL;
@@ -286,27 +327,114 @@ static SDL_Texture* create_icon_texture(SDL_Renderer *renderer, const uint8_t *d
         }
     }
 
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_FreeSurface(surface);
+    return surface;
+}
 
-    if (texture) {
-        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+static int find_icon(icon_manager_t *icons, const char *name) {
+    for (int i = 0; i < icons->icon_count; i++) {
+        if (strcmp(icons->icons[i].name, name) == 0) {
+            return i;
+        }
     }
+    return -1;
+}
 
-    return texture;
+static void add_icon(icon_manager_t *icons, const char *name, SDL_Surface *surface,
+                     SDL_Surface **surfaces) {
+    snprintf(icons->icons[icons->icon_count].name, sizeof(icons->icons[0].name), "%s", name);
+    surfaces[icons->icon_count] = surface;
+    icons->icon_count++;
 }
 
-static void cache_icon(icon_manager_t *icons, const char *name, SDL_Texture *texture) {
-    if (icons->icon_count >= MAX_ICONS) {
+/**
+ * Load every PNG in the icons directory whose name is free, after the
+ * built-in icons (which keep their names)
+ */
+static void load_file_icons(icon_manager_t *icons, SDL_Surface **surfaces) {
+    DIR *dir = opendir(icons->base_path);
+    if (!dir) {
         return;
     }
 
-    strncpy(icons->icons[icons->icon_count].name, name, 31);
-    icons->icons[icons->icon_count].name[31] = '\0';
-    icons->icons[icons->icon_count].texture = texture;
-    icons->icons[icons->icon_count].width = 16;
-    icons->icons[icons->icon_count].height = 16;
-    icons->icon_count++;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) && icons->icon_count < MAX_ICONS) {
+        char name[32];
+        size_t len = strlen(entry->d_name);
+        if (len <= 4 || len - 4 >= sizeof(name) || strcmp(entry->d_name + len - 4, ".png") != 0) {
+            continue;
+        }
+        memcpy(name, entry->d_name, len - 4);
+        name[len - 4] = '\0';
+        if (find_icon(icons, name) >= 0) {
+            continue;
+        }
+
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", icons->base_path, entry->d_name);
+        SDL_Surface *loaded = IMG_Load(path);
+        SDL_Surface *surface = loaded ?
+            SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0) : NULL;
+        SDL_FreeSurface(loaded);
+
+        if (!surface || surface->w > ATLAS_WIDTH) {
+            fprintf(stderr, "Skipping icon %s\n", path);
+            SDL_FreeSurface(surface);
+            continue;
+        }
+        add_icon(icons, name, surface, surfaces);
+    }
+
+    closedir(dir);
+}
+
+/**
+ * Place every icon, copy them onto one sheet and upload it
+ */
+static int build_atlas(icon_manager_t *icons, SDL_Surface **surfaces) {
+    int x = 0, y = 0, row_height = 0;
+    for (int i = 0; i < icons->icon_count; i++) {
+        int w = surfaces[i] ? surfaces[i]->w : 0;
+        int h = surfaces[i] ? surfaces[i]->h : 0;
+        if (x + w > ATLAS_WIDTH) {
+            x = 0;
+            y += row_height + 1;
+            row_height = 0;
+        }
+
+        SDL_Rect rect = {x, y, w, h};
+        icons->icons[i].rect = rect;
+
+        x += w + 1;
+        if (h > row_height) {
+            row_height = h;
+        }
+    }
+
+    SDL_Surface *sheet = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_WIDTH, y + row_height, 32,
+                                                        SDL_PIXELFORMAT_ARGB8888);
+    for (int i = 0; i < icons->icon_count; i++) {
+        if (!surfaces[i]) {
+            continue;
+        }
+        if (sheet) {
+            SDL_Rect dest = icons->icons[i].rect;
+            SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(surfaces[i], NULL, sheet, &dest);
+        }
+        SDL_FreeSurface(surfaces[i]);
+    }
+
+    if (sheet) {
+        icons->atlas = SDL_CreateTextureFromSurface(icons->renderer, sheet);
+        SDL_FreeSurface(sheet);
+    }
+    if (!icons->atlas) {
+        fprintf(stderr, "Failed to build icon atlas: %s\n", SDL_GetError());
+        return 0;
+    }
+
+    SDL_SetTextureBlendMode(icons->atlas, SDL_BLENDMODE_BLEND);
+    return 1;
 }
 
 /* ============================================
@@ -332,10 +460,20 @@ icon_manager_t* icons_init(SDL_Renderer *renderer, const char *base_path) {
         strcpy(icons->base_path, "assets/icons");
     }
 
-    // Generate built-in icons
-    icons_generate_builtin(icons);
+    // Built-in icons take the first IDs, files the rest
+    SDL_Surface *surfaces[MAX_ICONS] = {0};
+    for (int i = 0; i < ICON_ID_BUILTIN_COUNT; i++) {
+        add_icon(icons, BUILTINS[i].name, create_icon_surface(BUILTINS[i].data), surfaces);
+    }
+    load_file_icons(icons, surfaces);
 
-    printf("Icon system initialized (%d built-in icons)\n", icons->icon_count);
+    if (!build_atlas(icons, surfaces)) {
+        free(icons);
+        return NULL;
+    }
+
+    printf("Icon system initialized (%d built-in, %d from files)\n",
+           ICON_ID_BUILTIN_COUNT, icons->icon_count - ICON_ID_BUILTIN_COUNT);
 
     return icons;
 }
@@ -343,121 +481,52 @@ icon_manager_t* icons_init(SDL_Renderer *renderer, const char *base_path) {
 void icons_destroy(icon_manager_t *icons) {
     if (!icons) return;
 
-    for (int i = 0; i < icons->icon_count; i++) {
-        if (icons->icons[i].texture) {
-            SDL_DestroyTexture(icons->icons[i].texture);
-        }
+    if (icons->atlas) {
+        SDL_DestroyTexture(icons->atlas);
     }
 
     free(icons);
 }
 
-SDL_Texture* icons_get(icon_manager_t *icons, const char *name) {
-    if (!icons || !name) return NULL;
-
-    // Check cache first
-    for (int i = 0; i < icons->icon_count; i++) {
-        if (strcmp(icons->icons[i].name, name) == 0) {
-            return icons->icons[i].texture;
-        }
-    }
+icon_id_t icons_find(icon_manager_t *icons, const char *name) {
+    if (!icons || !name) return ICON_ID_GENERIC;
 
-    // Try to load from file
-    char path[512];
-    snprintf(path, sizeof(path), "%s/%s.png", icons->base_path, name);
+    int index = find_icon(icons, name);
+    return index >= 0 ? (icon_id_t)index : ICON_ID_GENERIC;
+}
 
-    SDL_Surface *surface = IMG_Load(path);
-    if (surface) {
-        SDL_Texture *texture = SDL_CreateTextureFromSurface(icons->renderer, surface);
-        SDL_FreeSurface(surface);
+void icons_draw(icon_manager_t *icons, icon_id_t id, int x, int y, int size) {
+    if (!icons || !icons->atlas) return;
 
-        if (texture) {
-            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
-            cache_icon(icons, name, texture);
-            return texture;
-        }
+    if ((int)id < 0 || (int)id >= icons->icon_count) {
+        id = ICON_ID_GENERIC;
     }
 
-    // Return generic icon as fallback
-    return icons_get(icons, "generic");
-}
-
-void icons_draw(icon_manager_t *icons, const char *name, int x, int y, int size) {
-    SDL_Texture *texture = icons_get(icons, name);
-    if (!texture) return;
-
     SDL_Rect dest = {x, y, size, size};
-    SDL_RenderCopy(icons->renderer, texture, NULL, &dest);
+    SDL_RenderCopy(icons->renderer, icons->atlas, &icons->icons[id].rect, &dest);
 }
 
-const char* icons_get_for_domain(const char *entity_id) {
-    if (!entity_id) return "generic";
+icon_id_t icons_get_for_domain(const char *entity_id) {
+    if (!entity_id) return ICON_ID_GENERIC;
 
     // Extract domain from entity_id (before '.')
     const char *dot = strchr(entity_id, '.');
-    if (!dot) return "generic";
+    if (!dot) return ICON_ID_GENERIC;
 
     size_t len = dot - entity_id;
-    if (len >= 32) return "generic";
-
-    // Match domain to icon
-    if (strncmp(entity_id, "light", len) == 0) return "light_bulb";
-    if (strncmp(entity_id, "switch", len) == 0) return "switch_toggle";
-    if (strncmp(entity_id, "climate", len) == 0) return "climate_thermo";
-    if (strncmp(entity_id, "sensor", len) == 0) return "sensor_generic";
-    if (strncmp(entity_id, "binary_sensor", len) == 0) return "sensor_generic";
-    if (strncmp(entity_id, "cover", len) == 0) return "generic";
-    if (strncmp(entity_id, "fan", len) == 0) return "generic";
-    if (strncmp(entity_id, "lock", len) == 0) return "generic";
-    if (strncmp(entity_id, "media_player", len) == 0) return "generic";
-    if (strncmp(entity_id, "camera", len) == 0) return "generic";
-    if (strncmp(entity_id, "automation", len) == 0) return "automation_robot";
-    if (strncmp(entity_id, "script", len) == 0) return "script_code";
-    if (strncmp(entity_id, "scene", len) == 0) return "scene_stars";
-
-    return "generic";
+    for (size_t i = 0; i < sizeof(DOMAIN_ICONS) / sizeof(DOMAIN_ICONS[0]); i++) {
+        if (strncmp(entity_id, DOMAIN_ICONS[i].domain, len) == 0 &&
+            DOMAIN_ICONS[i].domain[len] == '\0') {
+            return DOMAIN_ICONS[i].icon;
+        }
+    }
+
+    return ICON_ID_GENERIC;
 }
 
-const char* icons_get_for_state(const char *entity_id, const char *state) {
+icon_id_t icons_get_for_state(const char *entity_id, const char *state) {
     // For now, just return domain icon
     // Future: could return state-specific icons (e.g., light_on/light_off)
     (void)state;
     return icons_get_for_domain(entity_id);
 }
-
-void icons_preload(icon_manager_t *icons) {
-    // Built-in icons are already loaded in icons_generate_builtin
-    // This could be used to pre-load additional PNG icons
-    (void)icons;
-}
-
-void icons_generate_builtin(icon_manager_t *icons) {
-    if (!icons || !icons->renderer) return;
-
-    // Generate all built-in icons
-    struct {
-        const char *name;
-        const uint8_t *data;
-    } builtins[] = {
-        {"light_bulb", ICON_LIGHT_BULB},
-        {"switch_toggle", ICON_SWITCH},
-        {"climate_thermo", ICON_CLIMATE},
-        {"sensor_generic", ICON_SENSOR},
-        {"automation_robot", ICON_AUTOMATION},
-        {"script_code", ICON_SCRIPT},
-        {"scene_stars", ICON_SCENE},
-        {"star_filled", ICON_STAR_FILLED},
-        {"star_empty", ICON_STAR_EMPTY},
-        {"wifi_on", ICON_WIFI_ON},
-        {"wifi_off", ICON_WIFI_OFF},
-        {"generic", ICON_GENERIC},
-        {NULL, NULL}
-    };
-
-    for (int i = 0; builtins[i].name != NULL; i++) {
-        SDL_Texture *texture = create_icon_texture(icons->renderer, builtins[i].data);
-        if (texture) {
-            cache_icon(icons, builtins[i].name, texture);
-        }
-    }
-}
@@ -1,7 +1,7 @@
 /**
  * icons.h - Icon System for Home Assistant Companion
  *
- * Icon loading, caching, and domain mapping.
+ * Icon atlas, IDs and domain mapping.
  * Phase 4: UI Design System
  */
 
@@ -11,7 +11,7 @@
 #include <SDL.h>
 
 /**
- * Maximum number of cached icons
+ * Maximum number of icons (built-in plus files)
  */
 #define MAX_ICONS 64
 
@@ -22,27 +22,50 @@
 #define ICON_SIZE_LARGE  32
 
 /**
- * Icon cache entry
+ * Built-in icons. PNG files in the icons directory whose names are not
+ * taken get the IDs after ICON_ID_BUILTIN_COUNT (see icons_find()).
+ */
+typedef enum {
+    ICON_ID_LIGHT_BULB,
+    ICON_ID_SWITCH_TOGGLE,
+    ICON_ID_CLIMATE_THERMO,
+    ICON_ID_SENSOR_GENERIC,
+    ICON_ID_AUTOMATION_ROBOT,
+    ICON_ID_SCRIPT_CODE,
+    ICON_ID_SCENE_STARS,
+    ICON_ID_STAR_FILLED,
+    ICON_ID_STAR_EMPTY,
+    ICON_ID_WIFI_ON,
+    ICON_ID_WIFI_OFF,
+    ICON_ID_GENERIC,
+    ICON_ID_BUILTIN_COUNT
+} icon_id_t;
+
+/**
+ * Icon entry: where the icon sits in the atlas
  */
 typedef struct {
     char name[32];
-    SDL_Texture *texture;
-    int width;
-    int height;
+    SDL_Rect rect;
 } icon_t;
 
 /**
  * Icon manager structure
+ * Every icon is packed into one texture when the manager is created;
+ * drawing one is a single copy from its rect.
  */
 typedef struct {
     SDL_Renderer *renderer;
-    icon_t icons[MAX_ICONS];
+    SDL_Texture *atlas;
+    icon_t icons[MAX_ICONS];   // Indexed by icon ID
     int icon_count;
     char base_path[256];
 } icon_manager_t;
 
 /**
  * Initialize icon manager
+ * Generates the built-in icons, loads every PNG in base_path and packs
+ * them all into the atlas.
  *
  * @param renderer SDL renderer for texture creation
  * @param base_path Path to icons directory (e.g., "assets/icons")
@@ -51,62 +74,47 @@ typedef struct {
 icon_manager_t* icons_init(SDL_Renderer *renderer, const char *base_path);
 
 /**
- * Destroy icon manager and free all cached textures
+ * Destroy icon manager and its atlas
  *
  * @param icons Icon manager to destroy
  */
 void icons_destroy(icon_manager_t *icons);
 
 /**
- * Load or get cached icon by name
+ * Look up an icon by name (resolve once, then draw by ID)
  *
  * @param icons Icon manager
  * @param name Icon name (without path or extension)
- * @return SDL_Texture pointer or NULL if not found
+ * @return Icon ID, ICON_ID_GENERIC if there is no such icon
  */
-SDL_Texture* icons_get(icon_manager_t *icons, const char *name);
+icon_id_t icons_find(icon_manager_t *icons, const char *name);
 
 /**
  * Draw icon at position
  *
  * @param icons Icon manager
- * @param name Icon name
+ * @param id Icon ID (unknown IDs draw the generic icon)
  * @param x X position
  * @param y Y position
  * @param size Size in pixels (will scale if needed)
  */
-void icons_draw(icon_manager_t *icons, const char *name, int x, int y, int size);
+void icons_draw(icon_manager_t *icons, icon_id_t id, int x, int y, int size);
 
 /**
- * Get icon name for entity domain
+ * Get icon for entity domain
  *
  * @param entity_id Full entity ID (e.g., "light.living_room")
- * @return Icon name string (static, do not free)
+ * @return Built-in icon ID
  */
-const char* icons_get_for_domain(const char *entity_id);
+icon_id_t icons_get_for_domain(const char *entity_id);
 
 /**
- * Get icon name for entity state
+ * Get icon for entity state
  *
  * @param entity_id Full entity ID
  * @param state Entity state string
- * @return Icon name string (static, do not free)
- */
-const char* icons_get_for_state(const char *entity_id, const char *state);
-
-/**
- * Preload essential icons
- *
- * @param icons Icon manager
- */
-void icons_preload(icon_manager_t *icons);
-
-/**
- * Generate built-in icons programmatically
- * Call this to create default icons if PNG files don't exist
- *
- * @param icons Icon manager
+ * @return Built-in icon ID
  */
-void icons_generate_builtin(icon_manager_t *icons);
+icon_id_t icons_get_for_state(const char *entity_id, const char *state);
 
 #endif // ICONS_H
@@ -0,0 +1,187 @@
+/**
+ * text_cache.c - Rendered Text Texture Cache Implementation
+ *
+ * Entries live in a fixed array linked two ways by index: a doubly
+ * linked LRU list for eviction and per-bucket chains for lookup. A hit
+ * costs one hash of the string and a compare; nothing is allocated
+ * except the texture on a miss.
+ */
+
+#include "text_cache.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void lru_unlink(text_cache_t *cache, int index);
+static void lru_push_front(text_cache_t *cache, int index);
+static void evict(text_cache_t *cache, int index);
+
+text_cache_t* text_cache_create(SDL_Renderer *renderer) {
+    if (!renderer) {
+        return NULL;
+    }
+
+    text_cache_t *cache = calloc(1, sizeof(text_cache_t));
+    if (!cache) {
+        return NULL;
+    }
+
+    cache->renderer = renderer;
+    cache->head = cache->tail = -1;
+    for (int i = 0; i < TEXT_CACHE_BUCKETS; i++) {
+        cache->buckets[i] = -1;
+    }
+
+    return cache;
+}
+
+void text_cache_destroy(text_cache_t *cache) {
+    if (!cache) return;
+
+    text_cache_clear(cache);
+    free(cache);
+}
+
+Uint32 text_cache_hash(TTF_Font *font, Uint32 seed, const char *text) {
+    Uint32 hash = 2166136261u ^ (Uint32)(uintptr_t)font ^ seed;
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void text_cache_clear(text_cache_t *cache) {
+    if (!cache) return;
+
+    while (cache->tail >= 0) {
+        evict(cache, cache->tail);
+    }
+}
+
+SDL_Texture* text_cache_get(text_cache_t *cache, TTF_Font *font, const char *text,
+                            SDL_Color color, int *width, int *height) {
+    if (!cache || !font || !text || strlen(text) >= TEXT_CACHE_MAX_TEXT) {
+        return NULL;
+    }
+
+    Uint32 packed = ((Uint32)color.r << 24) | ((Uint32)color.g << 16) |
+                    ((Uint32)color.b << 8) | color.a;
+    Uint32 hash = text_cache_hash(font, packed, text);
+    int bucket = hash & (TEXT_CACHE_BUCKETS - 1);
+
+    for (int i = cache->buckets[bucket]; i >= 0; i = cache->entries[i].chain) {
+        text_cache_entry_t *entry = &cache->entries[i];
+        if (entry->hash == hash && entry->font == font && entry->color == packed &&
+            strcmp(entry->text, text) == 0) {
+            cache->hits++;
+            if (cache->head != i) {
+                lru_unlink(cache, i);
+                lru_push_front(cache, i);
+            }
+            if (width) *width = entry->width;
+            if (height) *height = entry->height;
+            return entry->texture;
+        }
+    }
+
+    cache->misses++;
+
+    SDL_Surface *surface = TTF_RenderUTF8_Solid(font, text, color);
+    if (!surface) {
+        return NULL;
+    }
+
+    size_t bytes = (size_t)surface->w * surface->h * 4;
+    while (cache->tail >= 0 &&
+           (cache->count >= TEXT_CACHE_MAX_ENTRIES || cache->bytes + bytes > TEXT_CACHE_MAX_BYTES)) {
+        evict(cache, cache->tail);
+        cache->evictions++;
+    }
+
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(cache->renderer, surface);
+    int w = surface->w;
+    int h = surface->h;
+    SDL_FreeSurface(surface);
+    if (!texture) {
+        return NULL;
+    }
+
+    // Any free slot will do; order is kept by the LRU list
+    int slot = 0;
+    while (cache->entries[slot].font) {
+        slot++;
+    }
+
+    text_cache_entry_t *entry = &cache->entries[slot];
+    entry->font = font;
+    entry->color = packed;
+    entry->hash = hash;
+    strcpy(entry->text, text);
+    entry->texture = texture;
+    entry->width = w;
+    entry->height = h;
+    entry->chain = cache->buckets[bucket];
+    cache->buckets[bucket] = slot;
+    lru_push_front(cache, slot);
+    cache->count++;
+    cache->bytes += bytes;
+
+    if (width) *width = w;
+    if (height) *height = h;
+    return texture;
+}
+
+/* ============================================
+ * Static Helper Functions
+ * ============================================ */
+
+static void lru_unlink(text_cache_t *cache, int index) {
+    text_cache_entry_t *entry = &cache->entries[index];
+
+    if (entry->prev >= 0) {
+        cache->entries[entry->prev].next = entry->next;
+    } else {
+        cache->head = entry->next;
+    }
+    if (entry->next >= 0) {
+        cache->entries[entry->next].prev = entry->prev;
+    } else {
+        cache->tail = entry->prev;
+    }
+}
+
+static void lru_push_front(text_cache_t *cache, int index) {
+    text_cache_entry_t *entry = &cache->entries[index];
+
+    entry->prev = -1;
+    entry->next = cache->head;
+    if (cache->head >= 0) {
+        cache->entries[cache->head].prev = index;
+    }
+    cache->head = index;
+    if (cache->tail < 0) {
+        cache->tail = index;
+    }
+}
+
+/**
+ * Remove an entry from both lists and free its texture
+ */
+static void evict(text_cache_t *cache, int index) {
+    text_cache_entry_t *entry = &cache->entries[index];
+
+    int *link = &cache->buckets[entry->hash & (TEXT_CACHE_BUCKETS - 1)];
+    while (*link != index) {
+        link = &cache->entries[*link].chain;
+    }
+    *link = entry->chain;
+
+    lru_unlink(cache, index);
+    cache->bytes -= (size_t)entry->width * entry->height * 4;
+    cache->count--;
+
+    SDL_DestroyTexture(entry->texture);
+    memset(entry, 0, sizeof(*entry));
+}
@@ -0,0 +1,114 @@
+/**
+ * text_cache.h - Rendered Text Texture Cache
+ *
+ * Keeps the textures of recently drawn strings, keyed by font, color
+ * and text, so a string that is on screen frame after frame is rendered
+ * by SDL_ttf and uploaded only once. Least recently used entries are
+ * evicted when either the entry count or the texture memory cap is
+ * reached.
+ *
+ * Text drawn from a glyph atlas never gets here (see fonts.h); this
+ * serves the strings the atlas cannot hold.
+ */
+
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <stddef.h>
+
+/**
+ * Capacity: entries, hash buckets (power of two) and texture memory.
+ * 512 KB is about 40 full-width lines of body text, a small share of
+ * what the device's framebuffer-backed renderer can spare.
+ */
+#define TEXT_CACHE_MAX_ENTRIES 128
+#define TEXT_CACHE_BUCKETS     256
+#define TEXT_CACHE_MAX_BYTES   (512 * 1024)
+
+/**
+ * Longest string cached (longer ones are rendered per call)
+ */
+#define TEXT_CACHE_MAX_TEXT 128
+
+/**
+ * Cached texture of one string
+ */
+typedef struct {
+    TTF_Font *font;             // NULL: slot unused
+    Uint32 color;               // Packed RGBA
+    Uint32 hash;
+    char text[TEXT_CACHE_MAX_TEXT];
+    SDL_Texture *texture;
+    int width;
+    int height;
+    int prev, next;             // LRU list, most recent first (-1: none)
+    int chain;                  // Next entry in the same bucket (-1: none)
+} text_cache_entry_t;
+
+/**
+ * Text cache structure
+ */
+typedef struct {
+    SDL_Renderer *renderer;
+    text_cache_entry_t entries[TEXT_CACHE_MAX_ENTRIES];
+    int buckets[TEXT_CACHE_BUCKETS]; // First entry per bucket (-1: empty)
+    int head, tail;             // Most and least recently used (-1: empty)
+    int count;
+    size_t bytes;               // Texture memory held (4 bytes per pixel)
+
+    // Counters since creation
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+} text_cache_t;
+
+/**
+ * Create text cache
+ *
+ * @param renderer Renderer the textures are created for
+ * @return text_cache_t pointer or NULL on failure
+ */
+text_cache_t* text_cache_create(SDL_Renderer *renderer);
+
+/**
+ * Destroy text cache and its textures
+ *
+ * @param cache Cache to destroy (can be NULL)
+ */
+void text_cache_destroy(text_cache_t *cache);
+
+/**
+ * Get the texture of a string, rendering it on a miss
+ *
+ * @param cache Text cache
+ * @param font Font
+ * @param text UTF-8 text
+ * @param color Text color
+ * @param width Output: texture width
+ * @param height Output: texture height
+ * @return Texture owned by the cache (valid until the next call), or NULL
+ *         if the text cannot be cached (too long, too large, render failed)
+ */
+SDL_Texture* text_cache_get(text_cache_t *cache, TTF_Font *font, const char *text,
+                            SDL_Color color, int *width, int *height);
+
+/**
+ * Hash a string for a cache key (FNV-1a seeded with font and a value)
+ *
+ * @param font Font
+ * @param seed Packed color, width or other value the key depends on
+ * @param text Text
+ * @return Hash
+ */
+Uint32 text_cache_hash(TTF_Font *font, Uint32 seed, const char *text);
+
+/**
+ * Drop every cached texture (counters are kept)
+ *
+ * @param cache Text cache
+ */
+void text_cache_clear(text_cache_t *cache);
+
+#endif // TEXT_CACHE_H
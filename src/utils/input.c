@@ -33,7 +33,7 @@ typedef struct {
     int current;        // Current frame state (1 = down, 0 = up)
     int previous;       // Previous frame state
     Uint32 press_time;  // SDL tick time when button was first pressed
-    Uint32 last_repeat; // SDL tick time of last repeat trigger
+    Uint32 last_repeat; // Scheduled tick of the last repeat (0 = none yet)
 } button_state_t;
 
 // Button state array
@@ -143,21 +143,47 @@ int input_button_repeat(button_t button) {
         return 0;
     }
 
-    // Check if enough time has passed since last repeat
+    // Repeats fall on press + delay + n * rate, however late the frame
+    // that checks them is (input_repeat_timeout() wakes on that schedule)
     if (state->last_repeat == 0) {
         // First repeat after delay
-        state->last_repeat = now;
+        state->last_repeat = state->press_time + KEY_REPEAT_DELAY;
         return 1;
     }
 
-    if (now - state->last_repeat >= KEY_REPEAT_RATE) {
-        state->last_repeat = now;
+    Uint32 since = now - state->last_repeat;
+    if (since >= KEY_REPEAT_RATE) {
+        // Skip repeats a stalled frame missed instead of bursting them
+        state->last_repeat += since - since % KEY_REPEAT_RATE;
         return 1;
     }
 
     return 0;
 }
 
+int input_repeat_timeout(void) {
+    Uint32 now = SDL_GetTicks();
+    int timeout = -1;
+
+    for (int i = 0; i < BTN_COUNT; i++) {
+        if (!button_states[i].current) {
+            continue;
+        }
+
+        // Repeats fall on press + delay + n * rate
+        Uint32 held_time = now - button_states[i].press_time;
+        int until = (held_time < KEY_REPEAT_DELAY) ?
+            (int)(KEY_REPEAT_DELAY - held_time) :
+            KEY_REPEAT_RATE - (int)((held_time - KEY_REPEAT_DELAY) % KEY_REPEAT_RATE);
+
+        if (timeout < 0 || until < timeout) {
+            timeout = until;
+        }
+    }
+
+    return timeout;
+}
+
 void input_reset(void) {
     for (int i = 0; i < BTN_COUNT; i++) {
         button_states[i].previous = button_states[i].current;
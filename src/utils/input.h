@@ -11,7 +11,8 @@
  * - X Button: Filter / Sort
  * - Y Button: Alternative actions
  * - L1/R1: Tab navigation
- * - L2/R2: Reserved for future features
+ * - R2: Search
+ * - L2: Sync diagnostics
  * - Select: View details / Enter entity detail screen
  * - Start: Quick menu / Refresh
  * - Menu: Exit confirmation dialog
@@ -86,6 +87,14 @@ int input_button_down(button_t button);
  */
 int input_button_repeat(button_t button);
 
+/**
+ * Time until the next key repeat of any held button is due
+ * For an event loop that sleeps between frames.
+ *
+ * @return Milliseconds, or -1 if no button is held
+ */
+int input_repeat_timeout(void);
+
 /**
  * Reset all button states
  * Call at the end of each frame
@@ -193,6 +193,28 @@ ha_entity_t** parse_entities_array(const char *json_string, int *count) {
     return entities;
 }
 
+ha_entity_t* copy_entity(const ha_entity_t *entity) {
+    if (!entity) {
+        return NULL;
+    }
+
+    ha_entity_t *copy = malloc(sizeof(ha_entity_t));
+    if (!copy) {
+        return NULL;
+    }
+
+    *copy = *entity;
+    if (entity->attributes_json) {
+        copy->attributes_json = strdup(entity->attributes_json);
+        if (!copy->attributes_json) {
+            free(copy);
+            return NULL;
+        }
+    }
+
+    return copy;
+}
+
 void free_entity(ha_entity_t *entity) {
     if (entity) {
         if (entity->attributes_json) {
@@ -210,3 +232,34 @@ void free_entities(ha_entity_t **entities, int count) {
         free(entities);
     }
 }
+
+char* json_merge_objects(const char *base_json, const char *overlay_json) {
+    cJSON *overlay = overlay_json ? cJSON_Parse(overlay_json) : NULL;
+    if (!cJSON_IsObject(overlay)) {
+        cJSON_Delete(overlay);
+        return NULL;
+    }
+
+    cJSON *base = base_json ? cJSON_Parse(base_json) : NULL;
+    if (!cJSON_IsObject(base)) {
+        cJSON_Delete(base);
+        base = cJSON_CreateObject();
+    }
+
+    char *merged = NULL;
+    if (base) {
+        cJSON *item = overlay->child;
+        while (item) {
+            cJSON *next = item->next;
+            cJSON_DetachItemViaPointer(overlay, item);
+            cJSON_DeleteItemFromObjectCaseSensitive(base, item->string);
+            cJSON_AddItemToObject(base, item->string, item);
+            item = next;
+        }
+        merged = cJSON_PrintUnformatted(base);
+    }
+
+    cJSON_Delete(base);
+    cJSON_Delete(overlay);
+    return merged;
+}
@@ -62,6 +62,14 @@ ha_entity_t* parse_single_entity(const char *json_string);
  */
 ha_entity_t* parse_entity_from_json(cJSON *json);
 
+/**
+ * Deep-copy an entity (including attributes)
+ *
+ * @param entity Entity to copy
+ * @return New entity (caller must free with free_entity) or NULL on error
+ */
+ha_entity_t* copy_entity(const ha_entity_t *entity);
+
 /**
  * Free single entity and its attributes
  *
@@ -97,6 +105,15 @@ const char* json_get_string(cJSON *obj, const char *key, const char *default_val
  */
 int json_get_int(cJSON *obj, const char *key, int default_val);
 
+/**
+ * Overlay the members of one JSON object onto another
+ *
+ * @param base_json Object to start from (NULL or invalid: empty object)
+ * @param overlay_json Object whose members are added or replaced
+ * @return Merged object as a new string (caller must free), NULL on error
+ */
+char* json_merge_objects(const char *base_json, const char *overlay_json);
+
 /**
  * Extract domain from entity_id (e.g., "light" from "light.living_room")
  *
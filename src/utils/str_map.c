@@ -0,0 +1,185 @@
+/**
+ * str_map.c - String-keyed Hash Map Implementation
+ *
+ * Linear probing with backward-shift deletion, so there are no
+ * tombstones and lookups stay short after many removals.
+ */
+
+#include "str_map.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define STR_MAP_MIN_CAPACITY 16
+
+/**
+ * FNV-1a string hash
+ */
+static unsigned int hash_string(const char *key) {
+    unsigned int hash = 2166136261u;
+    while (*key) {
+        hash ^= (unsigned char)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int round_up_capacity(int n) {
+    int capacity = STR_MAP_MIN_CAPACITY;
+    while (capacity < n) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+/**
+ * Find slot for key: returns the slot holding key, or the empty slot
+ * where it would be inserted.
+ */
+static int find_slot(const str_map_t *map, const char *key) {
+    int mask = map->capacity - 1;
+    int slot = (int)(hash_string(key) & (unsigned int)mask);
+
+    while (map->keys[slot] && strcmp(map->keys[slot], key) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static int grow(str_map_t *map) {
+    // str_map_init doubles the requested size, so this doubles capacity
+    str_map_t bigger;
+    if (!str_map_init(&bigger, map->capacity)) {
+        return 0;
+    }
+
+    for (int i = 0; i < map->capacity; i++) {
+        if (map->keys[i]) {
+            int slot = find_slot(&bigger, map->keys[i]);
+            bigger.keys[slot] = map->keys[i];   // Move key ownership
+            bigger.values[slot] = map->values[i];
+            bigger.count++;
+        }
+    }
+
+    free(map->keys);
+    free(map->values);
+    *map = bigger;
+    return 1;
+}
+
+int str_map_init(str_map_t *map, int initial_capacity) {
+    if (!map) {
+        return 0;
+    }
+
+    // Keep load factor under 0.5 for the expected size
+    map->capacity = round_up_capacity(initial_capacity * 2);
+    map->count = 0;
+    map->keys = calloc(map->capacity, sizeof(char *));
+    map->values = calloc(map->capacity, sizeof(int));
+
+    if (!map->keys || !map->values) {
+        free(map->keys);
+        free(map->values);
+        memset(map, 0, sizeof(*map));
+        return 0;
+    }
+
+    return 1;
+}
+
+void str_map_free(str_map_t *map) {
+    if (!map) return;
+
+    str_map_clear(map);
+    free(map->keys);
+    free(map->values);
+    memset(map, 0, sizeof(*map));
+}
+
+void str_map_clear(str_map_t *map) {
+    if (!map || !map->keys) return;
+
+    for (int i = 0; i < map->capacity; i++) {
+        free(map->keys[i]);
+        map->keys[i] = NULL;
+    }
+    map->count = 0;
+}
+
+int str_map_put(str_map_t *map, const char *key, int value) {
+    if (!map || !key) {
+        return 0;
+    }
+
+    if (!map->keys && !str_map_init(map, STR_MAP_MIN_CAPACITY)) {
+        return 0;
+    }
+
+    if ((map->count + 1) * 2 > map->capacity && !grow(map)) {
+        return 0;
+    }
+
+    int slot = find_slot(map, key);
+    if (!map->keys[slot]) {
+        map->keys[slot] = strdup(key);
+        if (!map->keys[slot]) {
+            return 0;
+        }
+        map->count++;
+    }
+    map->values[slot] = value;
+
+    return 1;
+}
+
+int str_map_get(const str_map_t *map, const char *key, int *value) {
+    if (!map || !key || !map->keys || map->count == 0) {
+        return 0;
+    }
+
+    int slot = find_slot(map, key);
+    if (!map->keys[slot]) {
+        return 0;
+    }
+
+    if (value) {
+        *value = map->values[slot];
+    }
+    return 1;
+}
+
+int str_map_remove(str_map_t *map, const char *key) {
+    if (!map || !key || !map->keys || map->count == 0) {
+        return 0;
+    }
+
+    int mask = map->capacity - 1;
+    int slot = find_slot(map, key);
+    if (!map->keys[slot]) {
+        return 0;
+    }
+
+    free(map->keys[slot]);
+    map->keys[slot] = NULL;
+    map->count--;
+
+    // Backward-shift following entries that probed past the hole
+    int hole = slot;
+    int next = (hole + 1) & mask;
+    while (map->keys[next]) {
+        int home = (int)(hash_string(map->keys[next]) & (unsigned int)mask);
+        // Move if home is not cyclically within (hole, next]
+        int dist_next = (next - home) & mask;
+        int dist_hole = (hole - home) & mask;
+        if (dist_hole < dist_next) {
+            map->keys[hole] = map->keys[next];
+            map->values[hole] = map->values[next];
+            map->keys[next] = NULL;
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+
+    return 1;
+}
@@ -0,0 +1,75 @@
+/**
+ * str_map.h - String-keyed Hash Map
+ *
+ * Small open-addressing hash map from string keys to integer values.
+ * Used for O(1) entity_id lookups (favorites set, entity index) so
+ * render paths never have to query SQLite.
+ */
+
+#ifndef STR_MAP_H
+#define STR_MAP_H
+
+/**
+ * Hash map structure
+ * Keys are copied on insert and owned by the map.
+ */
+typedef struct {
+    char **keys;      // Slot keys (NULL = empty slot)
+    int *values;      // Slot values
+    int capacity;     // Number of slots (power of two)
+    int count;        // Number of occupied slots
+} str_map_t;
+
+/**
+ * Initialize an empty map
+ *
+ * @param map Map to initialize
+ * @param initial_capacity Expected number of keys (rounded up)
+ * @return 1 on success, 0 on allocation failure
+ */
+int str_map_init(str_map_t *map, int initial_capacity);
+
+/**
+ * Free all keys and slot storage
+ *
+ * @param map Map to free (struct itself is not freed)
+ */
+void str_map_free(str_map_t *map);
+
+/**
+ * Remove all keys, keeping the slot storage
+ *
+ * @param map Map to clear
+ */
+void str_map_clear(str_map_t *map);
+
+/**
+ * Insert or update a key
+ *
+ * @param map Map
+ * @param key Key string (copied)
+ * @param value Value to store
+ * @return 1 on success, 0 on allocation failure
+ */
+int str_map_put(str_map_t *map, const char *key, int value);
+
+/**
+ * Look up a key
+ *
+ * @param map Map
+ * @param key Key string
+ * @param value Output: stored value (can be NULL)
+ * @return 1 if found, 0 if not
+ */
+int str_map_get(const str_map_t *map, const char *key, int *value);
+
+/**
+ * Remove a key
+ *
+ * @param map Map
+ * @param key Key string
+ * @return 1 if removed, 0 if not present
+ */
+int str_map_remove(str_map_t *map, const char *key);
+
+#endif // STR_MAP_H
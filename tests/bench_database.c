@@ -0,0 +1,343 @@
+/**
+ * bench_database.c - Database Microbenchmarks
+ *
+ * Times the database.c operations the UI and sync depend on, over
+ * synthetic caches of 100 to 20,000 entities, under three storage
+ * profiles:
+ *
+ *   tmpfs      File database on a RAM-backed filesystem (best case disk)
+ *   throttled  Same file, through a VFS shim that adds SD-card-like
+ *              latency to every sync and write (BENCH_SYNC_US, BENCH_WRITE_US)
+ *   memory     database_open_in_memory() (queries in RAM, snapshot on close)
+ *
+ * Output is one JSON object per line on stdout (progress goes to stderr)
+ * so runs can be diffed and tracked across releases:
+ *   {"profile":"tmpfs","entities":1000,"op":"get_all_entities",
+ *    "ops":1,"min_ms":2.104,"median_ms":2.250,"per_op_us":2250.0}
+ *
+ * Build (CMake):
+ *   cmake -S . -B build -DBUILD_BENCHMARKS=ON && cmake --build build --target bench_database
+ *
+ * Build (standalone):
+ *   gcc -std=gnu99 -O2 -o bench_database tests/bench_database.c src/database.c \
+ *       src/utils/json_helpers.c -Isrc -lsqlite3 -lcjson -lpthread
+ *
+ * Run:
+ *   ./bench_database [directory]   (default: /dev/shm, falls back to /tmp)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "database.h"
+
+#define RUNS 5
+#define LOOKUPS 1000
+#define MAX_AREA_UPDATES 200
+
+static const int SIZES[] = {100, 1000, 5000, 20000};
+#define SIZE_COUNT ((int)(sizeof(SIZES) / sizeof(SIZES[0])))
+
+static const char *DOMAINS[] = {
+    "light", "sensor", "switch", "binary_sensor", "automation", "climate", "fan", "update"
+};
+
+/* ============================================
+ * Throttled VFS
+ * ============================================ */
+
+static int sync_delay_us = 8000;    // Typical SD card fsync
+static int write_delay_us = 150;    // Per write call
+
+typedef struct {
+    sqlite3_file base;
+    sqlite3_file *real;             // Default VFS file, allocated after this struct
+} throttled_file_t;
+
+static sqlite3_vfs *default_vfs;
+static sqlite3_vfs throttled_vfs;
+static sqlite3_io_methods throttled_io;
+
+#define REAL(f) (((throttled_file_t *)(f))->real)
+
+static int t_close(sqlite3_file *f) { return REAL(f)->pMethods->xClose(REAL(f)); }
+static int t_read(sqlite3_file *f, void *buf, int n, sqlite3_int64 off) {
+    return REAL(f)->pMethods->xRead(REAL(f), buf, n, off);
+}
+static int t_write(sqlite3_file *f, const void *buf, int n, sqlite3_int64 off) {
+    usleep(write_delay_us);
+    return REAL(f)->pMethods->xWrite(REAL(f), buf, n, off);
+}
+static int t_truncate(sqlite3_file *f, sqlite3_int64 size) {
+    return REAL(f)->pMethods->xTruncate(REAL(f), size);
+}
+static int t_sync(sqlite3_file *f, int flags) {
+    usleep(sync_delay_us);
+    return REAL(f)->pMethods->xSync(REAL(f), flags);
+}
+static int t_file_size(sqlite3_file *f, sqlite3_int64 *size) {
+    return REAL(f)->pMethods->xFileSize(REAL(f), size);
+}
+static int t_lock(sqlite3_file *f, int lock) { return REAL(f)->pMethods->xLock(REAL(f), lock); }
+static int t_unlock(sqlite3_file *f, int lock) { return REAL(f)->pMethods->xUnlock(REAL(f), lock); }
+static int t_check_lock(sqlite3_file *f, int *out) {
+    return REAL(f)->pMethods->xCheckReservedLock(REAL(f), out);
+}
+static int t_file_control(sqlite3_file *f, int op, void *arg) {
+    return REAL(f)->pMethods->xFileControl(REAL(f), op, arg);
+}
+static int t_sector_size(sqlite3_file *f) { return REAL(f)->pMethods->xSectorSize(REAL(f)); }
+static int t_device_chars(sqlite3_file *f) {
+    return REAL(f)->pMethods->xDeviceCharacteristics(REAL(f));
+}
+static int t_shm_map(sqlite3_file *f, int pg, int pgsz, int extend, void volatile **pp) {
+    return REAL(f)->pMethods->xShmMap(REAL(f), pg, pgsz, extend, pp);
+}
+static int t_shm_lock(sqlite3_file *f, int offset, int n, int flags) {
+    return REAL(f)->pMethods->xShmLock(REAL(f), offset, n, flags);
+}
+static void t_shm_barrier(sqlite3_file *f) { REAL(f)->pMethods->xShmBarrier(REAL(f)); }
+static int t_shm_unmap(sqlite3_file *f, int del) {
+    return REAL(f)->pMethods->xShmUnmap(REAL(f), del);
+}
+
+static int t_open(sqlite3_vfs *vfs, const char *name, sqlite3_file *file, int flags, int *out) {
+    (void)vfs;
+    throttled_file_t *tf = (throttled_file_t *)file;
+    tf->real = (sqlite3_file *)(tf + 1);
+
+    int rc = default_vfs->xOpen(default_vfs, name, tf->real, flags, out);
+    if (rc != SQLITE_OK) {
+        tf->base.pMethods = NULL;
+        return rc;
+    }
+
+    // Expose WAL shared memory only if the real file supports it
+    throttled_io.iVersion = tf->real->pMethods->iVersion >= 2 ? 2 : 1;
+    tf->base.pMethods = &throttled_io;
+    return SQLITE_OK;
+}
+
+static void register_throttled_vfs(void) {
+    default_vfs = sqlite3_vfs_find(NULL);
+    throttled_vfs = *default_vfs;
+    throttled_vfs.zName = "throttled";
+    throttled_vfs.szOsFile = (int)sizeof(throttled_file_t) + default_vfs->szOsFile;
+    throttled_vfs.xOpen = t_open;
+    throttled_vfs.pNext = NULL;
+
+    throttled_io.xClose = t_close;
+    throttled_io.xRead = t_read;
+    throttled_io.xWrite = t_write;
+    throttled_io.xTruncate = t_truncate;
+    throttled_io.xSync = t_sync;
+    throttled_io.xFileSize = t_file_size;
+    throttled_io.xLock = t_lock;
+    throttled_io.xUnlock = t_unlock;
+    throttled_io.xCheckReservedLock = t_check_lock;
+    throttled_io.xFileControl = t_file_control;
+    throttled_io.xSectorSize = t_sector_size;
+    throttled_io.xDeviceCharacteristics = t_device_chars;
+    throttled_io.xShmMap = t_shm_map;
+    throttled_io.xShmLock = t_shm_lock;
+    throttled_io.xShmBarrier = t_shm_barrier;
+    throttled_io.xShmUnmap = t_shm_unmap;
+
+    sqlite3_vfs_register(&throttled_vfs, 0);
+}
+
+/* ============================================
+ * Timing and Output
+ * ============================================ */
+
+static FILE *results;               // Original stdout (results only)
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *profile, int entities, const char *op,
+                   int ops, double *runs, int run_count) {
+    qsort(runs, run_count, sizeof(double), compare_double);
+    double median = runs[run_count / 2];
+    fprintf(results, "{\"profile\":\"%s\",\"entities\":%d,\"op\":\"%s\",\"ops\":%d,"
+           "\"min_ms\":%.3f,\"median_ms\":%.3f,\"per_op_us\":%.1f}\n",
+           profile, entities, op, ops, runs[0], median, median * 1000.0 / ops);
+    fflush(results);
+}
+
+/* ============================================
+ * Synthetic Data
+ * ============================================ */
+
+static ha_entity_t** make_entities(int count) {
+    ha_entity_t **entities = calloc(count, sizeof(ha_entity_t *));
+    if (!entities) return NULL;
+
+    for (int i = 0; i < count; i++) {
+        ha_entity_t *e = calloc(1, sizeof(ha_entity_t));
+        if (!e) {
+            free_entities(entities, i);
+            return NULL;
+        }
+
+        const char *domain = DOMAINS[i % 8];
+        snprintf(e->entity_id, sizeof(e->entity_id), "%s.bench_%d", domain, i);
+        snprintf(e->friendly_name, sizeof(e->friendly_name), "Bench %s %d", domain, i);
+        snprintf(e->domain, sizeof(e->domain), "%s", domain);
+        snprintf(e->state, sizeof(e->state), "%d.%d", i % 40, i % 10);
+        snprintf(e->last_changed, sizeof(e->last_changed), "2024-01-01T00:00:00+00:00");
+        snprintf(e->last_updated, sizeof(e->last_updated), "2024-01-01T00:00:00+00:00");
+
+        // Typical attribute payload size
+        e->attributes_json = malloc(256);
+        if (e->attributes_json) {
+            snprintf(e->attributes_json, 256,
+                     "{\"friendly_name\":\"Bench %s %d\",\"unit_of_measurement\":\"W\","
+                     "\"device_class\":\"power\",\"state_class\":\"measurement\","
+                     "\"icon\":\"mdi:flash\"}", domain, i);
+        }
+        entities[i] = e;
+    }
+
+    return entities;
+}
+
+/* ============================================
+ * Benchmarks
+ * ============================================ */
+
+static void run_profile(const char *profile, const char *dir) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/bench_%s.db", dir, profile);
+
+    for (int s = 0; s < SIZE_COUNT; s++) {
+        int count = SIZES[s];
+        double runs[RUNS];
+
+        unlink(path);
+        database_t *db = strcmp(profile, "memory") == 0 ?
+                         database_open_in_memory(path) : database_open(path);
+        if (!db || !database_init_schema(db)) {
+            fprintf(stderr, "Cannot open %s\n", path);
+            database_close(db);
+            return;
+        }
+
+        ha_entity_t **entities = make_entities(count);
+        if (!entities) {
+            database_close(db);
+            return;
+        }
+
+        // Sync commit: first into an empty cache, then overwriting
+        for (int r = 0; r < RUNS; r++) {
+            double start = now_ms();
+            database_save_entities(db, entities, count);
+            runs[r] = now_ms() - start;
+        }
+        report(profile, count, "save_entities", count, runs, RUNS);
+
+        for (int i = 0; i < count; i += 20) {
+            database_add_favorite(db, entities[i]->entity_id);
+        }
+
+        for (int r = 0; r < RUNS; r++) {
+            int n;
+            double start = now_ms();
+            database_free_entities(database_get_all_entities(db, &n));
+            runs[r] = now_ms() - start;
+        }
+        report(profile, count, "get_all_entities", 1, runs, RUNS);
+
+        for (int r = 0; r < RUNS; r++) {
+            int n;
+            double start = now_ms();
+            database_free_entities(database_get_entities_by_domain(db, "sensor", &n));
+            runs[r] = now_ms() - start;
+        }
+        report(profile, count, "get_entities_by_domain", 1, runs, RUNS);
+
+        for (int r = 0; r < RUNS; r++) {
+            int n;
+            double start = now_ms();
+            database_free_entities(database_get_favorites(db, &n));
+            runs[r] = now_ms() - start;
+        }
+        report(profile, count, "get_favorites", 1, runs, RUNS);
+
+        for (int r = 0; r < RUNS; r++) {
+            double start = now_ms();
+            for (int i = 0; i < LOOKUPS; i++) {
+                database_is_favorite(db, entities[(i * 7) % count]->entity_id);
+            }
+            runs[r] = now_ms() - start;
+        }
+        report(profile, count, "is_favorite", LOOKUPS, runs, RUNS);
+
+        // Per-entity area writes, one commit each
+        int updates = count < MAX_AREA_UPDATES ? count : MAX_AREA_UPDATES;
+        for (int r = 0; r < RUNS; r++) {
+            double start = now_ms();
+            for (int i = 0; i < updates; i++) {
+                database_update_entity_area(db, entities[i]->entity_id, r & 1 ? "kitchen" : "office");
+            }
+            runs[r] = now_ms() - start;
+        }
+        report(profile, count, "update_entity_area", updates, runs, RUNS);
+
+        free_entities(entities, count);
+
+        // Memory profile: the shutdown snapshot is the only disk write
+        double start = now_ms();
+        database_close(db);
+        runs[0] = now_ms() - start;
+        if (strcmp(profile, "memory") == 0) {
+            report(profile, count, "close_snapshot", 1, runs, 1);
+        }
+    }
+
+    unlink(path);
+}
+
+int main(int argc, char **argv) {
+    const char *dir = argc > 1 ? argv[1] : "/dev/shm";
+    if (access(dir, W_OK) != 0) {
+        dir = "/tmp";
+    }
+
+    const char *env = getenv("BENCH_SYNC_US");
+    if (env) sync_delay_us = atoi(env);
+    env = getenv("BENCH_WRITE_US");
+    if (env) write_delay_us = atoi(env);
+
+    // Library progress messages go to stderr; stdout carries only results
+    results = fdopen(dup(STDOUT_FILENO), "w");
+    if (!results) {
+        return 1;
+    }
+    fflush(stdout);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+
+    register_throttled_vfs();
+
+    run_profile("tmpfs", dir);
+    run_profile("memory", dir);
+
+    // Route database_open() through the throttled VFS
+    sqlite3_vfs_register(&throttled_vfs, 1);
+    run_profile("throttled", dir);
+    sqlite3_vfs_register(default_vfs, 1);
+
+    fclose(results);
+    return 0;
+}
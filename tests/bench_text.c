@@ -0,0 +1,171 @@
+/**
+ * bench_text.c - Text Rendering Microbenchmark
+ *
+ * Draws a list-screen frame (header, tabs, 8 rows of name, ID and
+ * state, status line and button hints) through the real components.c
+ * text calls, offscreen on SDL's software renderer, and times it three
+ * ways:
+ *
+ *   per_call   No glyph atlas: every string is rendered by SDL_ttf and
+ *              uploaded as a texture, then destroyed (the old path)
+ *   text_cache No glyph atlas, but string textures are kept in the LRU
+ *              text cache (what text outside the atlas goes through)
+ *   atlas      fonts_build_atlases() done: every string is copied glyph
+ *              by glyph from one texture per font size
+ *
+ * Output is one JSON object per line on stdout, like bench_database:
+ *   {"profile":"atlas","op":"list_frame","ops":200,
+ *    "min_ms":41.210,"median_ms":42.003,"per_op_us":210.0}
+ *
+ * Build (CMake):
+ *   cmake -S . -B build -DBUILD_BENCHMARKS=ON && cmake --build build --target bench_text
+ *
+ * Build (standalone):
+ *   gcc -std=gnu99 -O2 -o bench_text tests/bench_text.c src/ui/fonts.c src/ui/components.c \
+ *       src/ui/text_cache.c -Isrc $(pkg-config --cflags --libs sdl2 SDL2_ttf) -lm
+ *
+ * Run:
+ *   ./bench_text [font]   (default: assets/fonts/PressStart2P.ttf)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include "ui/components.h"
+#include "ui/fonts.h"
+#include "ui/text_cache.h"
+
+#define RUNS 5
+#define FRAMES 200
+#define ROWS 8
+
+static const char *TABS[] = {"ALL", "LIGHTS", "SWITCH", "SENSOR", "CLIMATE", "FAV"};
+
+static const char *NAMES[ROWS] = {
+    "Living Room Ceiling", "Kitchen Under Cabinet Lights", "Porch", "Office Desk Lamp",
+    "Bedroom Fan", "Outdoor Temperature Sensor With A Long Name", "Garage Door", "Hallway"
+};
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *profile, const char *op, int ops, double *runs, int run_count) {
+    qsort(runs, run_count, sizeof(double), compare_double);
+    double median = runs[run_count / 2];
+    printf("{\"profile\":\"%s\",\"op\":\"%s\",\"ops\":%d,"
+           "\"min_ms\":%.3f,\"median_ms\":%.3f,\"per_op_us\":%.1f}\n",
+           profile, op, ops, runs[0], median, median * 1000.0 / ops);
+    fflush(stdout);
+}
+
+/**
+ * One list-screen frame worth of text
+ */
+static void draw_frame(SDL_Renderer *renderer, font_manager_t *fonts) {
+    TTF_Font *font_header = fonts_get(fonts, FONT_SIZE_HEADER);
+    TTF_Font *font_body = fonts_get(fonts, FONT_SIZE_BODY);
+    TTF_Font *font_small = fonts_get(fonts, FONT_SIZE_SMALL);
+
+    set_render_color(renderer, COLOR_BACKGROUND);
+    SDL_RenderClear(renderer);
+
+    ui_draw_header(renderer, font_header, font_small, "HOME ASSISTANT", 1);
+
+    tab_bar_t tabs = {{0}, 6, 1, 0};
+    for (int i = 0; i < 6; i++) {
+        tabs.tabs[i] = TABS[i];
+    }
+    ui_draw_tab_bar(renderer, &tabs, font_small, 10, 55, 620);
+
+    for (int i = 0; i < ROWS; i++) {
+        char entity_id[64];
+        snprintf(entity_id, sizeof(entity_id), "light.row_%d", i);
+        int y = 90 + i * 42;
+        ui_draw_text_truncated(renderer, font_body, NAMES[i], 50, y + 4, 450, COLOR_TEXT_PRIMARY);
+        ui_draw_text(renderer, font_small, entity_id, 50, y + 22, COLOR_TEXT_SECONDARY,
+                     TEXT_ALIGN_LEFT);
+        ui_draw_text(renderer, font_body, i % 2 ? "ON" : "OFF", 600, y + 10, COLOR_TEXT_PRIMARY,
+                     TEXT_ALIGN_RIGHT);
+    }
+
+    ui_draw_text(renderer, font_small, "Synced 12:04:31", 320, 432, COLOR_TEXT_SECONDARY,
+                 TEXT_ALIGN_CENTER);
+
+    const char *hints[] = {"[A] Toggle", "[X] View", "[SEL] Detail", "[START] Sync"};
+    ui_draw_button_hints(renderer, font_body, hints, 4);
+
+    SDL_RenderPresent(renderer);
+}
+
+static void run_profile(const char *profile, SDL_Renderer *renderer, font_manager_t *fonts) {
+    double runs[RUNS];
+
+    draw_frame(renderer, fonts);   // Warm up caches
+
+    for (int r = 0; r < RUNS; r++) {
+        double start = now_ms();
+        for (int f = 0; f < FRAMES; f++) {
+            draw_frame(renderer, fonts);
+        }
+        runs[r] = now_ms() - start;
+    }
+
+    report(profile, "list_frame", FRAMES, runs, RUNS);
+}
+
+int main(int argc, char **argv) {
+    const char *font_path = argc > 1 ? argv[1] : "assets/fonts/PressStart2P.ttf";
+
+    if (SDL_Init(0) < 0 || TTF_Init() < 0) {
+        fprintf(stderr, "SDL init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    // 640x480 offscreen target, same as the device screen
+    SDL_Surface *target = SDL_CreateRGBSurfaceWithFormat(0, 640, 480, 32,
+                                                         SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer *renderer = target ? SDL_CreateSoftwareRenderer(target) : NULL;
+    font_manager_t *fonts = renderer ? fonts_init(font_path) : NULL;
+    if (!fonts) {
+        fprintf(stderr, "Setup failed: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    run_profile("per_call", renderer, fonts);
+
+    text_cache_t *cache = text_cache_create(renderer);
+    if (!cache) {
+        fprintf(stderr, "Text cache failed\n");
+        return 1;
+    }
+    ui_set_text_cache(cache);
+    run_profile("text_cache", renderer, fonts);
+    fprintf(stderr, "Text cache: %lu hits, %lu misses, %lu evictions\n",
+            cache->hits, cache->misses, cache->evictions);
+
+    if (!fonts_build_atlases(fonts, renderer)) {
+        fprintf(stderr, "Glyph atlases failed\n");
+        return 1;
+    }
+    run_profile("atlas", renderer, fonts);
+
+    ui_set_text_cache(NULL);
+    text_cache_destroy(cache);
+    fonts_destroy(fonts);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(target);
+    TTF_Quit();
+    SDL_Quit();
+    return 0;
+}
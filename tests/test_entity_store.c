@@ -0,0 +1,316 @@
+/**
+ * test_entity_store.c - In-Memory Entity Table Test Program
+ *
+ * Standalone test for the entity store: ordering, filtered selection
+ * through the group indexes, in-place updates that keep borrowed pointers
+ * valid, version changes on layout changes only, change sets, and
+ * selection latency on a 5,000-entity cache (target: well under a
+ * millisecond per tab switch).
+ *
+ * Compile:
+ *   gcc -std=gnu99 -O2 -o test_entity_store tests/test_entity_store.c src/entity_store.c \
+ *       src/utils/str_map.c src/utils/json_helpers.c -Isrc -lcjson
+ *
+ * Run:
+ *   ./test_entity_store
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "entity_store.h"
+
+// Test results
+static int tests_run = 0;
+static int tests_passed = 0;
+
+#define TEST(name) \
+    printf("\n[TEST] %s\n", name); \
+    tests_run++;
+
+#define PASS() \
+    printf("  ✓ PASSED\n"); \
+    tests_passed++;
+
+#define FAIL(msg) \
+    printf("  ✗ FAILED: %s\n", msg);
+
+#define ENTITY_COUNT 5000
+#define MAX_SELECT_MS 1.0
+
+static const char *DOMAINS[] = {"light", "sensor", "switch", "fan"};
+
+static void make_entity(ha_entity_t *entity, int i) {
+    memset(entity, 0, sizeof(*entity));
+    const char *domain = DOMAINS[i % 4];
+    snprintf(entity->entity_id, sizeof(entity->entity_id), "%s.entity_%d", domain, i);
+    snprintf(entity->friendly_name, sizeof(entity->friendly_name), "Entity %05d",
+             (i * 7919) % ENTITY_COUNT);
+    snprintf(entity->domain, sizeof(entity->domain), "%s", domain);
+    snprintf(entity->area_id, sizeof(entity->area_id), "%s", i % 3 ? "kitchen" : "");
+    snprintf(entity->state, sizeof(entity->state), "off");
+}
+
+static double elapsed_ms(struct timespec *start, struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) * 1000.0 +
+           (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+/**
+ * Test 1: Rows are sorted and indexed
+ */
+void test_order(entity_store_t *store) {
+    TEST("Sorted rows and ID index");
+
+    for (int i = 1; i < store->count; i++) {
+        const ha_entity_t *a = store->rows[i - 1];
+        const ha_entity_t *b = store->rows[i];
+        int cmp = strcmp(a->friendly_name, b->friendly_name);
+        if (cmp > 0 || (cmp == 0 && strcmp(a->entity_id, b->entity_id) >= 0)) {
+            FAIL("Rows out of order");
+            return;
+        }
+    }
+
+    const ha_entity_t *entity = entity_store_get(store, "fan.entity_3");
+    if (!entity || strcmp(entity->entity_id, "fan.entity_3") != 0) {
+        FAIL("Lookup by ID failed");
+        return;
+    }
+    if (entity_store_get(store, "fan.missing")) {
+        FAIL("Lookup of missing ID returned a row");
+        return;
+    }
+
+    PASS();
+}
+
+/**
+ * Test 2: Filters match the database's semantics
+ */
+void test_filters(entity_store_t *store) {
+    TEST("Filtered selection");
+
+    const char *restrict_to[] = {"light", "fan"};
+    entity_filter_t domain = {ENTITY_GROUP_DOMAIN, "sensor", NULL, 0};
+    entity_filter_t area = {ENTITY_GROUP_AREA, "", restrict_to, 2};
+    entity_filter_t favorites = {ENTITY_GROUP_FAVORITES, NULL, NULL, 0};
+
+    if (entity_store_select(store, &domain, NULL, 0) != ENTITY_COUNT / 4) {
+        FAIL("Domain count wrong");
+        return;
+    }
+
+    // i % 3 == 0 and i % 4 in {0, 3}
+    int expected = 0;
+    for (int i = 0; i < ENTITY_COUNT; i++) {
+        if (i % 3 == 0 && (i % 4 == 0 || i % 4 == 3)) expected++;
+    }
+    if (entity_store_select(store, &area, NULL, 0) != expected) {
+        FAIL("Unassigned area with domain restriction count wrong");
+        return;
+    }
+
+    str_map_t favorite_set;
+    str_map_init(&favorite_set, 4);
+    str_map_put(&favorite_set, "switch.entity_2", 1);
+    str_map_put(&favorite_set, "light.missing", 1);
+    entity_store_index_favorites(store, &favorite_set);
+    const ha_entity_t *rows[4];
+    int n = entity_store_select(store, &favorites, rows, 4);
+    entity_store_index_favorites(store, NULL);
+    str_map_free(&favorite_set);
+    if (n != 1 || strcmp(rows[0]->entity_id, "switch.entity_2") != 0) {
+        FAIL("Favorites selection wrong");
+        return;
+    }
+
+    // Group members come back in row order
+    const ha_entity_t *kitchen[ENTITY_COUNT];
+    entity_filter_t in_kitchen = {ENTITY_GROUP_AREA, "kitchen", NULL, 0};
+    n = entity_store_select(store, &in_kitchen, kitchen, ENTITY_COUNT);
+    for (int i = 1; i < n; i++) {
+        if (strcmp(kitchen[i - 1]->friendly_name, kitchen[i]->friendly_name) > 0) {
+            FAIL("Area bucket out of order");
+            return;
+        }
+    }
+
+    int count = 0;
+    char **areas = entity_store_group_values(store, ENTITY_GROUP_AREA, NULL, &count);
+    int ok = (count == 2 && areas[0][0] == '\0' && strcmp(areas[1], "kitchen") == 0);
+    for (int i = 0; i < count; i++) free(areas[i]);
+    free(areas);
+    if (!ok) {
+        FAIL("Area values wrong");
+        return;
+    }
+
+    PASS();
+}
+
+/**
+ * Test 3: Updates are in place; only layout changes bump the version
+ */
+void test_updates(entity_store_t *store, ha_entity_t *source) {
+    TEST("In-place updates, versioning and change sets");
+
+    const ha_entity_t *borrowed = entity_store_get(store, "light.entity_0");
+    unsigned int version = store->version;
+    entity_changes_t changes = {0};
+
+    // Same list with new states: rows change, layout does not
+    const ha_entity_t **list = malloc(ENTITY_COUNT * sizeof(ha_entity_t *));
+    for (int i = 0; i < ENTITY_COUNT; i++) {
+        if (i % 10 == 0) {
+            snprintf(source[i].state, sizeof(source[i].state), "on");
+        }
+        list[i] = &source[i];
+    }
+    entity_store_replace(store, list, ENTITY_COUNT, &changes);
+
+    if (store->version != version || strcmp(borrowed->state, "on") != 0) {
+        FAIL("State sync moved rows or left a stale borrowed row");
+        free(list);
+        entity_changes_free(&changes);
+        return;
+    }
+
+    const entity_change_t *change = entity_changes_find(&changes, "light.entity_0");
+    if (changes.changed != ENTITY_COUNT / 10 || changes.layout ||
+        !change || change->type != ENTITY_CHANGE_STATE ||
+        entity_changes_find(&changes, "sensor.entity_1")) {
+        FAIL("State change set wrong");
+        free(list);
+        entity_changes_free(&changes);
+        return;
+    }
+
+    // Unchanged data records nothing
+    entity_changes_clear(&changes);
+    entity_store_replace(store, list, ENTITY_COUNT, &changes);
+    if (changes.count != 0) {
+        FAIL("Unchanged sync reported changes");
+        free(list);
+        entity_changes_free(&changes);
+        return;
+    }
+
+    // Rename moves the row but keeps its address
+    ha_entity_t renamed = *borrowed;
+    snprintf(renamed.friendly_name, sizeof(renamed.friendly_name), "AAA First");
+    if (entity_store_put(store, &renamed, NULL) != borrowed ||
+        store->rows[0] != borrowed || store->version == version) {
+        FAIL("Rename did not reorder in place");
+        free(list);
+        entity_changes_free(&changes);
+        return;
+    }
+
+    // Moving to another area regroups the row
+    entity_filter_t garage = {ENTITY_GROUP_AREA, "garage", NULL, 0};
+    const ha_entity_t *moved = NULL;
+    snprintf(renamed.area_id, sizeof(renamed.area_id), "garage");
+    entity_store_put(store, &renamed, NULL);
+    if (entity_store_select(store, &garage, &moved, 1) != 1 || moved != borrowed) {
+        FAIL("Area move not reflected in the area index");
+        free(list);
+        entity_changes_free(&changes);
+        return;
+    }
+
+    // Dropping entities removes them and bumps the version
+    version = store->version;
+    entity_store_replace(store, list, ENTITY_COUNT - 100, &changes);
+    free(list);
+    if (store->count != ENTITY_COUNT - 100 || store->version == version ||
+        entity_store_get(store, "light.entity_4996")) {
+        FAIL("Removed entities still present");
+        entity_changes_free(&changes);
+        return;
+    }
+
+    // The renamed row is reverted by the sync, the tail is removed
+    change = entity_changes_find(&changes, "light.entity_4996");
+    if (changes.removed != 100 || changes.changed != 1 || !changes.layout ||
+        !change || change->type != ENTITY_CHANGE_REMOVED) {
+        FAIL("Removal change set wrong");
+        entity_changes_free(&changes);
+        return;
+    }
+
+    entity_changes_free(&changes);
+    PASS();
+}
+
+/**
+ * Test 4: Tab switch latency
+ */
+void test_latency(entity_store_t *store) {
+    TEST("Selection latency (5,000 entities)");
+
+    const char *restrict_to[] = {"light", "sensor", "switch", "fan"};
+    entity_filter_t tab = {ENTITY_GROUP_AREA, "kitchen", restrict_to, 4};
+    const ha_entity_t **rows = malloc(ENTITY_COUNT * sizeof(ha_entity_t *));
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int n = 0;
+    for (int i = 0; i < 100; i++) {
+        n = entity_store_select(store, &tab, rows, ENTITY_COUNT);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    free(rows);
+
+    double ms = elapsed_ms(&start, &end) / 100;
+    printf("  - %d rows in %.3f ms\n", n, ms);
+    if (ms > MAX_SELECT_MS) {
+        FAIL("Selection too slow");
+        return;
+    }
+
+    PASS();
+}
+
+int main(void) {
+    printf("===========================================\n");
+    printf("Entity Store Test Suite\n");
+    printf("===========================================\n");
+
+    entity_store_t store;
+    ha_entity_t *source = calloc(ENTITY_COUNT, sizeof(ha_entity_t));
+    const ha_entity_t **list = calloc(ENTITY_COUNT, sizeof(ha_entity_t *));
+    if (!source || !list || !entity_store_init(&store)) {
+        printf("Out of memory\n");
+        return 1;
+    }
+
+    for (int i = 0; i < ENTITY_COUNT; i++) {
+        make_entity(&source[i], i);
+        list[i] = &source[i];
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    entity_store_replace(&store, list, ENTITY_COUNT, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Initial load: %.2f ms\n", elapsed_ms(&start, &end));
+    free(list);
+
+    test_order(&store);
+    test_filters(&store);
+    test_updates(&store, source);
+    test_latency(&store);
+
+    entity_store_free(&store);
+    free(source);
+
+    printf("\n===========================================\n");
+    printf("Results: %d/%d tests passed\n", tests_passed, tests_run);
+    printf("===========================================\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
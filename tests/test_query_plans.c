@@ -0,0 +1,297 @@
+/**
+ * test_query_plans.c - Database Query Plan Regression Test
+ *
+ * Runs the list-view queries through the real database functions,
+ * captures the SQL they prepare and checks EXPLAIN QUERY PLAN for each:
+ * the expected index is used, no full table scans, and keyset pages are
+ * read in index order (no temp B-tree sort). Also checks that a cache
+ * created before schema versioning is migrated in place.
+ *
+ * Compile:
+ *   gcc -std=c99 -o test_query_plans tests/test_query_plans.c src/database.c \
+ *       src/utils/json_helpers.c -Isrc -lsqlite3 -lcjson -lpthread
+ *
+ * Run:
+ *   ./test_query_plans
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "database.h"
+
+// Test results
+static int tests_run = 0;
+static int tests_passed = 0;
+
+#define TEST(name) \
+    printf("\n[TEST] %s\n", name); \
+    tests_run++;
+
+#define PASS() \
+    printf("  ✓ PASSED\n"); \
+    tests_passed++;
+
+#define FAIL(msg) \
+    printf("  ✗ FAILED: %s\n", msg);
+
+#define ENTITY_COUNT 2000
+
+static const char *MVP_DOMAINS[] = {
+    "light", "sensor", "binary_sensor", "button", "humidifier",
+    "scene", "switch", "select", "fan", "climate"
+};
+static const char *DOMAINS[] = {
+    "light", "sensor", "switch", "automation", "binary_sensor", "update", "fan", "script"
+};
+
+// Last SELECT prepared by the database layer
+static char captured_sql[2048];
+
+static int trace_statement(unsigned type, void *ctx, void *p, void *x) {
+    (void)ctx;
+    (void)x;
+    if (type == SQLITE_TRACE_STMT) {
+        const char *sql = sqlite3_sql((sqlite3_stmt *)p);
+        if (sql && strncmp(sql, "SELECT", 6) == 0) {
+            strncpy(captured_sql, sql, sizeof(captured_sql) - 1);
+        }
+    }
+    return 0;
+}
+
+/**
+ * Get the query plan of the last captured statement as "detail | detail | ..."
+ */
+static void explain_captured(database_t *db, char *plan, size_t size) {
+    char sql[2100];
+    snprintf(sql, sizeof(sql), "EXPLAIN QUERY PLAN %s", captured_sql);
+
+    plan[0] = '\0';
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        snprintf(plan, size, "prepare failed: %s", sqlite3_errmsg(db->db));
+        return;
+    }
+
+    size_t len = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char *detail = (const char *)sqlite3_column_text(stmt, 3);
+        len += snprintf(plan + len, size - len, "%s%s", len ? " | " : "", detail ? detail : "");
+        if (len >= size) break;
+    }
+    sqlite3_finalize(stmt);
+}
+
+/**
+ * Check a plan: must mention expect (if given), must never scan the
+ * entities table without an index, and must not sort if ordered is set.
+ */
+static int check_plan(database_t *db, const char *expect, int ordered) {
+    char plan[1024];
+    explain_captured(db, plan, sizeof(plan));
+    printf("  - %s\n", plan);
+
+    if (expect && !strstr(plan, expect)) {
+        FAIL("Expected index not used");
+        return 0;
+    }
+
+    // "SCAN entities" with nothing after it is a full table scan
+    const char *scan = plan;
+    while ((scan = strstr(scan, "SCAN entities")) != NULL) {
+        scan += strlen("SCAN entities");
+        if (strncmp(scan, " USING", 6) != 0) {
+            FAIL("Full table scan on entities");
+            return 0;
+        }
+    }
+
+    if (ordered && strstr(plan, "TEMP B-TREE FOR ORDER BY")) {
+        FAIL("Page query sorts instead of walking the index");
+        return 0;
+    }
+
+    return 1;
+}
+
+static void populate(database_t *db) {
+    ha_entity_t **entities = calloc(ENTITY_COUNT, sizeof(ha_entity_t *));
+    for (int i = 0; i < ENTITY_COUNT; i++) {
+        ha_entity_t *e = calloc(1, sizeof(ha_entity_t));
+        const char *domain = DOMAINS[i % 8];
+        snprintf(e->entity_id, sizeof(e->entity_id), "%s.entity_%d", domain, i);
+        snprintf(e->friendly_name, sizeof(e->friendly_name), "Entity %05d", i);
+        snprintf(e->domain, sizeof(e->domain), "%s", domain);
+        snprintf(e->area_id, sizeof(e->area_id), "room_%d", i % 25);
+        snprintf(e->state, sizeof(e->state), "on");
+        entities[i] = e;
+    }
+    database_save_entities(db, entities, ENTITY_COUNT);
+    free_entities(entities, ENTITY_COUNT);
+
+    for (int i = 0; i < ENTITY_COUNT; i += 100) {
+        char id[64];
+        snprintf(id, sizeof(id), "%s.entity_%d", DOMAINS[i % 8], i);
+        database_add_favorite(db, id);
+    }
+}
+
+/**
+ * Test 1: Keyset page queries walk the tab's index
+ */
+void test_page_plans(database_t *db) {
+    TEST("Page query plans");
+
+    entity_cursor_t cursor = {"Entity 01000", "light.entity_1000"};
+    entity_filter_t domain = {ENTITY_GROUP_DOMAIN, "light", NULL, 0};
+    entity_filter_t area = {ENTITY_GROUP_AREA, "room_3", MVP_DOMAINS, 10};
+    entity_filter_t all = {ENTITY_GROUP_ALL, NULL, MVP_DOMAINS, 10};
+    entity_filter_t favorites = {ENTITY_GROUP_FAVORITES, NULL, NULL, 0};
+    int count;
+
+    database_free_entities(database_get_entity_page(db, &domain, &cursor, PAGE_AFTER, 48, &count));
+    if (!check_plan(db, "idx_entities_domain_name", 1)) return;
+
+    database_free_entities(database_get_entity_page(db, &domain, &cursor, PAGE_BEFORE, 48, &count));
+    if (!check_plan(db, "idx_entities_domain_name", 1)) return;
+
+    database_free_entities(database_get_entity_page(db, &area, &cursor, PAGE_AFTER, 48, &count));
+    if (!check_plan(db, "idx_entities_area_name", 1)) return;
+
+    database_free_entities(database_get_entity_page(db, &all, NULL, PAGE_AFTER, 48, &count));
+    if (!check_plan(db, "idx_entities_name", 1)) return;
+
+    database_free_entities(database_get_entity_page(db, &favorites, NULL, PAGE_AFTER, 48, &count));
+    if (!check_plan(db, NULL, 0)) return;
+
+    PASS();
+}
+
+/**
+ * Test 2: Counts and tab values are answered from covering indexes
+ */
+void test_covering_plans(database_t *db) {
+    TEST("Covering index plans");
+
+    entity_filter_t domain = {ENTITY_GROUP_DOMAIN, "sensor", NULL, 0};
+    entity_filter_t area = {ENTITY_GROUP_AREA, "room_3", MVP_DOMAINS, 10};
+    entity_filter_t mvp = {ENTITY_GROUP_ALL, NULL, MVP_DOMAINS, 10};
+
+    database_count_entities(db, &domain);
+    if (!check_plan(db, "COVERING INDEX idx_entities_domain_name", 0)) return;
+
+    database_count_entities(db, &area);
+    if (!check_plan(db, "COVERING INDEX idx_entities_area_name", 0)) return;
+
+    int count;
+    char **values = database_get_group_values(db, ENTITY_GROUP_AREA, &mvp, &count);
+    for (int i = 0; i < count; i++) free(values[i]);
+    free(values);
+    if (!check_plan(db, "COVERING INDEX", 0)) return;
+
+    PASS();
+}
+
+/**
+ * Test 3: Legacy entity and favorites queries
+ */
+void test_legacy_plans(database_t *db) {
+    TEST("Domain and favorites query plans");
+
+    int count;
+    database_free_entities(database_get_entities_by_domain(db, "switch", &count));
+    if (!check_plan(db, "idx_entities_domain_name", 1)) return;
+
+    database_free_entities(database_get_favorites(db, &count));
+    if (!check_plan(db, "idx_favorites_added", 1)) return;
+
+    database_is_favorite(db, "light.entity_0");
+    if (!check_plan(db, "favorites", 0)) return;
+
+    PASS();
+}
+
+/**
+ * Test 4: A pre-versioning cache upgrades in place
+ */
+void test_migration(void) {
+    TEST("Schema migration from version 0");
+
+    database_t *db = database_open(":memory:");
+    if (!db) {
+        FAIL("Could not open database");
+        return;
+    }
+
+    // Cache as created before user_version existed
+    sqlite3_exec(db->db,
+        "CREATE TABLE entities (entity_id TEXT PRIMARY KEY, state TEXT, friendly_name TEXT,"
+        " icon TEXT, domain TEXT, area_id TEXT, attributes_json TEXT,"
+        " supported_features INTEGER, last_changed TEXT, last_updated TEXT);"
+        "CREATE TABLE favorites (entity_id TEXT PRIMARY KEY,"
+        " added_at TEXT DEFAULT CURRENT_TIMESTAMP);"
+        "CREATE INDEX idx_entities_domain ON entities(domain);"
+        "CREATE INDEX idx_entities_area ON entities(area_id);"
+        "INSERT INTO entities (entity_id, friendly_name, domain) VALUES ('light.a', 'A', 'light');",
+        NULL, NULL, NULL);
+
+    if (!database_init_schema(db) ||
+        database_get_schema_version(db) != DATABASE_SCHEMA_VERSION) {
+        FAIL("Migration did not reach the current version");
+        database_close(db);
+        return;
+    }
+
+    sqlite3_stmt *stmt;
+    sqlite3_prepare_v2(db->db,
+        "SELECT COUNT(*) FROM sqlite_master WHERE type = 'index' "
+        "AND name IN ('idx_entities_domain', 'idx_entities_area');", -1, &stmt, NULL);
+    sqlite3_step(stmt);
+    int stale = sqlite3_column_int(stmt, 0);
+    sqlite3_finalize(stmt);
+
+    if (stale != 0 || database_get_entity_count(db) != 1) {
+        FAIL("Old indexes left behind or rows lost");
+        database_close(db);
+        return;
+    }
+
+    // Running again is a no-op
+    if (!database_init_schema(db)) {
+        FAIL("Second init failed");
+        database_close(db);
+        return;
+    }
+
+    database_close(db);
+    PASS();
+}
+
+int main(void) {
+    printf("===========================================\n");
+    printf("Query Plan Test Suite\n");
+    printf("===========================================\n");
+
+    database_t *db = database_open(":memory:");
+    if (!db || !database_init_schema(db)) {
+        printf("Could not create database\n");
+        return 1;
+    }
+
+    populate(db);
+    sqlite3_trace_v2(db->db, SQLITE_TRACE_STMT, trace_statement, NULL);
+
+    test_page_plans(db);
+    test_covering_plans(db);
+    test_legacy_plans(db);
+    database_close(db);
+
+    test_migration();
+
+    printf("\n===========================================\n");
+    printf("Results: %d/%d tests passed\n", tests_passed, tests_run);
+    printf("===========================================\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+/**
+ * test_search_index.c - Entity Search Index Test Program
+ *
+ * Standalone test for the in-memory search index: prefix matching,
+ * ranking, incremental narrowing and query latency on a 5,000-entity
+ * cache (target: under 5 ms per query).
+ *
+ * Compile:
+ *   gcc -std=c99 -O2 -o test_search tests/test_search_index.c src/search_index.c -Isrc
+ *
+ * Run:
+ *   ./test_search
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "search_index.h"
+
+// Test results
+static int tests_run = 0;
+static int tests_passed = 0;
+
+#define TEST(name) \
+    printf("\n[TEST] %s\n", name); \
+    tests_run++;
+
+#define PASS() \
+    printf("  ✓ PASSED\n"); \
+    tests_passed++;
+
+#define FAIL(msg) \
+    printf("  ✗ FAILED: %s\n", msg);
+
+#define ENTITY_COUNT 5000
+#define MAX_QUERY_MS 5.0
+
+static const char *ROOMS[] = {
+    "Kitchen", "Living Room", "Bedroom", "Office", "Garage",
+    "Hallway", "Bathroom", "Basement", "Attic", "Porch"
+};
+static const char *KINDS[][2] = {
+    {"sensor", "Temperature"}, {"sensor", "Humidity"}, {"light", "Light"},
+    {"switch", "Plug"}, {"binary_sensor", "Motion"}, {"sensor", "Power"}
+};
+
+static ha_entity_t* make_entities(int count) {
+    ha_entity_t *entities = calloc(count, sizeof(ha_entity_t));
+    if (!entities) return NULL;
+
+    for (int i = 0; i < count; i++) {
+        const char *room = ROOMS[i % 10];
+        const char *domain = KINDS[(i / 10) % 6][0];
+        const char *kind = KINDS[(i / 10) % 6][1];
+
+        snprintf(entities[i].friendly_name, sizeof(entities[i].friendly_name),
+                 "%s %s %d", room, kind, i);
+        snprintf(entities[i].entity_id, sizeof(entities[i].entity_id),
+                 "%s.%s_%s_%d", domain, room, kind, i);
+        for (char *p = entities[i].entity_id; *p; p++) {
+            if (*p == ' ') *p = '_';
+            if (*p >= 'A' && *p <= 'Z') *p += 32;
+        }
+    }
+
+    return entities;
+}
+
+static double elapsed_ms(struct timespec *start, struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) * 1000.0 +
+           (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+/**
+ * Test 1: Prefix matches on names, entity IDs and later words
+ */
+void test_prefix_matching(search_index_t *index) {
+    TEST("Prefix matching");
+
+    search_query_t query;
+    search_result_t results[10];
+    search_query_reset(&query);
+
+    int n = search_index_query(index, &query, "KITCHEN TEMP", results, 10);
+    if (n == 0 || strncmp(results[0].friendly_name, "Kitchen Temperature", 19) != 0) {
+        FAIL("Expected 'Kitchen Temperature ...' first");
+        return;
+    }
+
+    search_query_reset(&query);
+    n = search_index_query(index, &query, "humid", results, 10);
+    if (n != 10 || !strstr(results[0].friendly_name, "Humidity")) {
+        FAIL("Expected 10 humidity matches from a later word");
+        return;
+    }
+
+    search_query_reset(&query);
+    n = search_index_query(index, &query, "binary_sensor.gar", results, 10);
+    if (n == 0 || strncmp(results[0].entity_id, "binary_sensor.garage", 20) != 0) {
+        FAIL("Expected entity_id prefix match");
+        return;
+    }
+
+    search_query_reset(&query);
+    n = search_index_query(index, &query, "zzz", results, 10);
+    if (n != 0) {
+        FAIL("Expected no matches");
+        return;
+    }
+
+    PASS();
+}
+
+/**
+ * Test 2: Incremental typing gives the same results as a fresh query
+ */
+void test_incremental(search_index_t *index) {
+    TEST("Incremental narrowing");
+
+    const char *typed = "living room motion 1";
+    search_query_t incremental;
+    search_query_reset(&incremental);
+
+    char prefix[SEARCH_MAX_QUERY];
+    for (size_t len = 1; len <= strlen(typed); len++) {
+        memcpy(prefix, typed, len);
+        prefix[len] = '\0';
+
+        search_result_t a[8], b[8];
+        search_query_t fresh;
+        search_query_reset(&fresh);
+
+        int na = search_index_query(index, &incremental, prefix, a, 8);
+        int nb = search_index_query(index, &fresh, prefix, b, 8);
+        if (na != nb || (na > 0 && strcmp(a[0].entity_id, b[0].entity_id) != 0)) {
+            FAIL("Incremental result differs from fresh query");
+            return;
+        }
+    }
+
+    PASS();
+}
+
+/**
+ * Test 3: Worst-case query latency
+ */
+void test_latency(search_index_t *index) {
+    TEST("Query latency (5,000 entities)");
+
+    const char *prefixes[] = {"s", "k", "l", "sensor.", "b", "t", "1", "kitchen l"};
+    double worst = 0.0;
+
+    for (int i = 0; i < 8; i++) {
+        search_query_t query;
+        search_result_t results[10];
+        struct timespec start, end;
+
+        search_query_reset(&query);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        search_index_query(index, &query, prefixes[i], results, 10);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double ms = elapsed_ms(&start, &end);
+        if (ms > worst) worst = ms;
+    }
+
+    printf("  - Worst query: %.3f ms\n", worst);
+    if (worst > MAX_QUERY_MS) {
+        FAIL("Query slower than 5 ms");
+        return;
+    }
+
+    PASS();
+}
+
+int main(void) {
+    printf("===========================================\n");
+    printf("Search Index Test Suite\n");
+    printf("===========================================\n");
+
+    ha_entity_t *entities = make_entities(ENTITY_COUNT);
+    const ha_entity_t **rows = calloc(ENTITY_COUNT, sizeof(ha_entity_t *));
+    search_index_t *index = search_index_create();
+    if (!entities || !rows || !index) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    for (int i = 0; i < ENTITY_COUNT; i++) {
+        rows[i] = &entities[i];
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    search_index_rebuild(index, rows, ENTITY_COUNT);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Index rebuild: %.2f ms (%d tokens)\n", elapsed_ms(&start, &end), index->token_count);
+
+    test_prefix_matching(index);
+    test_incremental(index);
+    test_latency(index);
+
+    search_index_destroy(index);
+    free(rows);
+    free(entities);
+
+    printf("\n===========================================\n");
+    printf("Results: %d/%d tests passed\n", tests_passed, tests_run);
+    printf("===========================================\n");
+
+    return (tests_passed == tests_run) ? 0 : 1;
+}